@@ -61,6 +61,8 @@ static bool shouldCopyGPUBuffers = false;
 static bool shouldDumpShaders = false;
 static bool shouldPatchShaders = true;
 static u32 vblankDivider = 1;
+static u32 framesInFlight = 0; // 0 matches the swapchain image count
+static float resolutionScale = 1.0f;
 static bool vkValidation = false;
 static bool vkValidationSync = false;
 static bool vkValidationGpu = false;
@@ -291,6 +293,14 @@ u32 vblankDiv() {
     return vblankDivider;
 }
 
+u32 getFramesInFlight() {
+    return framesInFlight;
+}
+
+float getResolutionScale() {
+    return resolutionScale;
+}
+
 bool vkValidationEnabled() {
     return vkValidation;
 }
@@ -403,6 +413,14 @@ void setVblankDiv(u32 value) {
     vblankDivider = value;
 }
 
+void setFramesInFlight(u32 value) {
+    framesInFlight = value;
+}
+
+void setResolutionScale(float scale) {
+    resolutionScale = scale;
+}
+
 void setIsFullscreen(bool enable) {
     isFullscreen = enable;
 }
@@ -742,6 +760,8 @@ void load(const std::filesystem::path& path) {
         shouldDumpShaders = toml::find_or<bool>(gpu, "dumpShaders", false);
         shouldPatchShaders = toml::find_or<bool>(gpu, "patchShaders", true);
         vblankDivider = toml::find_or<int>(gpu, "vblankDivider", 1);
+        framesInFlight = toml::find_or<int>(gpu, "framesInFlight", 0);
+        resolutionScale = toml::find_or<float>(gpu, "resolutionScale", 1.0f);
     }
 
     if (data.contains("Vulkan")) {
@@ -877,6 +897,8 @@ void save(const std::filesystem::path& path) {
     data["GPU"]["dumpShaders"] = shouldDumpShaders;
     data["GPU"]["patchShaders"] = shouldPatchShaders;
     data["GPU"]["vblankDivider"] = vblankDivider;
+    data["GPU"]["framesInFlight"] = framesInFlight;
+    data["GPU"]["resolutionScale"] = resolutionScale;
     data["Vulkan"]["gpuId"] = gpuId;
     data["Vulkan"]["validation"] = vkValidation;
     data["Vulkan"]["validation_sync"] = vkValidationSync;
@@ -986,6 +1008,8 @@ void setDefaultValues() {
     isNullGpu = false;
     shouldDumpShaders = false;
     vblankDivider = 1;
+    framesInFlight = 0;
+    resolutionScale = 1.0f;
     vkValidation = false;
     vkValidationSync = false;
     vkValidationGpu = false;
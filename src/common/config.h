@@ -69,6 +69,8 @@ bool patchShaders();
 bool isRdocEnabled();
 bool fpsColor();
 u32 vblankDiv();
+u32 getFramesInFlight();
+float getResolutionScale();
 
 void setDebugDump(bool enable);
 void setCollectShaderForDebug(bool enable);
@@ -80,6 +82,8 @@ void setAllowHDR(bool enable);
 void setCopyGPUCmdBuffers(bool enable);
 void setDumpShaders(bool enable);
 void setVblankDiv(u32 value);
+void setFramesInFlight(u32 value);
+void setResolutionScale(float scale);
 void setGpuId(s32 selectedGpuId);
 void setScreenWidth(u32 width);
 void setScreenHeight(u32 height);
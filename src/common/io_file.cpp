@@ -17,6 +17,7 @@
 #include <share.h>
 #include <windows.h>
 #else
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -159,6 +160,9 @@ IOFile::IOFile(IOFile&& other) noexcept {
     std::swap(file_access_mode, other.file_access_mode);
     std::swap(file_type, other.file_type);
     std::swap(file, other.file);
+    std::swap(file_mapping, other.file_mapping);
+    std::swap(view_base, other.view_base);
+    std::swap(view_size, other.view_size);
 }
 
 IOFile& IOFile::operator=(IOFile&& other) noexcept {
@@ -166,6 +170,9 @@ IOFile& IOFile::operator=(IOFile&& other) noexcept {
     std::swap(file_access_mode, other.file_access_mode);
     std::swap(file_type, other.file_type);
     std::swap(file, other.file);
+    std::swap(file_mapping, other.file_mapping);
+    std::swap(view_base, other.view_base);
+    std::swap(view_size, other.view_size);
     return *this;
 }
 
@@ -205,6 +212,16 @@ void IOFile::Close() {
         return;
     }
 
+    if (view_base) {
+#ifdef _WIN32
+        UnmapViewOfFile(view_base);
+#else
+        munmap(view_base, view_size);
+#endif
+        view_base = nullptr;
+        view_size = 0;
+    }
+
     errno = 0;
 
     const auto close_result = std::fclose(file) == 0;
@@ -222,6 +239,7 @@ void IOFile::Close() {
         CloseHandle(std::bit_cast<HANDLE>(file_mapping));
     }
 #endif
+    file_mapping = 0;
 }
 
 void IOFile::Unlink() {
@@ -276,6 +294,51 @@ uintptr_t IOFile::GetFileMapping() {
 #endif
 }
 
+std::span<const u8> IOFile::MapReadOnlyView() {
+    if (view_base) {
+        return {static_cast<const u8*>(view_base), view_size};
+    }
+    if (!IsOpen()) {
+        return {};
+    }
+    const u64 size = GetSize();
+    if (size == 0) {
+        return {};
+    }
+#ifdef _WIN32
+    const int fd = fileno(file);
+    HANDLE hfile = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    HANDLE mapping = CreateFileMappingW(hfile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        LOG_ERROR(Common_Filesystem, "Failed to create file mapping for path={}, error={}",
+                  PathToUTF8String(file_path), Common::GetLastErrorMsg());
+        return {};
+    }
+    void* base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the section alive, the handle is no longer needed.
+    CloseHandle(mapping);
+    if (!base) {
+        LOG_ERROR(Common_Filesystem, "Failed to map view of file at path={}, error={}",
+                  PathToUTF8String(file_path), Common::GetLastErrorMsg());
+        return {};
+    }
+#else
+    void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (base == MAP_FAILED) {
+        const auto ec = std::error_code{errno, std::generic_category()};
+        LOG_ERROR(Common_Filesystem, "Failed to map the file at path={}, ec_message={}",
+                  PathToUTF8String(file_path), ec.message());
+        return {};
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(base, size, MADV_SEQUENTIAL);
+#endif
+#endif
+    view_base = base;
+    view_size = size;
+    return {static_cast<const u8*>(view_base), view_size};
+}
+
 std::string IOFile::ReadString(size_t length) const {
     std::vector<char> string_buffer(length);
 
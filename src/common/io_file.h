@@ -104,6 +104,12 @@ public:
 
     uintptr_t GetFileMapping();
 
+    /**
+     * Maps the whole file read-only into host memory.
+     * The view remains valid until the file is closed. Returns an empty span on failure.
+     */
+    std::span<const u8> MapReadOnlyView();
+
     int Open(const std::filesystem::path& path, FileAccessMode mode,
              FileType type = FileType::BinaryFile,
              FileShareFlag flag = FileShareFlag::ShareReadOnly);
@@ -219,6 +225,8 @@ private:
 
     std::FILE* file = nullptr;
     uintptr_t file_mapping = 0;
+    void* view_base = nullptr;
+    size_t view_size = 0;
 };
 
 u64 GetDirectorySize(const std::filesystem::path& path);
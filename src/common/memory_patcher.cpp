@@ -2,10 +2,15 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <array>
 #include <codecvt>
+#include <limits>
+#include <span>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <pugixml.hpp>
+#include <xxhash.h>
 #ifdef ENABLE_QT_GUI
 #include <QDir>
 #include <QFile>
@@ -117,7 +122,46 @@ std::string convertValueToHex(const std::string type, const std::string valueStr
     return result;
 }
 
+namespace {
+
+struct PatchLine {
+    std::string modNameStr;
+    std::string offsetStr;
+    std::string valueStr;
+    std::string targetStr;
+    std::string sizeStr;
+    bool littleEndian;
+    PatchMask patchMask;
+    int maskOffset;
+};
+
+/// Resolves every signature used by the lines in one pass, then applies them in order.
+void ApplyPatchLines(const std::vector<PatchLine>& lines) {
+    std::vector<std::string> signatures;
+    for (const PatchLine& line : lines) {
+        if (line.patchMask == PatchMask::None) {
+            continue;
+        }
+        signatures.push_back(line.offsetStr);
+        if (line.patchMask == PatchMask::Mask_Jump32) {
+            signatures.push_back(line.targetStr);
+        }
+    }
+    PrepareScan(signatures);
+
+    for (const PatchLine& line : lines) {
+        PatchMemory(line.modNameStr, line.offsetStr, line.valueStr, line.targetStr, line.sizeStr,
+                    false, line.littleEndian, line.patchMask, line.maskOffset);
+    }
+}
+
+/// Hashes the eboot image before any patch is applied. Scan results are keyed to this hash.
+void HashScanImage();
+
+} // Anonymous namespace
+
 void OnGameLoaded() {
+    HashScanImage();
 
     if (!patchFile.empty()) {
         std::filesystem::path patchDir = Common::FS::GetUserPath(Common::FS::PathType::PatchesDir);
@@ -127,6 +171,7 @@ void OnGameLoaded() {
         pugi::xml_document doc;
         pugi::xml_parse_result result = doc.load_file(filePath.c_str());
 
+        std::vector<PatchLine> patch_lines;
         if (result) {
             auto patchXML = doc.child("Patch");
             for (pugi::xml_node_iterator it = patchXML.children().begin();
@@ -174,9 +219,16 @@ void OnGameLoaded() {
                                 maskOffsetValue = std::stoi(maskOffsetStr, 0, 10);
                             }
 
-                            MemoryPatcher::PatchMemory(currentPatchName, address, patchValue,
-                                                       targetStr, sizeStr, false, littleEndian,
-                                                       patchMask, maskOffsetValue);
+                            patch_lines.push_back(PatchLine{
+                                .modNameStr = currentPatchName,
+                                .offsetStr = address,
+                                .valueStr = patchValue,
+                                .targetStr = targetStr,
+                                .sizeStr = sizeStr,
+                                .littleEndian = littleEndian,
+                                .patchMask = patchMask,
+                                .maskOffset = maskOffsetValue,
+                            });
                         }
                     }
                 }
@@ -184,6 +236,7 @@ void OnGameLoaded() {
         } else
             LOG_ERROR(Loader, "couldnt patch parse xml : {}", result.description());
 
+        ApplyPatchLines(patch_lines);
         ApplyPendingPatches();
         return;
     }
@@ -247,6 +300,7 @@ void OnGameLoaded() {
 
         bool isEnabled = false;
         std::string currentPatchName;
+        std::vector<PatchLine> patch_lines;
         while (!xmlReader.atEnd()) {
             xmlReader.readNext();
 
@@ -328,10 +382,16 @@ void OnGameLoaded() {
                                 maskOffsetValue = std::stoi(maskOffsetStr.toStdString(), 0, 10);
                             }
 
-                            MemoryPatcher::PatchMemory(
-                                currentPatchName, address.toStdString(), patchValue.toStdString(),
-                                targetStr.toStdString(), sizeStr.toStdString(), false, littleEndian,
-                                patchMask, maskOffsetValue);
+                            patch_lines.push_back(PatchLine{
+                                .modNameStr = currentPatchName,
+                                .offsetStr = address.toStdString(),
+                                .valueStr = patchValue.toStdString(),
+                                .targetStr = targetStr.toStdString(),
+                                .sizeStr = sizeStr.toStdString(),
+                                .littleEndian = littleEndian,
+                                .patchMask = patchMask,
+                                .maskOffset = maskOffsetValue,
+                            });
                         }
                     }
                 }
@@ -343,6 +403,7 @@ void OnGameLoaded() {
         } else {
             LOG_INFO(Loader, "Patches loaded successfully");
         }
+        ApplyPatchLines(patch_lines);
         ApplyPendingPatches();
     }
 #endif
@@ -353,6 +414,13 @@ void AddPatchToQueue(patchInfo patchToAdd) {
 }
 
 void ApplyPendingPatches() {
+    std::vector<std::string> signatures;
+    for (const patchInfo& patch : pending_patches) {
+        if (patch.gameSerial == g_game_serial && patch.patchMask != PatchMask::None) {
+            signatures.push_back(patch.offsetStr);
+        }
+    }
+    PrepareScan(signatures);
 
     for (size_t i = 0; i < pending_patches.size(); ++i) {
         patchInfo currentPatch = pending_patches[i];
@@ -508,30 +576,184 @@ static std::vector<int32_t> PatternToByte(const std::string& pattern) {
     return bytes;
 }
 
-uintptr_t PatternScan(const std::string& signature) {
-    std::vector<int32_t> patternBytes = PatternToByte(signature);
-    const auto scanBytes = static_cast<uint8_t*>((void*)g_eboot_address);
-
-    const int32_t* sigPtr = patternBytes.data();
-    const size_t sigSize = patternBytes.size();
-
-    uint32_t foundResults = 0;
-    for (uint32_t i = 0; i < g_eboot_image_size - sigSize; ++i) {
-        bool found = true;
-        for (uint32_t j = 0; j < sigSize; ++j) {
-            if (scanBytes[i + j] != sigPtr[j] && sigPtr[j] != -1) {
-                found = false;
-                break;
+namespace {
+
+/// Signature compiled for matching. Wildcard positions have a zero mask and value.
+struct CompiledPattern {
+    std::vector<u8> values;
+    std::vector<u8> masks;
+    size_t anchor = 0;        ///< Offset of the fixed byte(s) used to find candidates
+    bool anchor_pair = false; ///< Anchor covers two consecutive fixed bytes
+    bool has_anchor = false;  ///< False for patterns made only of wildcards
+};
+
+constexpr u64 NotFound = std::numeric_limits<u64>::max();
+constexpr u32 NoPattern = std::numeric_limits<u32>::max();
+
+std::unordered_map<std::string, CompiledPattern> g_compiled_patterns;
+std::unordered_map<std::string, u64> g_scan_results; ///< Signature to offset in the eboot
+u64 g_scan_image_hash = 0;
+
+const CompiledPattern& CompilePattern(const std::string& signature) {
+    if (const auto it = g_compiled_patterns.find(signature); it != g_compiled_patterns.end()) {
+        return it->second;
+    }
+    const std::vector<int32_t> bytes = PatternToByte(signature);
+    CompiledPattern pattern;
+    pattern.values.reserve(bytes.size());
+    pattern.masks.reserve(bytes.size());
+    for (const int32_t byte : bytes) {
+        pattern.values.push_back(byte == -1 ? 0 : static_cast<u8>(byte));
+        pattern.masks.push_back(byte == -1 ? 0 : 0xFF);
+    }
+    // Prefer two consecutive fixed bytes as anchor, they are far more selective in code.
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if (bytes[i] == -1) {
+            continue;
+        }
+        if (!pattern.has_anchor) {
+            pattern.anchor = i;
+            pattern.has_anchor = true;
+        }
+        if (i + 1 < bytes.size() && bytes[i + 1] != -1) {
+            pattern.anchor = i;
+            pattern.anchor_pair = true;
+            break;
+        }
+    }
+    return g_compiled_patterns.emplace(signature, std::move(pattern)).first->second;
+}
+
+bool MatchesAt(const CompiledPattern& pattern, std::span<const u8> image, u64 offset) {
+    const size_t size = pattern.values.size();
+    if (offset > image.size() || image.size() - offset < size) {
+        return false;
+    }
+    const u8* data = image.data() + offset;
+    for (size_t i = 0; i < size; ++i) {
+        if ((data[i] & pattern.masks[i]) != pattern.values[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Finds the first match of every pattern with a single walk over the image. Patterns are
+/// bucketed by their anchor so each position only verifies the patterns that can start there.
+void ScanPatterns(std::span<const u8> image, std::span<const CompiledPattern* const> patterns,
+                  std::span<u64> results) {
+    std::ranges::fill(results, NotFound);
+
+    std::vector<u32> pair_heads(0x10000, NoPattern);
+    std::array<u32, 0x100> byte_heads;
+    byte_heads.fill(NoPattern);
+    std::vector<u32> next(patterns.size(), NoPattern);
+    size_t remaining = 0;
+    for (u32 i = 0; i < patterns.size(); ++i) {
+        const CompiledPattern& pattern = *patterns[i];
+        if (!pattern.has_anchor) {
+            if (MatchesAt(pattern, image, 0)) {
+                results[i] = 0;
+            }
+            continue;
+        }
+        const u8 first = pattern.values[pattern.anchor];
+        u32& head = pattern.anchor_pair ? pair_heads[first | pattern.values[pattern.anchor + 1] << 8]
+                                        : byte_heads[first];
+        next[i] = head;
+        head = i;
+        ++remaining;
+    }
+
+    const auto try_match = [&](u32 index, size_t position) {
+        if (results[index] != NotFound) {
+            return;
+        }
+        const CompiledPattern& pattern = *patterns[index];
+        if (position < pattern.anchor) {
+            return;
+        }
+        const u64 start = position - pattern.anchor;
+        if (MatchesAt(pattern, image, start)) {
+            results[index] = start;
+            --remaining;
+        }
+    };
+
+    for (size_t i = 0; i < image.size() && remaining != 0; ++i) {
+        for (u32 p = byte_heads[image[i]]; p != NoPattern; p = next[p]) {
+            try_match(p, i);
+        }
+        if (i + 1 < image.size()) {
+            const u32 key = image[i] | image[i + 1] << 8;
+            for (u32 p = pair_heads[key]; p != NoPattern; p = next[p]) {
+                try_match(p, i);
             }
         }
+    }
+}
+
+std::span<const u8> EbootImage() {
+    return {reinterpret_cast<const u8*>(g_eboot_address), g_eboot_image_size};
+}
+
+void HashScanImage() {
+    if (g_eboot_address == 0) {
+        return;
+    }
+    const auto image = EbootImage();
+    const u64 image_hash = XXH3_64bits(image.data(), image.size());
+    if (image_hash != g_scan_image_hash) {
+        g_scan_results.clear();
+        g_scan_image_hash = image_hash;
+    }
+}
+
+} // Anonymous namespace
+
+void PrepareScan(const std::vector<std::string>& signatures) {
+    if (signatures.empty() || g_eboot_address == 0) {
+        return;
+    }
+    const auto image = EbootImage();
+
+    std::vector<std::string> pending;
+    std::vector<const CompiledPattern*> patterns;
+    for (const std::string& signature : signatures) {
+        if (g_scan_results.contains(signature) ||
+            std::ranges::find(pending, signature) != pending.end()) {
+            continue;
+        }
+        pending.push_back(signature);
+        patterns.push_back(&CompilePattern(signature));
+    }
+    if (patterns.empty()) {
+        return;
+    }
+
+    std::vector<u64> offsets(patterns.size());
+    ScanPatterns(image, patterns, offsets);
+    for (size_t i = 0; i < pending.size(); ++i) {
+        g_scan_results.emplace(std::move(pending[i]), offsets[i]);
+    }
+}
+
+uintptr_t PatternScan(const std::string& signature) {
+    const auto image = EbootImage();
+    const CompiledPattern& pattern = CompilePattern(signature);
 
-        if (found) {
-            foundResults++;
-            return reinterpret_cast<uintptr_t>(&scanBytes[i]);
+    // Earlier patches may have rewritten the bytes of a cached match, so verify it first.
+    if (const auto it = g_scan_results.find(signature); it != g_scan_results.end()) {
+        if (it->second != NotFound && MatchesAt(pattern, image, it->second)) {
+            return g_eboot_address + it->second;
         }
     }
 
-    return 0;
+    const std::array patterns{&pattern};
+    u64 offset;
+    ScanPatterns(image, patterns, std::span{&offset, 1});
+    g_scan_results.insert_or_assign(signature, offset);
+    return offset != NotFound ? g_eboot_address + offset : 0;
 }
 
 } // namespace MemoryPatcher
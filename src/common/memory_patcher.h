@@ -43,6 +43,11 @@ void PatchMemory(std::string modNameStr, std::string offsetStr, std::string valu
                  PatchMask patchMask = PatchMask::None, int maskOffset = 0);
 
 static std::vector<int32_t> PatternToByte(const std::string& pattern);
+
+/// Resolves all signatures with a single pass over the eboot image and caches the results
+/// for subsequent PatternScan calls. Results are keyed to the hash of the unpatched image.
+void PrepareScan(const std::vector<std::string>& signatures);
+
 uintptr_t PatternScan(const std::string& signature);
 
 } // namespace MemoryPatcher
\ No newline at end of file
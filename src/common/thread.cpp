@@ -2,6 +2,9 @@
 // SPDX-FileCopyrightText: 2014 Citra Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <bit>
+#include <cerrno>
 #include <string>
 #include <thread>
 
@@ -9,6 +12,9 @@
 #include "common/logging/log.h"
 #include "common/thread.h"
 #include "ntapi.h"
+#if defined(_M_X64) || defined(__x86_64__)
+#include <xmmintrin.h>
+#endif
 #ifdef __APPLE__
 #include <mach/mach.h>
 #include <mach/mach_time.h>
@@ -27,6 +33,10 @@
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <sys/prctl.h>
+#include <time.h>
+#endif
 
 #ifdef __FreeBSD__
 #define cpu_set_t cpuset_t
@@ -192,6 +202,112 @@ void SetThreadName(void* thread, const char* name) {
 
 #endif
 
+#ifdef __linux__
+
+void ReduceCurrentThreadTimerSlack() {
+    // The default slack of 50us would dominate the error of short guest waits.
+    prctl(PR_SET_TIMERSLACK, 1UL);
+}
+
+static bool HostSleepUntil(std::chrono::steady_clock::time_point target, bool interruptible) {
+    // steady_clock is CLOCK_MONOTONIC, so the target can be handed to the kernel as absolute
+    // time and interrupted sleeps resume without accumulating drift.
+    const auto since_epoch = target.time_since_epoch();
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    const timespec ts{
+        .tv_sec = static_cast<time_t>(seconds.count()),
+        .tv_nsec = static_cast<long>((since_epoch - seconds).count()),
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        if (interruptible) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#else
+
+void ReduceCurrentThreadTimerSlack() {
+    // Not implemented
+}
+
+static bool HostSleepUntil(std::chrono::steady_clock::time_point target, bool interruptible) {
+    const auto now = std::chrono::steady_clock::now();
+    if (target > now) {
+        AccurateSleep(target - now);
+    }
+    return true;
+}
+
+#endif
+
+static void ThreadPause() {
+#if defined(_M_X64) || defined(__x86_64__)
+    _mm_pause();
+#elif defined(__aarch64__) && defined(_MSC_VER)
+    __yield();
+#elif defined(__aarch64__)
+    asm("yield");
+#endif
+}
+
+/// Upper bound of the part of a sleep that is not handed to the host sleep.
+constexpr s64 MaxSpinMarginNs = 200'000;
+
+/// Only this last part before the deadline is busy spun, the rest of the margin yields.
+constexpr auto MaxBusySpin = std::chrono::microseconds{4};
+
+static std::atomic<s64> host_wake_latency_ns{50'000};
+static SleepStats sleep_stats{};
+
+bool SleepUntil(std::chrono::steady_clock::time_point deadline, bool interruptible) {
+    using namespace std::chrono;
+    const auto begin = steady_clock::now();
+    if (deadline <= begin) {
+        // A zero sleep still gives up the rest of the time slice, like the host would.
+        std::this_thread::yield();
+        return true;
+    }
+
+    // Spin for twice the recent host wake latency, which covers most of its jitter.
+    const s64 latency_ns = host_wake_latency_ns.load(std::memory_order_relaxed);
+    const auto margin = nanoseconds{std::clamp<s64>(latency_ns * 2, 0, MaxSpinMarginNs)};
+    const auto wake_target = deadline - margin;
+    auto spin_begin = begin;
+    if (wake_target > begin) {
+        if (!HostSleepUntil(wake_target, interruptible)) {
+            return false;
+        }
+        spin_begin = steady_clock::now();
+        const s64 late_ns = duration_cast<nanoseconds>(spin_begin - wake_target).count();
+        host_wake_latency_ns.store(latency_ns + (late_ns - latency_ns) / 8,
+                                   std::memory_order_relaxed);
+    }
+    auto now = spin_begin;
+    while (now < deadline - MaxBusySpin) {
+        std::this_thread::yield();
+        now = steady_clock::now();
+    }
+    while (now < deadline) {
+        ThreadPause();
+        now = steady_clock::now();
+    }
+
+    const u64 late_us = duration_cast<microseconds>(now - deadline).count();
+    const size_t bucket =
+        std::min<size_t>(std::bit_width(late_us), SleepStats::NumWakeErrorBuckets - 1);
+    ++sleep_stats.wake_error[bucket];
+    ++sleep_stats.num_sleeps;
+    sleep_stats.slept_ns += duration_cast<nanoseconds>(spin_begin - begin).count();
+    sleep_stats.spun_ns += duration_cast<nanoseconds>(now - spin_begin).count();
+    return true;
+}
+
+const SleepStats& GetSleepStats() {
+    return sleep_stats;
+}
+
 AccurateTimer::AccurateTimer(std::chrono::nanoseconds target_interval)
     : target_interval(target_interval) {}
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include "common/types.h"
 
@@ -25,6 +27,30 @@ void SetCurrentThreadName(const char* name);
 
 void SetThreadName(void* thread, const char* name);
 
+/// Lowers the timer slack of the current thread, so that its sleeps are not deferred by the
+/// host to batch wakeups. Only has an effect on Linux.
+void ReduceCurrentThreadTimerSlack();
+
+/// Sleeps until the steady clock reaches the deadline. The host sleep targets an absolute time
+/// slightly before the deadline, and the remainder yields, busy spinning only for the last few
+/// microseconds. The margin follows how late the host has been waking up recent sleeps.
+/// Returns false when the sleep is interruptible and a signal ended the host sleep early.
+bool SleepUntil(std::chrono::steady_clock::time_point deadline, bool interruptible = false);
+
+struct SleepStats {
+    static constexpr size_t NumWakeErrorBuckets = 12;
+
+    /// Bucket i counts wakeups that were late by less than 2^i microseconds, the last bucket
+    /// also counts all later ones.
+    std::array<std::atomic<u64>, NumWakeErrorBuckets> wake_error{};
+    std::atomic<u64> num_sleeps{};
+    std::atomic<u64> slept_ns{}; ///< Time spent in host sleeps
+    std::atomic<u64> spun_ns{};  ///< CPU time spent spinning towards deadlines
+};
+
+/// Returns statistics of all SleepUntil calls so far.
+const SleepStats& GetSleepStats();
+
 class AccurateTimer {
     std::chrono::nanoseconds target_interval{};
     std::chrono::nanoseconds total_wait{};
@@ -5,6 +5,7 @@
 
 #include "common/config.h"
 #include "common/singleton.h"
+#include "common/thread.h"
 #include "core/debug_state.h"
 #include "imgui.h"
 #include "imgui_internal.h"
@@ -95,6 +96,18 @@ void FrameGraph::Draw() {
 
         SeparatorText("Frame graph");
         DrawFrameGraph();
+
+        const auto& sleep_stats = Common::GetSleepStats();
+        SeparatorText("Guest sleeps");
+        Text("Sleeps: %llu Slept: %.3f ms Spun: %.3f ms",
+             static_cast<unsigned long long>(sleep_stats.num_sleeps.load()),
+             sleep_stats.slept_ns.load() / 1'000'000.0, sleep_stats.spun_ns.load() / 1'000'000.0);
+        std::array<float, Common::SleepStats::NumWakeErrorBuckets> wake_error;
+        for (u32 i = 0; i < wake_error.size(); ++i) {
+            wake_error[i] = static_cast<float>(sleep_stats.wake_error[i].load());
+        }
+        PlotHistogram("Wake error (log2 us)", wake_error.data(),
+                      static_cast<int>(wake_error.size()));
     }
     End();
 }
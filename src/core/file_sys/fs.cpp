@@ -155,17 +155,30 @@ void MntPoints::IterateDirectory(std::string_view guest_directory,
     // Only need to consider patch path if it exists and does not resolve to the same as base.
     const auto apply_patch = base_path != patch_path && std::filesystem::exists(patch_path);
 
+    // Record the type of each entry so following stats don't have to query the host for it.
+    // Listing a directory usually yields it for free, while the size would cost a host stat
+    // per entry, so that is only filled in once an entry is actually stat'ed.
+    const auto visit = [&](const std::filesystem::directory_entry& entry) {
+        std::error_code ec;
+        const bool is_file = !entry.is_directory(ec);
+        if (!ec) {
+            std::scoped_lock lk{stat_mutex};
+            stat_cache[entry.path()] = {is_file, std::nullopt};
+        }
+        callback(entry.path(), is_file);
+    };
+
     // Pass 1: Any files that existed in the base directory, using patch directory if needed.
     if (std::filesystem::exists(base_path)) {
         for (const auto& entry : std::filesystem::directory_iterator(base_path)) {
             if (apply_patch) {
                 const auto patch_entry_path = patch_path / entry.path().filename();
                 if (std::filesystem::exists(patch_entry_path)) {
-                    callback(patch_entry_path, !std::filesystem::is_directory(patch_entry_path));
+                    visit(std::filesystem::directory_entry{patch_entry_path});
                     continue;
                 }
             }
-            callback(entry.path(), !entry.is_directory());
+            visit(entry);
         }
     }
 
@@ -174,12 +187,46 @@ void MntPoints::IterateDirectory(std::string_view guest_directory,
         for (const auto& entry : std::filesystem::directory_iterator(patch_path)) {
             const auto base_entry_path = base_path / entry.path().filename();
             if (!std::filesystem::exists(base_entry_path)) {
-                callback(entry.path(), !entry.is_directory());
+                visit(entry);
             }
         }
     }
 }
 
+std::optional<StatEntry> MntPoints::GetCachedStat(const std::filesystem::path& host_path) {
+    std::scoped_lock lk{stat_mutex};
+    const auto it = stat_cache.find(host_path);
+    if (it == stat_cache.end()) {
+        return std::nullopt;
+    }
+    if (it->second.is_file && !it->second.size) {
+        // Query under the lock, so an invalidation cannot be overwritten with a stale size.
+        std::error_code ec;
+        const u64 size = std::filesystem::file_size(host_path, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        it.value().size = size;
+    }
+    return it->second;
+}
+
+void MntPoints::InvalidateStat(const std::filesystem::path& host_path, bool recursive) {
+    std::scoped_lock lk{stat_mutex};
+    stat_cache.erase(host_path);
+    if (!recursive) {
+        return;
+    }
+    const auto prefix = host_path.native() + std::filesystem::path::preferred_separator;
+    for (auto it = stat_cache.begin(); it != stat_cache.end();) {
+        if (it->first.native().starts_with(prefix)) {
+            it = stat_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 int HandleTable::CreateHandle() {
     std::scoped_lock lock{m_mutex};
 
@@ -5,6 +5,7 @@
 
 #include <atomic>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 #include <tsl/robin_map.h>
@@ -14,6 +15,12 @@
 
 namespace Core::FileSys {
 
+/// Metadata of a host path recorded while enumerating its directory.
+struct StatEntry {
+    bool is_file;
+    std::optional<u64> size; ///< Only known for files, queried on the first stat
+};
+
 class MntPoints {
 #ifdef _WIN64
     static constexpr bool NeedsCaseInsensitiveSearch = false;
@@ -42,6 +49,13 @@ public:
     void IterateDirectory(std::string_view guest_directory,
                           const IterateDirectoryCallback& callback);
 
+    /// Returns the metadata of a host path if it was recorded by a directory enumeration.
+    /// The size of a file is queried from the host and recorded the first time.
+    std::optional<StatEntry> GetCachedStat(const std::filesystem::path& host_path);
+
+    /// Drops the recorded metadata of a host path, and of everything below it if recursive.
+    void InvalidateStat(const std::filesystem::path& host_path, bool recursive = false);
+
     const MntPair* GetMountFromHostPath(const std::string& host_path) {
         std::scoped_lock lock{m_mutex};
         const auto it = std::ranges::find_if(m_mnt_pairs, [&](const MntPair& mount) {
@@ -65,11 +79,14 @@ private:
     std::vector<std::filesystem::path> path_parts;
     tsl::robin_map<std::filesystem::path, std::filesystem::path> path_cache;
     std::mutex m_mutex;
+    tsl::robin_map<std::filesystem::path, StatEntry> stat_cache;
+    std::mutex stat_mutex;
 };
 
 struct DirEntry {
     std::string name;
     bool isFile;
+    u32 fileno;
 };
 
 enum class FileType {
@@ -86,6 +103,7 @@ struct File {
     Common::FS::IOFile f;
     std::vector<DirEntry> dirents;
     u32 dirents_index;
+    bool dirents_loaded{};
     std::mutex m_mutex;
     std::shared_ptr<Devices::BaseDevice> device; // only valid for type == Device
 };
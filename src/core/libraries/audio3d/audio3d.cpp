@@ -1,15 +1,32 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <bit>
+#include <memory>
+#include <mutex>
+#include <utility>
+
 #include "common/logging/log.h"
 #include "core/libraries/audio/audioout.h"
 #include "core/libraries/audio3d/audio3d.h"
 #include "core/libraries/audio3d/audio3d_error.h"
+#include "core/libraries/audio3d/audio3d_impl.h"
 #include "core/libraries/error_codes.h"
 #include "core/libraries/libs.h"
 
 namespace Libraries::Audio3d {
 
+constexpr u32 MaxPorts = 4;
+
+static std::mutex port_mutex;
+static std::array<std::shared_ptr<Audio3dPort>, MaxPorts> ports;
+
+/// Returns a reference to the port, keeping it alive while it is used after the lock is dropped.
+static std::shared_ptr<Audio3dPort> GetPort(OrbisAudio3dPortId port_id) {
+    std::scoped_lock lk{port_mutex};
+    return port_id < MaxPorts ? ports[port_id] : nullptr;
+}
+
 int PS4_SYSV_ABI sceAudio3dInitialize(s64 iReserved) {
     LOG_INFO(Lib_Audio3d, "iReserved = {}", iReserved);
     return ORBIS_OK;
@@ -18,6 +35,16 @@ int PS4_SYSV_ABI sceAudio3dInitialize(s64 iReserved) {
 int PS4_SYSV_ABI sceAudio3dTerminate() {
     // TODO: When not initialized or some ports still open, return ORBIS_AUDIO3D_ERROR_NOT_READY
     LOG_INFO(Lib_Audio3d, "called");
+    std::array<std::shared_ptr<Audio3dPort>, MaxPorts> closed_ports;
+    {
+        std::scoped_lock lk{port_mutex};
+        closed_ports = std::exchange(ports, {});
+    }
+    for (const auto& port : closed_ports) {
+        if (port) {
+            port->Close();
+        }
+    }
     return ORBIS_OK;
 }
 
@@ -40,11 +67,45 @@ int PS4_SYSV_ABI sceAudio3dPortOpen(OrbisUserServiceUserId iUserId,
                                     const OrbisAudio3dOpenParameters* pParameters,
                                     OrbisAudio3dPortId* pId) {
     LOG_INFO(Lib_Audio3d, "iUserId = {}", iUserId);
+    if (pParameters == nullptr || pId == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    }
+    const auto& params = *pParameters;
+    LOG_INFO(Lib_Audio3d, "granularity = {}, max_objects = {}, queue_depth = {}, num_beds = {}",
+             params.granularity, params.max_objects, params.queue_depth, params.num_beds);
+    if (params.rate != OrbisAudio3dRate::Rate48000 || params.granularity < 256 ||
+        params.granularity > 2048 || params.granularity % 256 != 0 || params.queue_depth == 0 ||
+        params.queue_depth > MaxQueueDepth) {
+        LOG_ERROR(Lib_Audio3d, "Invalid open parameters");
+        return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    }
+
+    std::scoped_lock lk{port_mutex};
+    const auto it = std::ranges::find_if(ports, [](const auto& port) { return !port; });
+    if (it == ports.end()) {
+        return ORBIS_AUDIO3D_ERROR_OUT_OF_RESOURCES;
+    }
+    auto port = std::make_shared<Audio3dPort>(iUserId, params);
+    if (!port->IsOpen()) {
+        return ORBIS_AUDIO3D_ERROR_OUT_OF_RESOURCES;
+    }
+    *it = std::move(port);
+    *pId = static_cast<OrbisAudio3dPortId>(std::distance(ports.begin(), it));
     return ORBIS_OK;
 }
 
 int PS4_SYSV_ABI sceAudio3dPortClose(OrbisAudio3dPortId uiPortId) {
     LOG_INFO(Lib_Audio3d, "uiPortId = {}", uiPortId);
+    std::shared_ptr<Audio3dPort> port;
+    {
+        std::scoped_lock lk{port_mutex};
+        if (uiPortId >= MaxPorts || !ports[uiPortId]) {
+            return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+        }
+        port = std::move(ports[uiPortId]);
+    }
+    // Other threads may still hold the port, stop output and fail their blocking pushes.
+    port->Close();
     return ORBIS_OK;
 }
 
@@ -63,12 +124,26 @@ int PS4_SYSV_ABI sceAudio3dPortFlush(OrbisAudio3dPortId uiPortId) {
 
 int PS4_SYSV_ABI sceAudio3dPortAdvance(OrbisAudio3dPortId uiPortId) {
     LOG_TRACE(Lib_Audio3d, "uiPortId = {}", uiPortId);
-    return ORBIS_OK;
+    const auto port = GetPort(uiPortId);
+    if (port == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+    }
+    if (port->BufferMode() == OrbisAudio3dBufferMode::NoAdvance) {
+        return ORBIS_AUDIO3D_ERROR_NOT_SUPPORTED;
+    }
+    return port->Advance();
 }
 
 int PS4_SYSV_ABI sceAudio3dPortPush(OrbisAudio3dPortId uiPortId, OrbisAudio3dBlocking eBlocking) {
     LOG_TRACE(Lib_Audio3d, "uiPortId = {}", uiPortId);
-    return ORBIS_OK;
+    const auto port = GetPort(uiPortId);
+    if (port == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+    }
+    if (port->BufferMode() != OrbisAudio3dBufferMode::AdvanceAndPush) {
+        return ORBIS_AUDIO3D_ERROR_NOT_SUPPORTED;
+    }
+    return port->Push(eBlocking);
 }
 
 int PS4_SYSV_ABI sceAudio3dPortGetAttributesSupported(OrbisAudio3dPortId uiPortId,
@@ -81,26 +156,58 @@ int PS4_SYSV_ABI sceAudio3dPortGetAttributesSupported(OrbisAudio3dPortId uiPortI
 int PS4_SYSV_ABI sceAudio3dPortGetQueueLevel(OrbisAudio3dPortId uiPortId, u32* pQueueLevel,
                                              u32* pQueueAvailable) {
     LOG_TRACE(Lib_Audio3d, "uiPortId = {}", uiPortId);
+    if (pQueueLevel == nullptr && pQueueAvailable == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    }
+    const auto port = GetPort(uiPortId);
+    if (port == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+    }
+    port->GetQueueLevel(pQueueLevel, pQueueAvailable);
     return ORBIS_OK;
 }
 
 int PS4_SYSV_ABI sceAudio3dObjectReserve(OrbisAudio3dPortId uiPortId, OrbisAudio3dObjectId* pId) {
     LOG_INFO(Lib_Audio3d, "uiPortId = {}", uiPortId);
-    return ORBIS_OK;
+    if (pId == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    }
+    const auto port = GetPort(uiPortId);
+    if (port == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+    }
+    return port->ReserveObject(pId);
 }
 
 int PS4_SYSV_ABI sceAudio3dObjectUnreserve(OrbisAudio3dPortId uiPortId,
                                            OrbisAudio3dObjectId uiObjectId) {
     LOG_INFO(Lib_Audio3d, "uiPortId = {}, uiObjectId = {}", uiPortId, uiObjectId);
-    return ORBIS_OK;
+    const auto port = GetPort(uiPortId);
+    if (port == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+    }
+    return port->UnreserveObject(uiObjectId);
 }
 
 int PS4_SYSV_ABI sceAudio3dObjectSetAttributes(OrbisAudio3dPortId uiPortId,
                                                OrbisAudio3dObjectId uiObjectId,
                                                size_t szNumAttributes,
                                                const OrbisAudio3dAttribute* pAttributeArray) {
-    LOG_INFO(Lib_Audio3d, "uiPortId = {}, uiObjectId = {}, szNumAttributes = {}", uiPortId,
-             uiObjectId, szNumAttributes);
+    LOG_TRACE(Lib_Audio3d, "uiPortId = {}, uiObjectId = {}, szNumAttributes = {}", uiPortId,
+              uiObjectId, szNumAttributes);
+    if (pAttributeArray == nullptr && szNumAttributes != 0) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    }
+    const auto port = GetPort(uiPortId);
+    if (port == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+    }
+    for (size_t i = 0; i < szNumAttributes; ++i) {
+        if (const s32 ret = port->SetObjectAttribute(uiObjectId, pAttributeArray[i]);
+            ret != ORBIS_OK) {
+            return ret;
+        }
+    }
     return ORBIS_OK;
 }
 
@@ -109,16 +216,21 @@ int PS4_SYSV_ABI sceAudio3dBedWrite(OrbisAudio3dPortId uiPortId, u32 uiNumChanne
                                     u32 uiNumSamples) {
     LOG_TRACE(Lib_Audio3d, "uiPortId = {}, uiNumChannels = {}, uiNumSamples = {}", uiPortId,
               uiNumChannels, uiNumSamples);
-    return ORBIS_OK;
+    const auto port = GetPort(uiPortId);
+    if (port == nullptr) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+    }
+    return port->WriteBed(uiNumChannels, eFormat, pBuffer, uiNumSamples);
 }
 
 int PS4_SYSV_ABI sceAudio3dBedWrite2(OrbisAudio3dPortId uiPortId, u32 uiNumChannels,
                                      OrbisAudio3dFormat eFormat, const void* pBuffer,
                                      u32 uiNumSamples, OrbisAudio3dOutputRoute eOutputRoute,
                                      bool bRestricted) {
-    LOG_INFO(Lib_Audio3d, "uiPortId = {}, uiNumChannels = {}, uiNumSamples = {}, bRestricted = {}",
-             uiPortId, uiNumChannels, uiNumSamples, bRestricted);
-    return ORBIS_OK;
+    LOG_TRACE(Lib_Audio3d,
+              "uiPortId = {}, uiNumChannels = {}, uiNumSamples = {}, bRestricted = {}", uiPortId,
+              uiNumChannels, uiNumSamples, bRestricted);
+    return sceAudio3dBedWrite(uiPortId, uiNumChannels, eFormat, pBuffer, uiNumSamples);
 }
 
 size_t PS4_SYSV_ABI sceAudio3dGetSpeakerArrayMemorySize(u32 uiNumSpeakers, bool bIs3d) {
@@ -178,12 +290,14 @@ s32 PS4_SYSV_ABI sceAudio3dAudioOutOpen(OrbisAudio3dPortId uiPortId, OrbisUserSe
     LOG_INFO(Lib_Audio3d,
              "uiPortId = {}, userId = {}, type = {}, index = {}, len = {}, freq = {}, param = {}",
              uiPortId, userId, type, index, len, freq, param);
-    return ORBIS_OK;
+    return AudioOut::sceAudioOutOpen(
+        userId, static_cast<AudioOut::OrbisAudioOutPort>(type), index, len, freq,
+        std::bit_cast<AudioOut::OrbisAudioOutParamExtendedInformation>(param));
 }
 
 s32 PS4_SYSV_ABI sceAudio3dAudioOutClose(s32 handle) {
     LOG_INFO(Lib_Audio3d, "handle = {}", handle);
-    return ORBIS_OK;
+    return AudioOut::sceAudioOutClose(handle);
 }
 
 s32 PS4_SYSV_ABI sceAudio3dAudioOutOutput(s32 handle, const void* ptr) {
@@ -192,7 +306,7 @@ s32 PS4_SYSV_ABI sceAudio3dAudioOutOutput(s32 handle, const void* ptr) {
         LOG_ERROR(Lib_Audio3d, "invalid Output ptr");
         return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
     }
-    return ORBIS_OK;
+    return AudioOut::sceAudioOutOutput(handle, const_cast<void*>(ptr));
 }
 
 s32 PS4_SYSV_ABI sceAudio3dAudioOutOutputs(::Libraries::AudioOut::OrbisAudioOutOutputParam* param,
@@ -202,7 +316,7 @@ s32 PS4_SYSV_ABI sceAudio3dAudioOutOutputs(::Libraries::AudioOut::OrbisAudioOutO
         LOG_ERROR(Lib_Audio3d, "invalid OutputParam ptr");
         return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
     }
-    return ORBIS_OK;
+    return AudioOut::sceAudioOutOutputs(param, num);
 }
 
 int PS4_SYSV_ABI sceAudio3dPortCreate(u32 uiGranularity, OrbisAudio3dRate eRate, s64 iReserved,
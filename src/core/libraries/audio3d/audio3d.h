@@ -13,7 +13,7 @@ class SymbolsResolver;
 
 namespace Libraries::Audio3d {
 
-class Audio3d;
+class Audio3dPort;
 
 using OrbisUserServiceUserId = s32;
 using OrbisAudio3dPortId = u32;
@@ -1,13 +1,333 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numbers>
+#include <xmmintrin.h>
+
 #include "audio3d_error.h"
 #include "audio3d_impl.h"
 
+#include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/libraries/audio/audioout.h"
 #include "core/libraries/error_codes.h"
-#include "core/libraries/kernel/kernel.h"
 
-using namespace Libraries::Kernel;
+namespace Libraries::Audio3d {
+
+namespace {
+
+constexpr float Pi = std::numbers::pi_v<float>;
+
+/// Queue level stored once the port is closed. Wakes up and fails blocked pushes.
+constexpr u32 ClosedQueueLevel = std::numeric_limits<u32>::max();
+
+struct Speaker {
+    u32 channel;
+    float azimuth;
+};
+
+/// Bed speakers ordered by azimuth, in radians clockwise from the front. LFE is never panned to.
+constexpr std::array<Speaker, NumBedChannels - 1> SpeakerRing = {{
+    {2, 0.0f},              // FC
+    {1, Pi / 6.0f},         // FR
+    {7, Pi / 2.0f},         // SR
+    {5, 5.0f * Pi / 6.0f},  // BR
+    {4, 7.0f * Pi / 6.0f},  // BL
+    {6, 3.0f * Pi / 2.0f},  // SL
+    {0, 11.0f * Pi / 6.0f}, // FL
+}};
+
+float ReadSample(OrbisAudio3dFormat format, const void* buffer, size_t index) {
+    if (format == OrbisAudio3dFormat::S16) {
+        return static_cast<const s16*>(buffer)[index] / 32768.0f;
+    }
+    return static_cast<const float*>(buffer)[index];
+}
+
+} // Anonymous namespace
+
+BedGains ComputeBedGains(const OrbisAudio3dPosition& position, float spread, float gain) {
+    float azimuth = std::atan2(position.fX, position.fZ);
+    if (azimuth < 0.0f) {
+        azimuth += 2.0f * Pi;
+    }
+
+    size_t left = SpeakerRing.size() - 1;
+    for (size_t i = 0; i < SpeakerRing.size(); ++i) {
+        if (SpeakerRing[i].azimuth > azimuth) {
+            break;
+        }
+        left = i;
+    }
+    const size_t right = (left + 1) % SpeakerRing.size();
+    float arc = SpeakerRing[right].azimuth - SpeakerRing[left].azimuth;
+    float offset = azimuth - SpeakerRing[left].azimuth;
+    if (arc <= 0.0f) {
+        arc += 2.0f * Pi;
+    }
+    if (offset < 0.0f) {
+        offset += 2.0f * Pi;
+    }
+    const float angle = (offset / arc) * (Pi / 2.0f);
+
+    BedGains gains{};
+    gains[SpeakerRing[left].channel] = std::cos(angle);
+    gains[SpeakerRing[right].channel] = std::sin(angle);
+
+    const float spread_weight = std::clamp(spread / (2.0f * Pi), 0.0f, 1.0f);
+    const float surround_gain = 1.0f / std::sqrt(static_cast<float>(SpeakerRing.size()));
+    for (const auto& speaker : SpeakerRing) {
+        float& channel_gain = gains[speaker.channel];
+        channel_gain =
+            (channel_gain * (1.0f - spread_weight) + surround_gain * spread_weight) * gain;
+    }
+    return gains;
+}
+
+void PanObject(std::span<float> bed, std::span<const float> samples, const BedGains& gains) {
+    ASSERT(bed.size() >= samples.size() * NumBedChannels);
+    const __m128 gains_lo = _mm_loadu_ps(gains.data());
+    const __m128 gains_hi = _mm_loadu_ps(gains.data() + 4);
+    float* out = bed.data();
+    for (const float sample : samples) {
+        const __m128 value = _mm_set1_ps(sample);
+        _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(value, gains_lo)));
+        _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(value, gains_hi)));
+        out += NumBedChannels;
+    }
+}
+
+void DownmixBed(std::span<float> out, std::span<const float> bed) {
+    const size_t num_frames = bed.size() / NumBedChannels;
+    ASSERT(out.size() >= num_frames * NumHostChannels);
+    constexpr float Attenuation = std::numbers::sqrt2_v<float> / 2.0f;
+    const __m128 front_scale = _mm_setr_ps(1.0f, 1.0f, Attenuation, Attenuation);
+    const __m128 rear_scale = _mm_set1_ps(Attenuation);
+    for (size_t i = 0; i < num_frames; ++i) {
+        const float* in = bed.data() + i * NumBedChannels;
+        const __m128 front = _mm_loadu_ps(in);    // FL FR FC LFE
+        const __m128 rear = _mm_loadu_ps(in + 4); // BL BR SL SR
+        // [FL + BL * a, FR + BR * a, FC * a + SL * a, FC * a + SR * a]
+        const __m128 center = _mm_shuffle_ps(front, front, _MM_SHUFFLE(2, 2, 1, 0));
+        const __m128 sum =
+            _mm_add_ps(_mm_mul_ps(center, front_scale), _mm_mul_ps(rear, rear_scale));
+        const __m128 stereo = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        _mm_storel_pi(reinterpret_cast<__m64*>(out.data() + i * NumHostChannels), stereo);
+    }
+}
+
+Audio3dPort::Audio3dPort(OrbisUserServiceUserId user_id,
+                         const OrbisAudio3dOpenParameters& parameters_)
+    : parameters{parameters_}, objects(parameters.max_objects),
+      bed(parameters.granularity * NumBedChannels),
+      staging(parameters.granularity * NumHostChannels),
+      frames(parameters.queue_depth * staging.size()) {
+    AudioOut::OrbisAudioOutParamExtendedInformation param_type{};
+    param_type.data_format.Assign(AudioOut::OrbisAudioOutParamFormat::FloatStereo);
+    audio_out_handle = AudioOut::sceAudioOutOpen(user_id, AudioOut::OrbisAudioOutPort::Main, 0,
+                                                 parameters.granularity, 48000, param_type);
+    if (!IsOpen()) {
+        LOG_ERROR(Lib_Audio3d, "Failed to open output port: {:#x}", audio_out_handle);
+        return;
+    }
+    output_thread = std::jthread{std::bind_front(&Audio3dPort::OutputThread, this)};
+}
+
+Audio3dPort::~Audio3dPort() {
+    Close();
+    if (IsOpen()) {
+        AudioOut::sceAudioOutClose(audio_out_handle);
+    }
+}
+
+s32 Audio3dPort::ReserveObject(OrbisAudio3dObjectId* object_id) {
+    std::scoped_lock lk{mutex};
+    const auto it = std::ranges::find_if(objects, [](const Object& obj) { return !obj.reserved; });
+    if (it == objects.end()) {
+        return ORBIS_AUDIO3D_ERROR_OUT_OF_RESOURCES;
+    }
+    *it = Object{};
+    it->reserved = true;
+    it->pcm.resize(parameters.granularity);
+    *object_id = static_cast<OrbisAudio3dObjectId>(std::distance(objects.begin(), it));
+    return ORBIS_OK;
+}
+
+s32 Audio3dPort::UnreserveObject(OrbisAudio3dObjectId object_id) {
+    std::scoped_lock lk{mutex};
+    if (object_id >= objects.size() || !objects[object_id].reserved) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_OBJECT;
+    }
+    objects[object_id] = Object{};
+    return ORBIS_OK;
+}
+
+s32 Audio3dPort::SetObjectAttribute(OrbisAudio3dObjectId object_id,
+                                    const OrbisAudio3dAttribute& attribute) {
+    std::scoped_lock lk{mutex};
+    if (object_id >= objects.size() || !objects[object_id].reserved) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_OBJECT;
+    }
+    auto& object = objects[object_id];
+
+    const auto read_value = [&]<typename T>(T& value) {
+        if (attribute.p_value == nullptr || attribute.value < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, attribute.p_value, sizeof(T));
+        return true;
+    };
+
+    switch (attribute.attribute_id) {
+    case s_sceAudio3dAttributePcm: {
+        OrbisAudio3dPcm pcm;
+        if (!read_value(pcm) || pcm.sample_buffer == nullptr ||
+            pcm.num_samples != parameters.granularity) {
+            return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+        }
+        for (u32 i = 0; i < pcm.num_samples; ++i) {
+            object.pcm[i] = ReadSample(pcm.format, pcm.sample_buffer, i);
+        }
+        object.has_pcm = true;
+        return ORBIS_OK;
+    }
+    case s_sceAudio3dAttributePosition:
+        return read_value(object.position) ? ORBIS_OK : ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    case s_sceAudio3dAttributeGain:
+        return read_value(object.gain) ? ORBIS_OK : ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    case s_sceAudio3dAttributeSpread:
+        return read_value(object.spread) ? ORBIS_OK : ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    case s_sceAudio3dAttributePassthrough:
+        return read_value(object.passthrough) ? ORBIS_OK : ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    case s_sceAudio3dAttributeResetState: {
+        object = Object{};
+        object.reserved = true;
+        object.pcm.resize(parameters.granularity);
+        return ORBIS_OK;
+    }
+    default:
+        LOG_DEBUG(Lib_Audio3d, "Ignoring object attribute {:#x}", attribute.attribute_id);
+        return ORBIS_OK;
+    }
+}
+
+s32 Audio3dPort::WriteBed(u32 num_channels, OrbisAudio3dFormat format, const void* buffer,
+                          u32 num_samples) {
+    if (buffer == nullptr || num_samples != parameters.granularity ||
+        (num_channels != 2 && num_channels != NumBedChannels)) {
+        return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+    }
+    std::scoped_lock lk{mutex};
+    for (u32 i = 0; i < num_samples; ++i) {
+        for (u32 c = 0; c < num_channels; ++c) {
+            bed[i * NumBedChannels + c] += ReadSample(format, buffer, i * num_channels + c);
+        }
+    }
+    return ORBIS_OK;
+}
+
+s32 Audio3dPort::Advance() {
+    {
+        std::scoped_lock lk{mutex};
+        Mix();
+    }
+    // Without a separate push call, every advanced frame is queued for output right away.
+    if (parameters.buffer_mode == OrbisAudio3dBufferMode::AdvanceNoPush) {
+        return Push(OrbisAudio3dBlocking::Sync);
+    }
+    return ORBIS_OK;
+}
+
+void Audio3dPort::Mix() {
+    for (auto& object : objects) {
+        if (!object.reserved || !object.has_pcm) {
+            continue;
+        }
+        BedGains gains{};
+        switch (object.passthrough) {
+        case OrbisAudio3dPassthrough::Left:
+            gains[0] = object.gain;
+            break;
+        case OrbisAudio3dPassthrough::Right:
+            gains[1] = object.gain;
+            break;
+        default:
+            gains = ComputeBedGains(object.position, object.spread, object.gain);
+            break;
+        }
+        PanObject(bed, object.pcm, gains);
+        object.has_pcm = false;
+    }
+    DownmixBed(staging, bed);
+    std::ranges::fill(bed, 0.0f);
+}
+
+s32 Audio3dPort::Push(OrbisAudio3dBlocking blocking) {
+    // Reserve a slot first, so concurrent pushes can never queue more than queue_depth frames.
+    u32 queue_level = queued_frames.load();
+    do {
+        while (queue_level >= parameters.queue_depth) {
+            if (queue_level == ClosedQueueLevel) {
+                return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
+            }
+            if (blocking == OrbisAudio3dBlocking::Async) {
+                return ORBIS_AUDIO3D_ERROR_NOT_READY;
+            }
+            queued_frames.wait(queue_level);
+            queue_level = queued_frames.load();
+        }
+    } while (!queued_frames.compare_exchange_weak(queue_level, queue_level + 1));
+
+    // The output thread releases slots in the order they were queued, so the next one in
+    // round robin order is always free here.
+    std::scoped_lock lk{mutex};
+    std::memcpy(frames.data() + write_slot * staging.size(), staging.data(),
+                staging.size() * sizeof(float));
+    ready_frames.TryEmplace(write_slot);
+    write_slot = (write_slot + 1) % parameters.queue_depth;
+    return ORBIS_OK;
+}
+
+void Audio3dPort::GetQueueLevel(u32* queue_level, u32* queue_available) const {
+    const u32 level = std::min(queued_frames.load(), parameters.queue_depth);
+    if (queue_level) {
+        *queue_level = level;
+    }
+    if (queue_available) {
+        *queue_available = parameters.queue_depth - level;
+    }
+}
+
+void Audio3dPort::Close() {
+    if (closed.exchange(true)) {
+        return;
+    }
+    if (output_thread.joinable()) {
+        output_thread.request_stop();
+        output_thread.join();
+    }
+    queued_frames.store(ClosedQueueLevel);
+    queued_frames.notify_all();
+}
+
+void Audio3dPort::OutputThread(std::stop_token stoken) {
+    Common::SetCurrentThreadName("shadPS4:Audio3dOutput");
+    while (!stoken.stop_requested()) {
+        u32 slot = MaxQueueDepth;
+        ready_frames.PopWait(slot, stoken);
+        if (slot == MaxQueueDepth) {
+            break;
+        }
+        // Blocks until AudioOut has taken the previous buffer, which paces the queue.
+        AudioOut::sceAudioOutOutput(audio_out_handle, frames.data() + slot * staging.size());
+        --queued_frames;
+        queued_frames.notify_one();
+    }
+}
 
-namespace Libraries::Audio3d {} // namespace Libraries::Audio3d
+} // namespace Libraries::Audio3d
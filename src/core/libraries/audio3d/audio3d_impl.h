@@ -3,14 +3,104 @@
 
 #pragma once
 
-#include "audio3d.h"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "common/bounded_threadsafe_queue.h"
+#include "common/polyfill_thread.h"
+#include "core/libraries/audio3d/audio3d.h"
 
 namespace Libraries::Audio3d {
 
-class Audio3d {
+/// Bed channels in AudioOut 8 channel order: FL, FR, FC, LFE, BL, BR, SL, SR.
+constexpr u32 NumBedChannels = 8;
+/// Channels of the AudioOut port the mixed output is delivered to.
+constexpr u32 NumHostChannels = 2;
+/// Upper bound of the open parameter queue depth, the size of the output ring.
+constexpr u32 MaxQueueDepth = 16;
+
+using BedGains = std::array<float, NumBedChannels>;
+
+/// Computes the bed channel gains of a mono object at the given position. Objects are panned
+/// between the two nearest speakers by azimuth with constant power, then blended towards all
+/// speakers by spread (0 for a point source, 2*pi for an object surrounding the listener).
+BedGains ComputeBedGains(const OrbisAudio3dPosition& position, float spread, float gain);
+
+/// Accumulates a mono object into an interleaved bed: bed[i][c] += samples[i] * gains[c].
+void PanObject(std::span<float> bed, std::span<const float> samples, const BedGains& gains);
+
+/// Downmixes an interleaved bed to interleaved stereo. LFE is dropped.
+void DownmixBed(std::span<float> out, std::span<const float> bed);
+
+/// Port opened by sceAudio3dPortOpen. Objects and beds written by the guest are mixed on
+/// Advance, and Push queues the mix for an output thread that feeds a single AudioOut port.
+class Audio3dPort {
 public:
+    explicit Audio3dPort(OrbisUserServiceUserId user_id,
+                         const OrbisAudio3dOpenParameters& parameters);
+    ~Audio3dPort();
+
+    Audio3dPort(const Audio3dPort&) = delete;
+    Audio3dPort& operator=(const Audio3dPort&) = delete;
+
+    [[nodiscard]] bool IsOpen() const {
+        return audio_out_handle > 0;
+    }
+
+    [[nodiscard]] OrbisAudio3dBufferMode BufferMode() const {
+        return parameters.buffer_mode;
+    }
+
+    s32 ReserveObject(OrbisAudio3dObjectId* object_id);
+    s32 UnreserveObject(OrbisAudio3dObjectId object_id);
+    s32 SetObjectAttribute(OrbisAudio3dObjectId object_id, const OrbisAudio3dAttribute& attribute);
+
+    s32 WriteBed(u32 num_channels, OrbisAudio3dFormat format, const void* buffer,
+                 u32 num_samples);
+
+    /// Mixes the objects and beds written since the last call into the staging frame. In
+    /// AdvanceNoPush mode the frame is also queued for output.
+    s32 Advance();
+
+    /// Queues the staging frame for output, waiting for a free slot when blocking.
+    s32 Push(OrbisAudio3dBlocking blocking);
+
+    void GetQueueLevel(u32* queue_level, u32* queue_available) const;
+
+    /// Stops the output thread and fails pushes that are waiting for a free slot.
+    void Close();
+
 private:
-    using OrbisAudio3dPluginId = u32;
+    struct Object {
+        bool reserved{};
+        bool has_pcm{};
+        OrbisAudio3dPassthrough passthrough{OrbisAudio3dPassthrough::None};
+        OrbisAudio3dPosition position{0.0f, 0.0f, 1.0f};
+        float gain{1.0f};
+        float spread{};
+        std::vector<float> pcm;
+    };
+
+    /// Mixes into the staging frame, the port mutex must be held.
+    void Mix();
+
+    void OutputThread(std::stop_token stoken);
+
+    OrbisAudio3dOpenParameters parameters;
+    s32 audio_out_handle{};
+    std::mutex mutex;
+    std::vector<Object> objects;
+    std::vector<float> bed;
+    std::vector<float> staging;
+    std::vector<float> frames;
+    u32 write_slot{};
+    std::atomic<u32> queued_frames{};
+    std::atomic<bool> closed{};
+    Common::SPSCQueue<u32, MaxQueueDepth> ready_frames;
+    std::jthread output_thread;
 };
 
 } // namespace Libraries::Audio3d
@@ -20,10 +20,12 @@
 #include "core/platform.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/amdgpu/pm4_cmds.h"
+#include "video_core/renderer_null/null_rasterizer.h"
 #include "video_core/renderer_vulkan/vk_presenter.h"
 
 extern Frontend::WindowSDL* g_window;
 std::unique_ptr<Vulkan::Presenter> presenter;
+std::unique_ptr<Null::Rasterizer> null_rasterizer;
 std::unique_ptr<AmdGpu::Liverpool> liverpool;
 
 namespace Libraries::GnmDriver {
@@ -2798,9 +2800,15 @@ int PS4_SYSV_ABI Func_F916890425496553() {
 }
 
 void RegisterlibSceGnmDriver(Core::Loader::SymbolsResolver* sym) {
-    LOG_INFO(Lib_GnmDriver, "Initializing presenter");
     liverpool = std::make_unique<AmdGpu::Liverpool>();
-    presenter = std::make_unique<Vulkan::Presenter>(*g_window, liverpool.get());
+    if (Config::nullGpu()) {
+        // Without a presenter, the video out driver discards every frame.
+        LOG_INFO(Lib_GnmDriver, "Initializing null renderer");
+        null_rasterizer = std::make_unique<Null::Rasterizer>(liverpool.get());
+    } else {
+        LOG_INFO(Lib_GnmDriver, "Initializing presenter");
+        presenter = std::make_unique<Vulkan::Presenter>(*g_window, liverpool.get());
+    }
 
     const int result = sceKernelGetCompiledSdkVersion(&sdk_version);
     if (result != ORBIS_OK) {
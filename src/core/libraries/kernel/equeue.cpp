@@ -1,11 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
-#include <thread>
+#include <algorithm>
 
 #include "common/assert.h"
 #include "common/debug.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/libraries/kernel/equeue.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/libs.h"
@@ -128,40 +129,39 @@ bool EqueueInternal::AddSmallTimer(EqueueEvent& ev) {
 }
 
 int EqueueInternal::WaitForSmallTimer(SceKernelEvent* ev, int num, u32 micros) {
-    int count{};
-
     ASSERT(num == 1);
 
-    auto curr_clock = std::chrono::steady_clock::now();
-    const auto wait_end_us = curr_clock + std::chrono::microseconds{micros};
-
-    do {
-        curr_clock = std::chrono::steady_clock::now();
+    const auto wait_end = std::chrono::steady_clock::now() + std::chrono::microseconds{micros};
+    while (true) {
+        std::chrono::steady_clock::time_point timer_end;
         {
             std::scoped_lock lock{m_mutex};
-            if ((curr_clock - small_timer_event.time_added) >
-                std::chrono::microseconds{small_timer_event.event.data}) {
-                ev[count++] = small_timer_event.event;
+            timer_end = small_timer_event.time_added +
+                        std::chrono::microseconds{small_timer_event.event.data};
+            if (std::chrono::steady_clock::now() > timer_end) {
+                ev[0] = small_timer_event.event;
                 small_timer_event.event.data = 0;
-                break;
+                return 1;
             }
         }
-        std::this_thread::yield();
-    } while (curr_clock < wait_end_us);
-
-    return count;
+        if (std::chrono::steady_clock::now() >= wait_end) {
+            return 0;
+        }
+        // The timer may be re-armed while we sleep, so its deadline is checked again.
+        Common::SleepUntil(std::min(timer_end, wait_end));
+    }
 }
 
 extern boost::asio::io_context io_context;
 extern void KernelSignalRequest();
 
-static constexpr auto HrTimerSpinlockThresholdUs = 1200u;
+static constexpr auto HrTimerPreciseThresholdUs = 1200u;
 
 static void SmallTimerCallback(const boost::system::error_code& error, SceKernelEqueue eq,
                                SceKernelEvent kevent) {
     static EqueueEvent event;
     event.event = kevent;
-    event.event.data = HrTimerSpinlockThresholdUs;
+    event.event.data = HrTimerPreciseThresholdUs;
     eq->AddSmallTimer(event);
     eq->TriggerEvent(kevent.ident, SceKernelEvent::Filter::HrTimer, kevent.udata);
 }
@@ -265,16 +265,16 @@ s32 PS4_SYSV_ABI sceKernelAddHRTimerEvent(SceKernelEqueue eq, int id, timespec*
     // HR timers cannot be implemented within the existing event queue architecture due to the
     // slowness of the notification mechanism. For instance, a 100us timer will lose its precision
     // as the trigger time drifts by +50-700%, depending on the host PC and workload. To address
-    // this issue, we use a spinlock for small waits (which can be adjusted using
-    // `HrTimerSpinlockThresholdUs`) and fall back to boost asio timers if the time to tick is
-    // large. Even for large delays, we truncate a small portion to complete the wait
-    // using the spinlock, prioritizing precision.
-    if (total_us < HrTimerSpinlockThresholdUs) {
+    // this issue, the waiter sleeps until small deadlines itself with Common::SleepUntil (the
+    // threshold can be adjusted using `HrTimerPreciseThresholdUs`) and we fall back to boost
+    // asio timers if the time to tick is large. Even for large delays, we truncate a small
+    // portion to complete the wait precisely, prioritizing precision.
+    if (total_us < HrTimerPreciseThresholdUs) {
         return eq->AddSmallTimer(event) ? ORBIS_OK : ORBIS_KERNEL_ERROR_ENOMEM;
     }
 
     event.timer = std::make_unique<boost::asio::steady_timer>(
-        io_context, std::chrono::microseconds(total_us - HrTimerSpinlockThresholdUs));
+        io_context, std::chrono::microseconds(total_us - HrTimerPreciseThresholdUs));
 
     event.timer->async_wait(std::bind(SmallTimerCallback, std::placeholders::_1, eq, event.event));
 
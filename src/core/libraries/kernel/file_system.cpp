@@ -4,6 +4,7 @@
 #include <map>
 #include <ranges>
 
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
@@ -57,6 +58,11 @@ static std::map<std::string, FactoryDevice> available_device = {
 
 namespace Libraries::Kernel {
 
+/// Drops cached metadata of a file that is about to be written through the emulator.
+static void InvalidateStat(const Core::FileSys::File& file) {
+    Common::Singleton<Core::FileSys::MntPoints>::Instance()->InvalidateStat(file.m_host_name);
+}
+
 int PS4_SYSV_ABI sceKernelOpen(const char* raw_path, int flags, u16 mode) {
     LOG_INFO(Kernel_Fs, "path = {} flags = {:#x} mode = {}", raw_path, flags, mode);
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
@@ -104,12 +110,7 @@ int PS4_SYSV_ABI sceKernelOpen(const char* raw_path, int flags, u16 mode) {
             if (create) {
                 return handle; // dir already exists
             } else {
-                mnt->IterateDirectory(file->m_guest_name,
-                                      [&file](const auto& ent_path, const auto ent_is_file) {
-                                          auto& dir_entry = file->dirents.emplace_back();
-                                          dir_entry.name = ent_path.filename().string();
-                                          dir_entry.isFile = ent_is_file;
-                                      });
+                // Entries are enumerated on the first getdents call.
                 file->dirents_index = 0;
             }
         }
@@ -138,6 +139,9 @@ int PS4_SYSV_ABI sceKernelOpen(const char* raw_path, int flags, u16 mode) {
             h->DeleteHandle(handle);
             return ErrnoToSceKernelError(e);
         }
+        if (!read) {
+            mnt->InvalidateStat(file->m_host_name);
+        }
     }
     file->is_opened = true;
     return handle;
@@ -203,6 +207,7 @@ s64 PS4_SYSV_ABI sceKernelWrite(int d, const void* buf, size_t nbytes) {
     if (file->type == Core::FileSys::FileType::Device) {
         return file->device->write(buf, nbytes);
     }
+    InvalidateStat(*file);
     return file->f.WriteRaw<u8>(buf, nbytes);
 }
 
@@ -232,6 +237,7 @@ int PS4_SYSV_ABI sceKernelUnlink(const char* path) {
     if (file != nullptr) {
         file->f.Unlink();
     }
+    mnt->InvalidateStat(host_path);
 
     LOG_INFO(Kernel_Fs, "Unlinked {}", path);
     return ORBIS_OK;
@@ -281,6 +287,7 @@ size_t PS4_SYSV_ABI _writev(int fd, const SceKernelIovec* iov, int iovcn) {
     if (file->type == Core::FileSys::FileType::Device) {
         return file->device->writev(iov, iovcn);
     }
+    InvalidateStat(*file);
     size_t total_written = 0;
     for (int i = 0; i < iovcn; i++) {
         total_written += file->f.WriteRaw<u8>(iov[i].iov_base, iov[i].iov_len);
@@ -422,6 +429,7 @@ int PS4_SYSV_ABI sceKernelRmdir(const char* path) {
 
     std::error_code ec;
     int result = std::filesystem::remove_all(dir_name, ec);
+    mnt->InvalidateStat(dir_name, true);
 
     if (!ec) {
         LOG_INFO(Kernel_Fs, "Removed directory: {}", fmt::UTF(dir_name.u8string()));
@@ -448,12 +456,17 @@ int PS4_SYSV_ABI sceKernelStat(const char* path, OrbisKernelStat* sb) {
     bool ro = false;
     const auto path_name = mnt->GetHostPath(path, &ro);
     std::memset(sb, 0, sizeof(OrbisKernelStat));
-    const bool is_dir = std::filesystem::is_directory(path_name);
-    const bool is_file = std::filesystem::is_regular_file(path_name);
-    if (!is_dir && !is_file) {
-        return ORBIS_KERNEL_ERROR_ENOENT;
+    auto stat = mnt->GetCachedStat(path_name);
+    if (!stat) {
+        const bool is_dir = std::filesystem::is_directory(path_name);
+        const bool is_file = std::filesystem::is_regular_file(path_name);
+        if (!is_dir && !is_file) {
+            return ORBIS_KERNEL_ERROR_ENOENT;
+        }
+        stat = Core::FileSys::StatEntry{is_file,
+                                        is_file ? std::filesystem::file_size(path_name) : 0};
     }
-    if (std::filesystem::is_directory(path_name)) {
+    if (!stat->is_file) {
         sb->st_mode = 0000777u | 0040000u;
         sb->st_size = 0;
         sb->st_blksize = 512;
@@ -461,7 +474,7 @@ int PS4_SYSV_ABI sceKernelStat(const char* path, OrbisKernelStat* sb) {
         // TODO incomplete
     } else {
         sb->st_mode = 0000777u | 0100000u;
-        sb->st_size = static_cast<int64_t>(std::filesystem::file_size(path_name));
+        sb->st_size = static_cast<int64_t>(*stat->size);
         sb->st_blksize = 512;
         sb->st_blocks = (sb->st_size + 511) / 512;
         // TODO incomplete
@@ -625,10 +638,18 @@ int PS4_SYSV_ABI sceKernelFtruncate(int fd, s64 length) {
         return ORBIS_KERNEL_ERROR_EACCES;
     }
 
+    InvalidateStat(*file);
     file->f.SetSize(length);
     return ORBIS_OK;
 }
 
+/// File numbers are derived from the host path, so they stay the same across enumerations.
+static u32 GetFileno(const std::filesystem::path& host_path) {
+    const u64 hash = std::hash<std::filesystem::path>{}(host_path);
+    const u32 fileno = static_cast<u32>(hash ^ (hash >> 32));
+    return fileno != 0 ? fileno : 1; // 0 marks an unused entry
+}
+
 static int GetDents(int fd, char* buf, int nbytes, s64* basep) {
     if (fd < 3) {
         return ORBIS_KERNEL_ERROR_EBADF;
@@ -646,6 +667,19 @@ static int GetDents(int fd, char* buf, int nbytes, s64* basep) {
         return file->device->getdents(buf, nbytes, basep);
     }
 
+    std::scoped_lock lk{file->m_mutex};
+    if (file->type == Core::FileSys::FileType::Directory && !file->dirents_loaded) {
+        auto* mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
+        mnt->IterateDirectory(file->m_guest_name,
+                              [&file](const auto& ent_path, const auto ent_is_file) {
+                                  auto& dir_entry = file->dirents.emplace_back();
+                                  dir_entry.name = ent_path.filename().string();
+                                  dir_entry.isFile = ent_is_file;
+                                  dir_entry.fileno = GetFileno(ent_path);
+                              });
+        file->dirents_loaded = true;
+    }
+
     if (file->dirents_index == file->dirents.size()) {
         return ORBIS_OK;
     }
@@ -653,23 +687,37 @@ static int GetDents(int fd, char* buf, int nbytes, s64* basep) {
         file->dirents_index > file->dirents.size()) {
         return ORBIS_KERNEL_ERROR_EINVAL;
     }
-    const auto& entry = file->dirents.at(file->dirents_index++);
-    auto str = entry.name;
-    static int fileno = 1000; // random
-    OrbisKernelDirent* sce_ent = (OrbisKernelDirent*)buf;
-    sce_ent->d_fileno = fileno++; // TODO this should be unique but atm it changes maybe switch to a
-    // hash or something?
-    sce_ent->d_reclen = sizeof(OrbisKernelDirent);
-    sce_ent->d_type = (entry.isFile ? 8 : 4);
-    sce_ent->d_namlen = str.size();
-    strncpy(sce_ent->d_name, str.c_str(), ORBIS_MAX_PATH);
-    sce_ent->d_name[ORBIS_MAX_PATH] = '\0';
+
+    // Fill as many entries as fit, with records padded to 4 bytes like the BSD kernel does.
+    constexpr size_t NameOffset = offsetof(OrbisKernelDirent, d_name);
+    int written = 0;
+    while (file->dirents_index < file->dirents.size()) {
+        const auto& entry = file->dirents[file->dirents_index];
+        const size_t namlen = std::min<size_t>(entry.name.size(), ORBIS_MAX_PATH);
+        const size_t reclen = Common::AlignUp(NameOffset + namlen + 1, 4);
+        if (written + reclen > static_cast<size_t>(nbytes)) {
+            break;
+        }
+        auto* sce_ent = reinterpret_cast<OrbisKernelDirent*>(buf + written);
+        sce_ent->d_fileno = entry.fileno;
+        sce_ent->d_reclen = static_cast<u16>(reclen);
+        sce_ent->d_type = (entry.isFile ? 8 : 4);
+        sce_ent->d_namlen = static_cast<u8>(namlen);
+        std::memcpy(sce_ent->d_name, entry.name.data(), namlen);
+        std::memset(sce_ent->d_name + namlen, 0, reclen - NameOffset - namlen);
+        written += static_cast<int>(reclen);
+        ++file->dirents_index;
+    }
+    if (written == 0) {
+        // Entries remain but the buffer cannot hold the next one.
+        return ORBIS_KERNEL_ERROR_EINVAL;
+    }
 
     if (basep != nullptr) {
         *basep = file->dirents_index;
     }
 
-    return sizeof(OrbisKernelDirent);
+    return written;
 }
 
 int PS4_SYSV_ABI sceKernelGetdents(int fd, char* buf, int nbytes) {
@@ -707,6 +755,7 @@ s64 PS4_SYSV_ABI sceKernelPwrite(int d, void* buf, size_t nbytes, s64 offset) {
         LOG_CRITICAL(Kernel_Fs, "sceKernelPwrite: failed to seek");
         return ORBIS_KERNEL_ERROR_EINVAL;
     }
+    InvalidateStat(*file);
     return file->f.WriteRaw<u8>(buf, nbytes);
 }
 
@@ -736,6 +785,7 @@ s32 PS4_SYSV_ABI sceKernelRename(const char* from, const char* to) {
         return ORBIS_KERNEL_ERROR_ENOTEMPTY;
     }
     std::filesystem::copy(src_path, dst_path, std::filesystem::copy_options::overwrite_existing);
+    mnt->InvalidateStat(dst_path, true);
     return ORBIS_OK;
 }
 
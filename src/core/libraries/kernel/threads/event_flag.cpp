@@ -2,12 +2,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <condition_variable>
+#include <list>
 #include <mutex>
-#include <thread>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/libraries/kernel/orbis_error.h"
+#include "core/libraries/kernel/sync/semaphore.h"
+#include "core/libraries/kernel/threads/pthread.h"
 #include "core/libraries/libs.h"
 
 namespace Libraries::Kernel {
@@ -33,68 +35,87 @@ public:
                       uint64_t bits)
         : m_name(name), m_thread_mode(thread_mode), m_queue_mode(queue_mode), m_bits(bits) {};
 
+    /// Wakes all waiters and returns once none of them can touch the event flag anymore.
+    void Delete() {
+        std::unique_lock lock{m_mutex};
+        for (auto* waiter : m_wait_list) {
+            waiter->was_deleted = true;
+            waiter->sem.release();
+        }
+        m_wait_list.clear();
+        // Timed waiters lock the event flag again after their wait, let them leave first.
+        m_drained_cv.wait(lock, [this] { return m_timed_waiters == 0; });
+    }
+
     int Wait(u64 bits, WaitMode wait_mode, ClearMode clear_mode, u64* result, u32* ptr_micros) {
         std::unique_lock lock{m_mutex};
 
-        uint32_t micros = 0;
-        bool infinitely = true;
-        if (ptr_micros != nullptr) {
-            micros = *ptr_micros;
-            infinitely = false;
+        if (m_thread_mode == ThreadMode::Single && !m_wait_list.empty()) {
+            return ORBIS_KERNEL_ERROR_EPERM;
         }
 
-        if (m_thread_mode == ThreadMode::Single && m_waiting_threads > 0) {
-            return ORBIS_KERNEL_ERROR_EPERM;
+        if (IsSatisfied(bits, wait_mode)) {
+            if (result != nullptr) {
+                *result = m_bits;
+            }
+            ApplyClear(bits, clear_mode);
+            return ORBIS_OK;
         }
 
-        auto const start = std::chrono::system_clock::now();
-        m_waiting_threads++;
-        auto waitFunc = [this, wait_mode, bits] {
-            return (m_status == Status::Canceled || m_status == Status::Deleted ||
-                    (wait_mode == WaitMode::And && (m_bits & bits) == bits) ||
-                    (wait_mode == WaitMode::Or && (m_bits & bits) != 0));
-        };
+        if (ptr_micros != nullptr && *ptr_micros == 0) {
+            if (result != nullptr) {
+                *result = m_bits;
+            }
+            return ORBIS_KERNEL_ERROR_ETIMEDOUT;
+        }
 
-        if (infinitely) {
-            m_cond_var.wait(lock, waitFunc);
+        // Create waiting thread object and add it into the list of waiters.
+        WaitingThread waiter{bits, wait_mode, clear_mode, m_queue_mode == QueueMode::Fifo};
+        const auto it = AddWaiter(&waiter);
+        if (ptr_micros != nullptr) {
+            ++m_timed_waiters;
+        }
+
+        // Perform the wait. Whoever wakes us up fills in the result under the lock before
+        // releasing the semaphore, so an untimed waiter does not touch the event flag again as
+        // it might have been deleted already. Timed waiters must check whether they timed out,
+        // and deletion waits for them to do so.
+        lock.unlock();
+        if (ptr_micros == nullptr) {
+            waiter.sem.acquire();
         } else {
-            if (!m_cond_var.wait_for(lock, std::chrono::microseconds(micros), waitFunc)) {
+            const auto start = std::chrono::steady_clock::now();
+            const bool acquired =
+                waiter.sem.try_acquire_for(std::chrono::microseconds(*ptr_micros));
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count();
+            lock.lock();
+            if (--m_timed_waiters == 0) {
+                // Deletion may be waiting for us, no matter who woke us up.
+                m_drained_cv.notify_all();
+            }
+            if (!acquired && !waiter.WasWoken()) {
+                m_wait_list.erase(it);
                 if (result != nullptr) {
                     *result = m_bits;
                 }
                 *ptr_micros = 0;
-                --m_waiting_threads;
                 return ORBIS_KERNEL_ERROR_ETIMEDOUT;
             }
-        }
-        --m_waiting_threads;
-        if (result != nullptr) {
-            *result = m_bits;
+            lock.unlock();
+            *ptr_micros = elapsed >= *ptr_micros ? 0 : *ptr_micros - static_cast<u32>(elapsed);
         }
 
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
-                           std::chrono::system_clock::now() - start)
-                           .count();
         if (result != nullptr) {
-            *result = m_bits;
-        }
-
-        if (ptr_micros != nullptr) {
-            *ptr_micros = (elapsed >= micros ? 0 : micros - elapsed);
+            *result = waiter.result_bits;
         }
-
-        if (m_status == Status::Canceled) {
-            return ORBIS_KERNEL_ERROR_ECANCELED;
-        } else if (m_status == Status::Deleted) {
+        if (waiter.was_deleted) {
             return ORBIS_KERNEL_ERROR_EACCES;
         }
-
-        if (clear_mode == ClearMode::All) {
-            m_bits = 0;
-        } else if (clear_mode == ClearMode::Bits) {
-            m_bits &= ~bits;
+        if (waiter.was_canceled) {
+            return ORBIS_KERNEL_ERROR_ECANCELED;
         }
-
         return ORBIS_OK;
     }
 
@@ -109,63 +130,104 @@ public:
     }
 
     void Set(u64 bits) {
-        std::unique_lock lock{m_mutex};
+        std::scoped_lock lock{m_mutex};
+        m_bits |= bits;
 
-        while (m_status != Status::Set) {
-            m_mutex.unlock();
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-            m_mutex.lock();
+        // Wake up only the waiters whose pattern is now satisfied, in queue order. Each one
+        // applies its clear mode before the next is checked, like the bits were consumed.
+        for (auto it = m_wait_list.begin(); it != m_wait_list.end();) {
+            auto* waiter = *it;
+            if (!IsSatisfied(waiter->bits, waiter->wait_mode)) {
+                ++it;
+                continue;
+            }
+            it = m_wait_list.erase(it);
+            waiter->result_bits = m_bits;
+            ApplyClear(waiter->bits, waiter->clear_mode);
+            waiter->was_signaled = true;
+            waiter->sem.release();
         }
-
-        m_bits |= bits;
-        m_cond_var.notify_all();
     }
 
     void Clear(u64 bits) {
-        std::unique_lock lock{m_mutex};
-        while (m_status != Status::Set) {
-            m_mutex.unlock();
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-            m_mutex.lock();
-        }
-
+        std::scoped_lock lock{m_mutex};
         m_bits &= bits;
     }
 
     void Cancel(u64 setPattern, int* numWaitThreads) {
-        std::unique_lock lock{m_mutex};
-
-        while (m_status != Status::Set) {
-            m_mutex.unlock();
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-            m_mutex.lock();
+        std::scoped_lock lock{m_mutex};
+        if (numWaitThreads) {
+            *numWaitThreads = static_cast<int>(m_wait_list.size());
+        }
+        m_bits = setPattern;
+        for (auto* waiter : m_wait_list) {
+            waiter->result_bits = m_bits;
+            waiter->was_canceled = true;
+            waiter->sem.release();
         }
+        m_wait_list.clear();
+    }
 
-        if (numWaitThreads) {
-            *numWaitThreads = m_waiting_threads;
+private:
+    struct WaitingThread {
+        BinarySemaphore sem;
+        u32 priority;
+        u64 bits;
+        WaitMode wait_mode;
+        ClearMode clear_mode;
+        u64 result_bits{};
+        bool was_signaled{};
+        bool was_deleted{};
+        bool was_canceled{};
+
+        explicit WaitingThread(u64 bits, WaitMode wait_mode, ClearMode clear_mode, bool is_fifo)
+            : sem{0}, priority{0}, bits{bits}, wait_mode{wait_mode}, clear_mode{clear_mode} {
+            // Retrieve calling thread priority for sorting into waiting threads list.
+            if (!is_fifo) {
+                priority = g_curthread->attr.prio;
+            }
         }
 
-        m_status = Status::Canceled;
-        m_bits = setPattern;
+        bool WasWoken() const {
+            return was_signaled || was_deleted || was_canceled;
+        }
+    };
 
-        m_cond_var.notify_all();
+    using WaitList = std::list<WaitingThread*>;
 
-        while (m_waiting_threads > 0) {
-            m_mutex.unlock();
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-            m_mutex.lock();
+    WaitList::iterator AddWaiter(WaitingThread* waiter) {
+        // Insert at the end of the list for FIFO order.
+        if (m_queue_mode == QueueMode::Fifo) {
+            m_wait_list.push_back(waiter);
+            return --m_wait_list.end();
         }
+        // Find the first with priority less then us and insert right before it.
+        auto it = m_wait_list.begin();
+        while (it != m_wait_list.end() && (*it)->priority > waiter->priority) {
+            ++it;
+        }
+        return m_wait_list.insert(it, waiter);
+    }
 
-        m_status = Status::Set;
+    bool IsSatisfied(u64 bits, WaitMode wait_mode) const {
+        if (wait_mode == WaitMode::And) {
+            return (m_bits & bits) == bits;
+        }
+        return (m_bits & bits) != 0;
     }
 
-private:
-    enum class Status { Set, Canceled, Deleted };
+    void ApplyClear(u64 bits, ClearMode clear_mode) {
+        if (clear_mode == ClearMode::All) {
+            m_bits = 0;
+        } else if (clear_mode == ClearMode::Bits) {
+            m_bits &= ~bits;
+        }
+    }
 
     std::mutex m_mutex;
-    std::condition_variable m_cond_var;
-    Status m_status = Status::Set;
-    int m_waiting_threads = 0;
+    std::condition_variable m_drained_cv;
+    WaitList m_wait_list;
+    u32 m_timed_waiters = 0;
     std::string m_name;
     ThreadMode m_thread_mode = ThreadMode::Single;
     QueueMode m_queue_mode = QueueMode::Fifo;
@@ -224,10 +286,6 @@ int PS4_SYSV_ABI sceKernelCreateEventFlag(OrbisKernelEventFlag* ef, const char*
         UNREACHABLE();
     }
 
-    if (queue_mode == EventFlagInternal::QueueMode::ThreadPrio) {
-        LOG_ERROR(Kernel_Event, "ThreadPriority attr is not supported!");
-    }
-
     *ef = new EventFlagInternal(std::string(pName), thread_mode, queue_mode, initPattern);
     return ORBIS_OK;
 }
@@ -237,6 +295,7 @@ int PS4_SYSV_ABI sceKernelDeleteEventFlag(OrbisKernelEventFlag ef) {
         return ORBIS_KERNEL_ERROR_ESRCH;
     }
 
+    ef->Delete();
     delete ef;
     return ORBIS_OK;
 }
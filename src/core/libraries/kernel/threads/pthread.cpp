@@ -203,6 +203,7 @@ static void RunThread(void* arg) {
     Pthread* curthread = (Pthread*)arg;
     g_curthread = curthread;
     Common::SetCurrentThreadName(curthread->name.c_str());
+    Common::ReduceCurrentThreadTimerSlack();
     DebugState.AddCurrentThreadToGuestList();
 
     /* Run the current thread's start routine with argument: */
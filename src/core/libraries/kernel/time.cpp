@@ -1,11 +1,15 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <thread>
 
 #include "common/assert.h"
 #include "common/native_clock.h"
+#include "common/thread.h"
+#include "core/libraries/kernel/kernel.h"
 #include "core/libraries/kernel/orbis_error.h"
+#include "core/libraries/kernel/posix_error.h"
 #include "core/libraries/kernel/time.h"
 #include "core/libraries/libs.h"
 
@@ -52,6 +56,10 @@ u64 PS4_SYSV_ABI sceKernelReadTsc() {
 
 int PS4_SYSV_ABI sceKernelUsleep(u32 microseconds) {
 #ifdef _WIN64
+    if (microseconds == 0) {
+        std::this_thread::yield();
+        return 0;
+    }
     const auto start_time = std::chrono::high_resolution_clock::now();
     auto total_wait_time = std::chrono::microseconds(microseconds);
 
@@ -70,17 +78,8 @@ int PS4_SYSV_ABI sceKernelUsleep(u32 microseconds) {
 
     return 0;
 #else
-    timespec start;
-    timespec remain;
-    start.tv_sec = microseconds / 1000000;
-    start.tv_nsec = (microseconds % 1000000) * 1000;
-    timespec* requested = &start;
-    int ret = 0;
-    do {
-        ret = nanosleep(requested, &remain);
-        requested = &remain;
-    } while (ret != 0);
-    return ret;
+    Common::SleepUntil(std::chrono::steady_clock::now() + std::chrono::microseconds{microseconds});
+    return 0;
 #endif
 }
 
@@ -134,9 +133,30 @@ int PS4_SYSV_ABI posix_clock_gettime(s32 clock_id, OrbisKernelTimespec* time) {
 }
 
 int PS4_SYSV_ABI posix_nanosleep(const OrbisKernelTimespec* rqtp, OrbisKernelTimespec* rmtp) {
-    const auto* request = reinterpret_cast<const timespec*>(rqtp);
-    auto* remain = reinterpret_cast<timespec*>(rmtp);
-    return nanosleep(request, remain);
+    if (!rqtp) {
+        *__Error() = POSIX_EFAULT;
+        return -1;
+    }
+    if (rqtp->tv_sec < 0 || rqtp->tv_nsec < 0 || rqtp->tv_nsec >= 1'000'000'000) {
+        *__Error() = POSIX_EINVAL;
+        return -1;
+    }
+    // Sleep until an absolute deadline, so short guest sleeps do not overshoot by the host
+    // timer slack.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{rqtp->tv_sec} +
+                          std::chrono::nanoseconds{rqtp->tv_nsec};
+    if (Common::SleepUntil(deadline, true)) {
+        return 0;
+    }
+    if (rmtp) {
+        const auto remain = std::max(deadline - std::chrono::steady_clock::now(),
+                                     std::chrono::steady_clock::duration::zero());
+        const auto remain_sec = std::chrono::duration_cast<std::chrono::seconds>(remain);
+        rmtp->tv_sec = remain_sec.count();
+        rmtp->tv_nsec = std::chrono::nanoseconds{remain - remain_sec}.count();
+    }
+    *__Error() = POSIX_EINTR;
+    return -1;
 }
 
 int PS4_SYSV_ABI sceKernelNanosleep(const OrbisKernelTimespec* rqtp, OrbisKernelTimespec* rmtp) {
@@ -148,7 +168,10 @@ int PS4_SYSV_ABI sceKernelNanosleep(const OrbisKernelTimespec* rqtp, OrbisKernel
         return ORBIS_KERNEL_ERROR_EINVAL;
     }
 
-    return posix_nanosleep(rqtp, rmtp);
+    if (posix_nanosleep(rqtp, rmtp) < 0) {
+        return ErrnoToSceKernelError(*__Error());
+    }
+    return ORBIS_OK;
 }
 
 int PS4_SYSV_ABI sceKernelGettimeofday(OrbisKernelTimeval* tp) {
@@ -13,7 +13,9 @@
 #include "common/logging/log.h"
 #include "common/logging/log_entry.h"
 #include "common/polyfill_thread.h"
+#include "common/singleton.h"
 #include "common/thread.h"
+#include "core/file_sys/fs.h"
 
 constexpr std::string_view sce_sys = "sce_sys";               // system folder inside save
 constexpr std::string_view backup_dir = "sce_backup";         // backup folder
@@ -24,6 +26,8 @@ namespace fs = std::filesystem;
 
 namespace Libraries::SaveData::Backup {
 
+static Core::FileSys::MntPoints* g_mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
+
 static std::jthread g_backup_thread;
 static std::counting_semaphore g_backup_thread_semaphore{0};
 
@@ -76,6 +80,7 @@ static void backup(const std::filesystem::path& dir_name) {
     if (has_existing_backup) {
         fs::remove_all(backup_dir_old);
     }
+    g_mnt->InvalidateStat(dir_name, true);
 }
 
 static void BackupThreadBody() {
@@ -213,6 +218,7 @@ bool Restore(const std::filesystem::path& save_path) {
         const auto filename = entry.path().filename();
         fs::copy(entry.path(), save_path / filename, fs::copy_options::recursive);
     }
+    g_mnt->InvalidateStat(save_path, true);
 
     return true;
 }
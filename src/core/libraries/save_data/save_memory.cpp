@@ -63,6 +63,7 @@ void PersistMemory(u32 slot_id, bool lock) {
             if (f.IsOpen()) {
                 f.WriteRaw<u8>(data.memory_cache.data(), data.memory_cache.size());
                 f.Close();
+                g_mnt->InvalidateStat(memoryPath);
                 return;
             }
             const auto err = std::error_code{r, std::iostream_category()};
@@ -150,6 +151,7 @@ void SetIcon(u32 slot_id, void* buf, size_t buf_size) {
         file.WriteRaw<u8>(buf, buf_size);
         file.Close();
     }
+    g_mnt->InvalidateStat(icon_path);
 }
 
 bool IsSaveMemoryInitialized(u32 slot_id) {
@@ -184,6 +186,7 @@ void SaveSFO(u32 slot_id) {
     const auto sfo_path = SaveInstance::GetParamSFOPath(data.folder_path);
     fs::create_directories(sfo_path.parent_path());
     const bool ok = data.sfo.Encode(sfo_path);
+    g_mnt->InvalidateStat(sfo_path);
     if (!ok) {
         LOG_ERROR(Lib_SaveData, "Failed to encode param.sfo");
         throw std::filesystem::filesystem_error("Failed to write param.sfo", sfo_path,
@@ -14,6 +14,7 @@
 #include "common/enum.h"
 #include "common/logging/log.h"
 #include "common/path_util.h"
+#include "common/singleton.h"
 #include "common/string_util.h"
 #include "core/file_format/psf.h"
 #include "core/file_sys/fs.h"
@@ -333,6 +334,7 @@ static bool g_initialized = false;
 static std::string g_game_serial;
 static u32 g_fw_ver;
 static std::array<std::optional<SaveInstance>, 16> g_mount_slots;
+static Core::FileSys::MntPoints* g_mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
 
 static void initialize() {
     g_initialized = true;
@@ -759,6 +761,7 @@ Error PS4_SYSV_ABI sceSaveDataDelete(const OrbisSaveDataDelete* del) {
     try {
         if (fs::exists(save_path)) {
             fs::remove_all(save_path);
+            g_mnt->InvalidateStat(save_path, true);
         }
     } catch (const fs::filesystem_error& e) {
         LOG_ERROR(Lib_SaveData, "Failed to delete save data: {}", e.what());
@@ -1408,6 +1411,7 @@ Error PS4_SYSV_ABI sceSaveDataSaveIcon(const OrbisSaveDataMountPoint* mountPoint
     try {
         const Common::FS::IOFile file(path, Common::FS::FileAccessMode::Write);
         file.WriteRaw<u8>(icon->buf, std::min(icon->bufSize, icon->dataSize));
+        g_mnt->InvalidateStat(path);
     } catch (const fs::filesystem_error& e) {
         LOG_ERROR(Lib_SaveData, "Failed to load icon: {}", e.what());
         return Error::INTERNAL;
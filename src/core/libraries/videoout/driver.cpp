@@ -133,7 +133,9 @@ int VideoOutDriver::RegisterBuffers(VideoOutPort* port, s32 startIndex, void* co
             .address_right = 0,
         };
 
-        presenter->RegisterVideoOutSurface(group, address);
+        if (presenter) {
+            presenter->RegisterVideoOutSurface(group, address);
+        }
         LOG_INFO(Lib_VideoOut, "buffers[{}] = {:#x}", i + startIndex, address);
     }
 
@@ -161,7 +163,7 @@ int VideoOutDriver::UnregisterBuffers(VideoOutPort* port, s32 attributeIndex) {
 
 void VideoOutDriver::Flip(const Request& req) {
     // Whatever the game is rendering show splash if it is active
-    if (!presenter->ShowSplash(req.frame)) {
+    if (presenter && !presenter->ShowSplash(req.frame)) {
         // Present the frame.
         presenter->Present(req.frame);
     }
@@ -197,11 +199,13 @@ void VideoOutDriver::Flip(const Request& req) {
     if (req.index != -1) {
         port->buffer_labels[req.index] = 0;
         port->SignalVoLabel();
+        liverpool->NotifyMemoryWrite(reinterpret_cast<VAddr>(&port->buffer_labels[req.index]),
+                                     sizeof(u64));
     }
 }
 
 void VideoOutDriver::DrawBlankFrame() {
-    if (presenter->ShowSplash(nullptr)) {
+    if (!presenter || presenter->ShowSplash(nullptr)) {
         return;
     }
     const auto empty_frame = presenter->PrepareBlankFrame(false);
@@ -209,6 +213,9 @@ void VideoOutDriver::DrawBlankFrame() {
 }
 
 void VideoOutDriver::DrawLastFrame() {
+    if (!presenter) {
+        return;
+    }
     const auto frame = presenter->PrepareLastFrame();
     if (frame != nullptr) {
         presenter->Present(frame, true);
@@ -231,7 +238,7 @@ bool VideoOutDriver::SubmitFlip(VideoOutPort* port, s32 index, s64 flip_arg,
         port->flip_status.submit_tsc = Libraries::Kernel::sceKernelReadTsc();
     }
 
-    if (!is_eop) {
+    if (!is_eop && presenter) {
         // Before processing the flip we need to ask GPU thread to flush command list as at this
         // point VO surface is ready to be presented, and we will need have an actual state of
         // Vulkan image at the time of frame presentation.
@@ -248,10 +255,11 @@ bool VideoOutDriver::SubmitFlip(VideoOutPort* port, s32 index, s64 flip_arg,
 
 void VideoOutDriver::SubmitFlipInternal(VideoOutPort* port, s32 index, s64 flip_arg,
                                         bool is_eop /*= false*/) {
-    Vulkan::Frame* frame;
-    if (index == -1) {
+    // Without a presenter the frame is discarded, only the flip itself is processed.
+    Vulkan::Frame* frame{};
+    if (presenter && index == -1) {
         frame = presenter->PrepareBlankFrame(is_eop);
-    } else {
+    } else if (presenter) {
         const auto& buffer = port->buffer_slots[index];
         const auto& group = port->groups[buffer.group_index];
         frame = presenter->PrepareFrame(group, buffer.address_left, is_eop);
@@ -98,7 +98,7 @@ private:
         bool eop;
 
         operator bool() const noexcept {
-            return frame != nullptr;
+            return port != nullptr;
         }
     };
 
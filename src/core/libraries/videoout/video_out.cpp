@@ -321,7 +321,7 @@ s32 sceVideoOutSubmitEopFlip(s32 handle, u32 buf_id, u32 mode, u32 arg, void** u
 s32 PS4_SYSV_ABI sceVideoOutGetDeviceCapabilityInfo(
     s32 handle, SceVideoOutDeviceCapabilityInfo* pDeviceCapabilityInfo) {
     pDeviceCapabilityInfo->capability = 0;
-    if (presenter->IsHDRSupported()) {
+    if (presenter && presenter->IsHDRSupported()) {
         auto& game_info = Common::ElfInfo::Instance();
         if (game_info.GetPSFAttributes().support_hdr) {
             pDeviceCapabilityInfo->capability |= ORBIS_VIDEO_OUT_DEVICE_CAPABILITY_BT2020_PQ;
@@ -360,7 +360,9 @@ s32 PS4_SYSV_ABI sceVideoOutAdjustColor(s32 handle, const SceVideoOutColorSettin
         return ORBIS_VIDEO_OUT_ERROR_INVALID_HANDLE;
     }
 
-    presenter->GetGammaRef() = settings->gamma;
+    if (presenter) {
+        presenter->GetGammaRef() = settings->gamma;
+    }
     return ORBIS_OK;
 }
 
@@ -397,7 +399,9 @@ s32 PS4_SYSV_ABI sceVideoOutConfigureOutputMode_(s32 handle, u32 reserved, const
         if (mode->colorimetry == OrbisVideoOutColorimetry::Bt2020PQ &&
             game_info.GetPSFAttributes().support_hdr) {
             port->is_mode_changing = true;
-            presenter->SetHDR(true);
+            if (presenter) {
+                presenter->SetHDR(true);
+            }
             port->is_mode_changing = false;
         } else {
             return ORBIS_VIDEO_OUT_ERROR_INVALID_VALUE;
@@ -103,6 +103,7 @@ void Linker::Execute(const std::vector<std::string> args) {
 
     main_thread.Run([this, module, args](std::stop_token) {
         Common::SetCurrentThreadName("GAME_MainThread");
+        Common::ReduceCurrentThreadTimerSlack();
         LoadSharedLibraries();
 
         // Start main module.
@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cstring>
 #include <fmt/core.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -180,39 +182,51 @@ Elf::~Elf() = default;
 
 void Elf::Open(const std::filesystem::path& file_name) {
     m_f.Open(file_name, FileAccessMode::Read);
-    if (!m_f.ReadObject(m_self)) {
+    m_data = m_f.MapReadOnlyView();
+    if (m_data.empty() && m_f.IsOpen()) {
+        // Mapping is not available, fall back to reading the whole image once.
+        m_buffer.resize(m_f.GetSize());
+        m_f.Read(m_buffer);
+        m_data = m_buffer;
+    }
+
+    // Headers are parsed straight out of the file image, no seeking involved.
+    const auto read_object = [this]<typename T>(T& out, u64 offset) {
+        if (offset + sizeof(T) > m_data.size()) {
+            return false;
+        }
+        std::memcpy(&out, m_data.data() + offset, sizeof(T));
+        return true;
+    };
+    const auto read_table = [this]<typename T>(std::vector<T>& out, u64 offset, u16 num) {
+        if (!num) {
+            return;
+        }
+        if (offset + num * sizeof(T) > m_data.size()) {
+            LOG_CRITICAL(Loader, "Header table at {:#x} is out of file bounds", offset);
+            return;
+        }
+        out.resize(num);
+        std::memcpy(out.data(), m_data.data() + offset, num * sizeof(T));
+    };
+
+    if (!read_object(m_self, 0)) {
         LOG_ERROR(Loader, "Unable to read self header!");
         return;
     }
 
-    if (is_self = IsSelfFile(); !is_self) {
-        m_f.Seek(0, SeekOrigin::SetOrigin);
-    } else {
-        m_self_segments.resize(m_self.segment_count);
-        m_f.Read(m_self_segments);
+    u64 elf_header_pos = 0;
+    if (is_self = IsSelfFile(); is_self) {
+        read_table(m_self_segments, sizeof(self_header), m_self.segment_count);
+        elf_header_pos = sizeof(self_header) + m_self_segments.size() * sizeof(self_segment_header);
     }
 
-    const u64 elf_header_pos = m_f.Tell();
-    m_f.Read(m_elf_header);
-    if (!IsElfFile()) {
+    if (!read_object(m_elf_header, elf_header_pos) || !IsElfFile()) {
         return;
     }
 
-    const auto load_headers = [this]<typename T>(std::vector<T>& out, u64 offset, u16 num) {
-        if (!num) {
-            return;
-        }
-
-        out.resize(num);
-        if (!m_f.Seek(offset, SeekOrigin::SetOrigin)) {
-            LOG_CRITICAL(Loader, "Failed to seek to header tables");
-            return;
-        }
-        m_f.Read(out);
-    };
-
-    load_headers(m_elf_phdr, elf_header_pos + m_elf_header.e_phoff, m_elf_header.e_phnum);
-    load_headers(m_elf_shdr, elf_header_pos + m_elf_header.e_shoff, m_elf_header.e_shnum);
+    read_table(m_elf_phdr, elf_header_pos + m_elf_header.e_phoff, m_elf_header.e_phnum);
+    read_table(m_elf_shdr, elf_header_pos + m_elf_header.e_shoff, m_elf_header.e_shnum);
 
     if (is_self) {
         u64 header_size = 0;
@@ -225,9 +239,24 @@ void Elf::Open(const std::filesystem::path& file_name) {
         header_size &= ~15; // Align
 
         if (m_elf_header.e_ehsize - header_size >= sizeof(elf_program_id_header)) {
-            m_f.Seek(header_size, SeekOrigin::SetOrigin);
-            m_f.ReadObject(m_self_id_header);
+            read_object(m_self_id_header, header_size);
         }
+
+        // Index blocked SELF segments by the file range of the program header they carry.
+        m_segment_map.reserve(m_self_segments.size());
+        for (const auto& seg : m_self_segments) {
+            if (!seg.IsBlocked()) {
+                continue;
+            }
+            const auto phdr_id = seg.GetId();
+            if (phdr_id >= m_elf_phdr.size()) {
+                LOG_ERROR(Loader, "SELF segment references invalid program header {}", phdr_id);
+                continue;
+            }
+            const auto& phdr = m_elf_phdr[phdr_id];
+            m_segment_map.push_back({phdr.p_offset, phdr.p_offset + phdr.p_filesz, seg.file_offset});
+        }
+        std::ranges::stable_sort(m_segment_map, {}, &SegmentMapping::elf_start);
     }
 }
 
@@ -466,32 +495,28 @@ std::string Elf::ElfPHeaderStr(u16 no) {
 }
 
 void Elf::LoadSegment(u64 virtual_addr, u64 file_offset, u64 size) {
-    if (!is_self) {
-        // It's elf file
-        if (!m_f.Seek(file_offset, SeekOrigin::SetOrigin)) {
-            LOG_CRITICAL(Loader, "Failed to seek to ELF header");
+    const auto copy_out = [&](u64 image_offset) {
+        if (image_offset + size > m_data.size()) {
+            LOG_CRITICAL(Loader, "Segment at {:#x} with size {:#x} is out of file bounds",
+                         image_offset, size);
             return;
         }
-        m_f.ReadRaw<u8>(reinterpret_cast<u8*>(virtual_addr), size);
+        std::memcpy(reinterpret_cast<void*>(virtual_addr), m_data.data() + image_offset, size);
+    };
+
+    if (!is_self) {
+        // It's elf file
+        copy_out(file_offset);
         return;
     }
 
-    for (uint16_t i = 0; i < m_self.segment_count; i++) {
-        const auto& seg = m_self_segments[i];
-
-        if (seg.IsBlocked()) {
-            auto phdr_id = seg.GetId();
-            const auto& phdr = m_elf_phdr[phdr_id];
-
-            if (file_offset >= phdr.p_offset && file_offset < phdr.p_offset + phdr.p_filesz) {
-                auto offset = file_offset - phdr.p_offset;
-                if (!m_f.Seek(offset + seg.file_offset, SeekOrigin::SetOrigin)) {
-                    LOG_CRITICAL(Loader, "Failed to seek to segment");
-                    return;
-                }
-                m_f.ReadRaw<u8>(reinterpret_cast<u8*>(virtual_addr), size);
-                return;
-            }
+    // Walk back from the last segment starting at or before the requested offset.
+    auto it = std::ranges::upper_bound(m_segment_map, file_offset, {}, &SegmentMapping::elf_start);
+    while (it != m_segment_map.begin()) {
+        --it;
+        if (file_offset < it->elf_end) {
+            copy_out(file_offset - it->elf_start + it->self_offset);
+            return;
         }
     }
     UNREACHABLE();
@@ -508,7 +508,16 @@ public:
     void PHeaderDebugDump(const std::filesystem::path& file_name);
 
 private:
+    struct SegmentMapping {
+        u64 elf_start;
+        u64 elf_end;
+        u64 self_offset;
+    };
+
     Common::FS::IOFile m_f{};
+    std::span<const u8> m_data;
+    std::vector<u8> m_buffer;
+    std::vector<SegmentMapping> m_segment_map;
     bool is_self{};
     self_header m_self{};
     std::vector<self_segment_header> m_self_segments;
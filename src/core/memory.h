@@ -12,8 +12,8 @@
 #include "core/address_space.h"
 #include "core/libraries/kernel/memory.h"
 
-namespace Vulkan {
-class Rasterizer;
+namespace VideoCore {
+class RasterizerInterface;
 }
 
 namespace Libraries::Kernel {
@@ -133,7 +133,7 @@ public:
     explicit MemoryManager();
     ~MemoryManager();
 
-    void SetRasterizer(Vulkan::Rasterizer* rasterizer_) {
+    void SetRasterizer(VideoCore::RasterizerInterface* rasterizer_) {
         rasterizer = rasterizer_;
     }
 
@@ -266,7 +266,7 @@ private:
     size_t total_direct_size{};
     size_t total_flexible_size{};
     size_t flexible_usage{};
-    Vulkan::Rasterizer* rasterizer{};
+    VideoCore::RasterizerInterface* rasterizer{};
 
     friend class ::Core::Devtools::Widget::MemoryMapViewer;
 };
@@ -115,6 +115,9 @@ void Initialize(const ::Vulkan::Instance& instance, const Frontend::WindowSDL& w
 }
 
 void OnResize() {
+    if (GetCurrentContext() == nullptr) {
+        return;
+    }
     Sdl::OnResize();
 }
 
@@ -144,6 +147,10 @@ void Shutdown(const vk::Device& device) {
 }
 
 bool ProcessEvent(SDL_Event* event) {
+    // The context only exists when a presenter is rendering the overlay.
+    if (GetCurrentContext() == nullptr) {
+        return false;
+    }
     Sdl::ProcessEvent(event);
     switch (event->type) {
     // Don't block release/up events
@@ -242,6 +249,23 @@ void Render(const vk::CommandBuffer& cmdbuf, const vk::ImageView& image_view,
     }
 }
 
+bool IsOverlayVisible() {
+    const ImGuiContext& ctx = *GetCurrentContext();
+    for (const ImGuiWindow* window : ctx.Windows) {
+        if (!window->Active || window->Hidden || window->IsFallbackWindow) {
+            continue;
+        }
+        // The dockspace host only hosts the game display.
+        if (window->RootWindow != nullptr && window->RootWindow->ID == dock_id) {
+            continue;
+        }
+        return true;
+    }
+    const ImGuiViewport* viewport = GetMainViewport();
+    return GetForegroundDrawList(viewport)->VtxBuffer.Size > 0 ||
+           GetBackgroundDrawList(viewport)->VtxBuffer.Size > 0;
+}
+
 bool MustKeepDrawing() {
     return layers.size() > 1 || DebugState.IsShowingDebugMenuBar();
 }
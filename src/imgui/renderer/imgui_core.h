@@ -33,6 +33,9 @@ ImGuiID NewFrame(bool is_reusing_frame = false);
 void Render(const vk::CommandBuffer& cmdbuf, const vk::ImageView& image_view,
             const vk::Extent2D& extent);
 
+// Whether the layers submitted anything this frame. Must be called after NewFrame.
+bool IsOverlayVisible();
+
 bool MustKeepDrawing(); // Force the emulator redraw
 
 } // namespace ImGui::Core
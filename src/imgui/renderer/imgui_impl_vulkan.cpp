@@ -5,6 +5,7 @@
 
 #include <cstdio>
 #include <mutex>
+#include <optional>
 
 #include <imgui.h>
 
@@ -22,9 +23,13 @@ struct RenderBuffer {
     vk::DeviceMemory buffer_memory{};
     vk::DeviceSize buffer_size{};
     vk::Buffer buffer{};
+    void* mapped{}; // Persistently mapped, host coherent when possible
+    bool is_coherent{};
 };
 
 // Reusable buffers used for rendering 1 current in-flight frame, for RenderDrawData()
+// One set exists per swapchain image, cycled as a ring so the CPU never writes storage the GPU
+// may still be reading.
 struct FrameRenderBuffers {
     RenderBuffer vertex;
     RenderBuffer index;
@@ -227,23 +232,58 @@ static inline vk::DeviceSize AlignBufferSize(vk::DeviceSize size, vk::DeviceSize
     return (size + alignment - 1) & ~(alignment - 1);
 }
 
-void UploadTextureData::Upload() {
-    VkData* bd = GetBackendData();
-    const InitInfo& v = bd->init_info;
+void UploadTextureData::Upload(vk::CommandBuffer cmdbuf) const {
+    const vk::ImageMemoryBarrier copy_barrier{
+        .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .oldLayout = vk::ImageLayout::eUndefined,
+        .newLayout = vk::ImageLayout::eTransferDstOptimal,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange{
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .levelCount = 1,
+            .layerCount = 1,
+        },
+    };
+    cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eHost, vk::PipelineStageFlagBits::eTransfer,
+                           {}, {}, {}, copy_barrier);
 
-    vk::SubmitInfo submit_info{
-        .commandBufferCount = 1,
-        .pCommandBuffers = &command_buffer,
+    const vk::BufferImageCopy region{
+        .imageSubresource{
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .layerCount = 1,
+        },
+        .imageExtent{
+            .width = width,
+            .height = height,
+            .depth = 1,
+        },
     };
-    CheckVkErr(v.queue.submit({submit_info}));
-    CheckVkErr(v.queue.waitIdle());
+    cmdbuf.copyBufferToImage(upload_buffer, image, vk::ImageLayout::eTransferDstOptimal, region);
+
+    const vk::ImageMemoryBarrier use_barrier{
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+        .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+        .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange{
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .levelCount = 1,
+            .layerCount = 1,
+        },
+    };
+    cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                           vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, use_barrier);
+}
 
-    v.device.destroyBuffer(upload_buffer, v.allocator);
-    v.device.freeMemory(upload_buffer_memory, v.allocator);
-    {
-        std::unique_lock lk(bd->command_pool_mutex);
-        v.device.freeCommandBuffers(bd->command_pool, {command_buffer});
-    }
+void UploadTextureData::ReleaseUploadBuffer(vk::Device device,
+                                            const vk::AllocationCallbacks* allocator) {
+    device.destroyBuffer(upload_buffer, allocator);
+    device.freeMemory(upload_buffer_memory, allocator);
     upload_buffer = VK_NULL_HANDLE;
     upload_buffer_memory = VK_NULL_HANDLE;
 }
@@ -314,19 +354,10 @@ UploadTextureData UploadTexture(const void* data, vk::Format format, u32 width,
     VkData* bd = GetBackendData();
     const InitInfo& v = bd->init_info;
 
-    UploadTextureData info{};
-    {
-        std::unique_lock lk(bd->command_pool_mutex);
-        info.command_buffer =
-            CheckVkResult(v.device.allocateCommandBuffers(vk::CommandBufferAllocateInfo{
-                              .commandPool = bd->command_pool,
-                              .commandBufferCount = 1,
-                          }))
-                .front();
-        CheckVkErr(info.command_buffer.begin(vk::CommandBufferBeginInfo{
-            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
-        }));
-    }
+    UploadTextureData info{
+        .width = width,
+        .height = height,
+    };
 
     // Create Image
     {
@@ -408,62 +439,6 @@ UploadTextureData UploadTexture(const void* data, vk::Format format, u32 width,
         v.device.unmapMemory(info.upload_buffer_memory);
     }
 
-    // Copy to Image
-    {
-        vk::ImageMemoryBarrier copy_barrier[1]{
-            {
-                .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
-                .oldLayout = vk::ImageLayout::eUndefined,
-                .newLayout = vk::ImageLayout::eTransferDstOptimal,
-                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                .image = info.image,
-                .subresourceRange{
-                    .aspectMask = vk::ImageAspectFlagBits::eColor,
-                    .levelCount = 1,
-                    .layerCount = 1,
-                },
-            },
-        };
-        info.command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eHost,
-                                            vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
-                                            {copy_barrier});
-
-        vk::BufferImageCopy region{
-            .imageSubresource{
-                .aspectMask = vk::ImageAspectFlagBits::eColor,
-                .layerCount = 1,
-            },
-            .imageExtent{
-                .width = width,
-                .height = height,
-                .depth = 1,
-            },
-        };
-        info.command_buffer.copyBufferToImage(info.upload_buffer, info.image,
-                                              vk::ImageLayout::eTransferDstOptimal, {region});
-
-        vk::ImageMemoryBarrier use_barrier[1]{{
-            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
-            .dstAccessMask = vk::AccessFlagBits::eShaderRead,
-            .oldLayout = vk::ImageLayout::eTransferDstOptimal,
-            .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image = info.image,
-            .subresourceRange{
-                .aspectMask = vk::ImageAspectFlagBits::eColor,
-                .levelCount = 1,
-                .layerCount = 1,
-            },
-        }};
-        info.command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-                                            vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {},
-                                            {use_barrier});
-    }
-
-    CheckVkErr(info.command_buffer.end());
-
     return info;
 }
 
@@ -486,6 +461,8 @@ static void CreateOrResizeBuffer(RenderBuffer& rb, size_t new_size, vk::BufferUs
         v.device.freeMemory(rb.buffer_memory, v.allocator);
     }
 
+    // Grow geometrically so a slowly expanding overlay does not reallocate every frame.
+    new_size = IM_MAX(new_size, rb.buffer_size * 2);
     const vk::DeviceSize buffer_size_aligned =
         AlignBufferSize(IM_MAX(v.min_allocation_size, new_size), bd->buffer_memory_alignment);
     vk::BufferCreateInfo buffer_info{
@@ -497,15 +474,23 @@ static void CreateOrResizeBuffer(RenderBuffer& rb, size_t new_size, vk::BufferUs
 
     const vk::MemoryRequirements req = v.device.getBufferMemoryRequirements(rb.buffer);
     bd->buffer_memory_alignment = IM_MAX(bd->buffer_memory_alignment, req.alignment);
+    u32 memory_type = FindMemoryType(
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+        req.memoryTypeBits);
+    rb.is_coherent = memory_type != 0xFFFFFFFF;
+    if (!rb.is_coherent) {
+        memory_type = FindMemoryType(vk::MemoryPropertyFlagBits::eHostVisible, req.memoryTypeBits);
+    }
     vk::MemoryAllocateInfo alloc_info{
         .allocationSize = req.size,
-        .memoryTypeIndex =
-            FindMemoryType(vk::MemoryPropertyFlagBits::eHostVisible, req.memoryTypeBits),
+        .memoryTypeIndex = memory_type,
     };
     rb.buffer_memory = CheckVkResult(v.device.allocateMemory(alloc_info, v.allocator));
 
     CheckVkErr(v.device.bindBufferMemory(rb.buffer, rb.buffer_memory, 0));
     rb.buffer_size = buffer_size_aligned;
+    rb.mapped = CheckVkResult(
+        v.device.mapMemory(rb.buffer_memory, 0, VK_WHOLE_SIZE, vk::MemoryMapFlags{}));
 }
 
 static void SetupRenderState(ImDrawData& draw_data, vk::Pipeline pipeline, vk::CommandBuffer cmdbuf,
@@ -591,12 +576,8 @@ void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
         }
 
         // Upload vertex/index data into a single contiguous GPU buffer
-        ImDrawVert* vtx_dst = nullptr;
-        ImDrawIdx* idx_dst = nullptr;
-        vtx_dst = (ImDrawVert*)CheckVkResult(
-            v.device.mapMemory(frb.vertex.buffer_memory, 0, vertex_size, vk::MemoryMapFlags{}));
-        idx_dst = (ImDrawIdx*)CheckVkResult(
-            v.device.mapMemory(frb.index.buffer_memory, 0, index_size, vk::MemoryMapFlags{}));
+        auto* vtx_dst = static_cast<ImDrawVert*>(frb.vertex.mapped);
+        auto* idx_dst = static_cast<ImDrawIdx*>(frb.index.mapped);
         for (int n = 0; n < draw_data.CmdListsCount; n++) {
             const ImDrawList* cmd_list = draw_data.CmdLists[n];
             memcpy(vtx_dst, cmd_list->VtxBuffer.Data,
@@ -605,19 +586,19 @@ void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
             vtx_dst += cmd_list->VtxBuffer.Size;
             idx_dst += cmd_list->IdxBuffer.Size;
         }
-        vk::MappedMemoryRange range[2]{
-            {
-                .memory = frb.vertex.buffer_memory,
-                .size = VK_WHOLE_SIZE,
-            },
-            {
-                .memory = frb.index.buffer_memory,
-                .size = VK_WHOLE_SIZE,
-            },
-        };
-        CheckVkErr(v.device.flushMappedMemoryRanges({range}));
-        v.device.unmapMemory(frb.vertex.buffer_memory);
-        v.device.unmapMemory(frb.index.buffer_memory);
+        if (!frb.vertex.is_coherent || !frb.index.is_coherent) {
+            vk::MappedMemoryRange range[2]{
+                {
+                    .memory = frb.vertex.buffer_memory,
+                    .size = VK_WHOLE_SIZE,
+                },
+                {
+                    .memory = frb.index.buffer_memory,
+                    .size = VK_WHOLE_SIZE,
+                },
+            };
+            CheckVkErr(v.device.flushMappedMemoryRanges({range}));
+        }
     }
 
     // Setup desired Vulkan state
@@ -630,6 +611,24 @@ void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
     // (1,1) unless using retina display which are often (2,2)
     ImVec2 clip_scale = draw_data.FramebufferScale;
 
+    // Adjacent commands sharing texture, scissor and vertex base are merged into a single draw,
+    // and descriptor/scissor binds are only issued when they change.
+    vk::DescriptorSet bound_set{};
+    vk::Rect2D bound_scissor{};
+    struct PendingDraw {
+        u32 first_index;
+        u32 index_count;
+        s32 vertex_offset;
+    };
+    std::optional<PendingDraw> pending;
+    const auto flush_draw = [&] {
+        if (pending) {
+            command_buffer.drawIndexed(pending->index_count, 1, pending->first_index,
+                                       pending->vertex_offset, 0);
+            pending.reset();
+        }
+    };
+
     // Render command lists
     // (Because we merged all buffers into a single one, we maintain our own offset into them)
     int global_vtx_offset = 0;
@@ -639,6 +638,9 @@ void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
         for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++) {
             const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
             if (pcmd->UserCallback != nullptr) {
+                flush_draw();
+                bound_set = VK_NULL_HANDLE;
+                bound_scissor = vk::Rect2D{};
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to
                 // request the renderer to reset render state.)
@@ -681,18 +683,37 @@ void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
                         .height = (uint32_t)(clip_max.y - clip_min.y),
                     },
                 };
-                command_buffer.setScissor(0, 1, &scissor);
+                const vk::DescriptorSet desc_set = pcmd->TextureId->descriptor_set;
+                const u32 first_index = pcmd->IdxOffset + global_idx_offset;
+                const s32 vertex_offset = pcmd->VtxOffset + global_vtx_offset;
+                if (pending && desc_set == bound_set && scissor == bound_scissor &&
+                    vertex_offset == pending->vertex_offset &&
+                    first_index == pending->first_index + pending->index_count) {
+                    pending->index_count += pcmd->ElemCount;
+                    continue;
+                }
+                flush_draw();
+
+                if (scissor != bound_scissor) {
+                    command_buffer.setScissor(0, 1, &scissor);
+                    bound_scissor = scissor;
+                }
 
                 // Bind DescriptorSet with font or user texture
-                vk::DescriptorSet desc_set[1]{pcmd->TextureId->descriptor_set};
-                command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-                                                  bd->pipeline_layout, 0, {desc_set}, {});
+                if (desc_set != bound_set) {
+                    command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                      bd->pipeline_layout, 0, desc_set, {});
+                    bound_set = desc_set;
+                }
 
-                // Draw
-                command_buffer.drawIndexed(pcmd->ElemCount, 1, pcmd->IdxOffset + global_idx_offset,
-                                           pcmd->VtxOffset + global_vtx_offset, 0);
+                pending = PendingDraw{
+                    .first_index = first_index,
+                    .index_count = pcmd->ElemCount,
+                    .vertex_offset = vertex_offset,
+                };
             }
         }
+        flush_draw();
         global_idx_offset += cmd_list->IdxBuffer.Size;
         global_vtx_offset += cmd_list->VtxBuffer.Size;
     }
@@ -928,6 +949,7 @@ static void DestroyFrameRenderBuffers(vk::Device device, RenderBuffer& rb,
         rb.buffer_memory = VK_NULL_HANDLE;
     }
     rb.buffer_size = 0;
+    rb.mapped = nullptr;
 }
 
 static void DestroyWindowRenderBuffers(vk::Device device, WindowRenderBuffers& buffers,
@@ -1253,6 +1275,12 @@ bool Init(InitInfo info) {
     return true;
 }
 
+const InitInfo& GetInitInfo() {
+    const VkData* bd = GetBackendData();
+    IM_ASSERT(bd != nullptr && "No renderer backend to query?");
+    return bd->init_info;
+}
+
 void Shutdown() {
     VkData* bd = GetBackendData();
     IM_ASSERT(bd != nullptr && "No renderer backend to shutdown, or already shutdown?");
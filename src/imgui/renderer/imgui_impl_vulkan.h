@@ -41,14 +41,20 @@ struct UploadTextureData {
     vk::Image image;
     vk::ImageView image_view;
     vk::DeviceMemory image_memory;
+    u32 width;
+    u32 height;
 
-    vk::CommandBuffer command_buffer; // Submit to the queue
     vk::Buffer upload_buffer;
     vk::DeviceMemory upload_buffer_memory;
 
     ImTextureID im_texture;
 
-    void Upload();
+    // Records the staging copy into a command buffer owned by the caller
+    void Upload(vk::CommandBuffer cmdbuf) const;
+
+    // Frees the staging buffer once the upload has executed on the GPU. Takes the device handles
+    // from the caller, as it may run on a thread without access to the backend data.
+    void ReleaseUploadBuffer(vk::Device device, const vk::AllocationCallbacks* allocator);
 
     void Destroy();
 };
@@ -62,6 +68,7 @@ UploadTextureData UploadTexture(const void* data, vk::Format format, u32 width,
 void RemoveTexture(ImTextureID descriptor_set);
 
 bool Init(InitInfo info);
+const InitInfo& GetInitInfo();
 void Shutdown();
 void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
                     vk::Pipeline pipeline = VK_NULL_HANDLE);
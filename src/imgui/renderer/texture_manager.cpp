@@ -13,6 +13,7 @@
 #include "common/thread.h"
 #include "imgui_impl_vulkan.h"
 #include "texture_manager.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
 
 namespace ImGui {
 
@@ -222,30 +223,48 @@ void DecodePngFile(std::filesystem::path path, Inner* core) {
     g_worker_cv.notify_one();
 }
 
-void Submit() {
-    UploadJob upload;
+void Submit(::Vulkan::Scheduler& scheduler) {
+    std::vector<UploadJob> uploads;
     {
         std::unique_lock lk{g_upload_mtx};
         if (g_upload_list.empty()) {
             return;
         }
-        // Upload one texture at a time to avoid slow down
-        upload = g_upload_list.front();
-        g_upload_list.pop_front();
-        if (upload.tick > 0) {
-            --upload.tick;
-            g_upload_list.emplace_back(upload);
-            return;
+        for (auto it = g_upload_list.begin(); it != g_upload_list.end();) {
+            if (it->tick > 0) {
+                --it->tick;
+                ++it;
+                continue;
+            }
+            uploads.push_back(std::move(*it));
+            it = g_upload_list.erase(it);
         }
     }
-    if (upload.core != nullptr) {
-        upload.core->upload_data.Upload();
+    // Pending uploads are recorded in the same batch as the caller's work and their staging
+    // buffers are released once the batch completes.
+    const auto cmdbuf = scheduler.CommandBuffer();
+    std::vector<Vulkan::UploadTextureData> staging;
+    for (auto& upload : uploads) {
+        if (upload.core == nullptr) {
+            upload.data.Destroy();
+            continue;
+        }
+        upload.core->upload_data.Upload(cmdbuf);
         upload.core->texture_id = upload.core->upload_data.im_texture;
+        staging.push_back(upload.core->upload_data);
         if (upload.core->count.fetch_sub(1) == 1) {
             delete upload.core;
         }
-    } else {
-        upload.data.Destroy();
+    }
+    if (!staging.empty()) {
+        // The callback runs on the completion thread, so it must not read the backend data.
+        const auto& init_info = Vulkan::GetInitInfo();
+        scheduler.DeferAsyncOperation([staging = std::move(staging), device = init_info.device,
+                                       allocator = init_info.allocator]() mutable {
+            for (auto& data : staging) {
+                data.ReleaseUploadBuffer(device, allocator);
+            }
+        });
     }
 }
 } // namespace Core::TextureManager
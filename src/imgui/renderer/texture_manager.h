@@ -9,8 +9,8 @@
 #include "common/types.h"
 #include "imgui/imgui_texture.h"
 
-namespace vk {
-class CommandBuffer;
+namespace Vulkan {
+class Scheduler;
 }
 
 namespace ImGui::Core::TextureManager {
@@ -25,6 +25,6 @@ void DecodePngTexture(std::vector<u8> data, Inner* core);
 
 void DecodePngFile(std::filesystem::path path, Inner* core);
 
-void Submit();
+void Submit(::Vulkan::Scheduler& scheduler);
 
 }; // namespace ImGui::Core::TextureManager
\ No newline at end of file
@@ -273,6 +273,15 @@ Id EmitGetAttribute(EmitContext& ctx, IR::Attribute attr, u32 comp, Id index) {
         if (comp == 3) {
             return ctx.OpFDiv(ctx.F32[1], ctx.ConstF32(1.f), coord);
         }
+        if (comp < 2) {
+            // Render targets may be rasterized at a different resolution than the guest expects,
+            // bring window coordinates back to guest pixels.
+            const Id render_scale{ctx.OpLoad(
+                ctx.F32[1],
+                ctx.OpAccessChain(ctx.TypePointer(spv::StorageClass::PushConstant, ctx.F32[1]),
+                                  ctx.push_data_block, ctx.ConstU32(PushData::RenderScaleIndex)))};
+            return ctx.OpFDiv(ctx.F32[1], coord, render_scale);
+        }
         return coord;
     }
     case IR::Attribute::TessellationEvaluationPointU:
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
 #include <sirit/sirit.h>
 #include "shader_recompiler/backend/spirv/emit_spirv_quad_rect.h"
 #include "shader_recompiler/runtime_info.h"
@@ -61,49 +62,13 @@ struct QuadRectListEmitter : public Sirit::Module {
         const Id output_vec4{TypePointer(spv::StorageClass::Output, vec4_id)};
 
         // Emit interpolation block of the 4th vertex in rect.
-        // Load positions
-        std::array<Id, 3> pos;
-        for (int i = 0; i < 3; i++) {
-            pos[i] = OpLoad(vec4_id, OpAccessChain(input_vec4, gl_in, Int(i), int_zero));
-        }
-
-        std::array<Id, 3> point_coord_equal;
-        for (int i = 0; i < 3; i++) {
-            // point_coord_equal[i] = equal(gl_in[i].gl_Position.xy, gl_in[(i + 1) %
-            // 3].gl_Position.xy);
-            const Id pos_l_xy{OpVectorShuffle(vec2_id, pos[i], pos[i], 0, 1)};
-            const Id pos_r_xy{OpVectorShuffle(vec2_id, pos[(i + 1) % 3], pos[(i + 1) % 3], 0, 1)};
-            point_coord_equal[i] = OpFOrdEqual(bvec2_id, pos_l_xy, pos_r_xy);
-        }
-
-        std::array<Id, 3> bary_coord;
-        std::array<Id, 3> is_edge_vertex;
-        for (int i = 0; i < 3; i++) {
-            // bool xy_equal = point_coord_equal[i].x && point_coord_equal[(i + 2) % 3].y;
-            const Id xy_equal{
-                OpLogicalAnd(bool_id, OpCompositeExtract(bool_id, point_coord_equal[i], 0),
-                             OpCompositeExtract(bool_id, point_coord_equal[(i + 2) % 3], 1))};
-            // bool yx_equal = point_coord_equal[i].y && point_coord_equal[(i + 2) % 3].x;
-            const Id yx_equal{
-                OpLogicalAnd(bool_id, OpCompositeExtract(bool_id, point_coord_equal[i], 1),
-                             OpCompositeExtract(bool_id, point_coord_equal[(i + 2) % 3], 0))};
-            // bary_coord[i] = (xy_equal || yx_equal) ? -1.f : 1.f;
-            is_edge_vertex[i] = OpLogicalOr(bool_id, xy_equal, yx_equal);
-            bary_coord[i] = OpSelect(float_id, is_edge_vertex[i], float_min_one, float_one);
-        }
-
+        const RectCorners corners{EmitRectCorners()};
+        const auto& pos = corners.pos;
+        const Id vertex_index{corners.vertex_index};
         const auto interpolate = [&](Id v0, Id v1, Id v2) {
-            // return v0 * bary_coord.x + v1 * bary_coord.y + v2 * bary_coord.z;
-            const Id p0{OpVectorTimesScalar(vec4_id, v0, bary_coord[0])};
-            const Id p1{OpVectorTimesScalar(vec4_id, v1, bary_coord[1])};
-            const Id p2{OpVectorTimesScalar(vec4_id, v2, bary_coord[2])};
-            return OpFAdd(vec4_id, p0, OpFAdd(vec4_id, p1, p2));
+            return InterpolateRectCorner(corners, v0, v1, v2);
         };
 
-        // int vertex_index_id = is_edge_vertex[1] ? 1 : (is_edge_vertex[2] ? 2 : 0);
-        Id vertex_index{OpSelect(int_id, is_edge_vertex[2], Int(2), Int(0))};
-        vertex_index = OpSelect(int_id, is_edge_vertex[1], Int(1), vertex_index);
-
         // int index = (vertex_index_id + gl_InvocationID) % 3;
         const Id invocation_id{OpLoad(int_id, gl_invocation_id)};
         const Id invocation_3{OpIEqual(bool_id, invocation_id, Int(3))};
@@ -133,6 +98,59 @@ struct QuadRectListEmitter : public Sirit::Module {
         OpFunctionEnd();
     }
 
+    /// Emits geometry shader that expands a rectangle primitive to a strip with the 4th vertex
+    /// interpolated like in the tessellation control shader, for hosts without tessellation.
+    void EmitRectListGS() {
+        DefineEntry(spv::ExecutionModel::Geometry);
+
+        const Id input_vec4{TypePointer(spv::StorageClass::Input, vec4_id)};
+        const Id output_vec4{TypePointer(spv::StorageClass::Output, vec4_id)};
+
+        const RectCorners corners{EmitRectCorners()};
+        const auto& pos = corners.pos;
+
+        // The input vertices are emitted starting from the one at the right angle, so that it
+        // ends up diagonal to the interpolated 4th vertex.
+        for (int i = 0; i < 3; i++) {
+            // int index = (vertex_index_id + i) % 3;
+            const Id index{OpSMod(int_id, OpIAdd(int_id, corners.vertex_index, Int(i)), Int(3))};
+
+            // gl_Position = gl_in[index].gl_Position;
+            const Id position{OpLoad(vec4_id, OpAccessChain(input_vec4, gl_in, index, Int(0)))};
+            OpStore(OpAccessChain(output_vec4, gl_per_vertex, Int(0)), position);
+
+            // out_paramN = in_paramN[index];
+            for (int j = 0; j < inputs.size(); j++) {
+                if (fs_info.inputs[j].IsDefault()) {
+                    continue;
+                }
+                const Id param{OpLoad(vec4_id, OpAccessChain(input_vec4, inputs[j], index))};
+                OpStore(outputs[j], param);
+            }
+            OpEmitVertex();
+        }
+
+        // gl_Position = pos3;
+        const Id pos3{InterpolateRectCorner(corners, pos[0], pos[1], pos[2])};
+        OpStore(OpAccessChain(output_vec4, gl_per_vertex, Int(0)), pos3);
+
+        // out_paramN = interpolate(bary_coord, in_paramN[0], in_paramN[1], in_paramN[2]);
+        for (int j = 0; j < inputs.size(); j++) {
+            if (fs_info.inputs[j].IsDefault()) {
+                continue;
+            }
+            const Id v0{OpLoad(vec4_id, OpAccessChain(input_vec4, inputs[j], Int(0)))};
+            const Id v1{OpLoad(vec4_id, OpAccessChain(input_vec4, inputs[j], Int(1)))};
+            const Id v2{OpLoad(vec4_id, OpAccessChain(input_vec4, inputs[j], Int(2)))};
+            OpStore(outputs[j], InterpolateRectCorner(corners, v0, v1, v2));
+        }
+        OpEmitVertex();
+        OpEndPrimitive();
+
+        OpReturn();
+        OpFunctionEnd();
+    }
+
     /// Emits a passthrough quad tessellation control shader that outputs 4 control points.
     void EmitQuadListTCS() {
         DefineEntry(spv::ExecutionModel::TessellationControl);
@@ -200,10 +218,67 @@ struct QuadRectListEmitter : public Sirit::Module {
     }
 
 private:
+    struct RectCorners {
+        std::array<Id, 3> pos;
+        std::array<Id, 3> bary_coord;
+        Id vertex_index;
+    };
+
     Id Int(s32 value) {
         return Constant(int_id, value);
     }
 
+    /// Finds the vertex at the right angle of a rect from the positions of its 3 vertices, and
+    /// the barycentric weights that extrapolate them to the 4th vertex.
+    RectCorners EmitRectCorners() {
+        const Id input_vec4{TypePointer(spv::StorageClass::Input, vec4_id)};
+
+        // Load positions
+        RectCorners corners;
+        auto& pos = corners.pos;
+        for (int i = 0; i < 3; i++) {
+            pos[i] = OpLoad(vec4_id, OpAccessChain(input_vec4, gl_in, Int(i), int_zero));
+        }
+
+        std::array<Id, 3> point_coord_equal;
+        for (int i = 0; i < 3; i++) {
+            // point_coord_equal[i] = equal(gl_in[i].gl_Position.xy, gl_in[(i + 1) %
+            // 3].gl_Position.xy);
+            const Id pos_l_xy{OpVectorShuffle(vec2_id, pos[i], pos[i], 0, 1)};
+            const Id pos_r_xy{OpVectorShuffle(vec2_id, pos[(i + 1) % 3], pos[(i + 1) % 3], 0, 1)};
+            point_coord_equal[i] = OpFOrdEqual(bvec2_id, pos_l_xy, pos_r_xy);
+        }
+
+        auto& bary_coord = corners.bary_coord;
+        std::array<Id, 3> is_edge_vertex;
+        for (int i = 0; i < 3; i++) {
+            // bool xy_equal = point_coord_equal[i].x && point_coord_equal[(i + 2) % 3].y;
+            const Id xy_equal{
+                OpLogicalAnd(bool_id, OpCompositeExtract(bool_id, point_coord_equal[i], 0),
+                             OpCompositeExtract(bool_id, point_coord_equal[(i + 2) % 3], 1))};
+            // bool yx_equal = point_coord_equal[i].y && point_coord_equal[(i + 2) % 3].x;
+            const Id yx_equal{
+                OpLogicalAnd(bool_id, OpCompositeExtract(bool_id, point_coord_equal[i], 1),
+                             OpCompositeExtract(bool_id, point_coord_equal[(i + 2) % 3], 0))};
+            // bary_coord[i] = (xy_equal || yx_equal) ? -1.f : 1.f;
+            is_edge_vertex[i] = OpLogicalOr(bool_id, xy_equal, yx_equal);
+            bary_coord[i] = OpSelect(float_id, is_edge_vertex[i], float_min_one, float_one);
+        }
+
+        // int vertex_index_id = is_edge_vertex[1] ? 1 : (is_edge_vertex[2] ? 2 : 0);
+        corners.vertex_index = OpSelect(int_id, is_edge_vertex[2], Int(2), Int(0));
+        corners.vertex_index = OpSelect(int_id, is_edge_vertex[1], Int(1), corners.vertex_index);
+        return corners;
+    }
+
+    Id InterpolateRectCorner(const RectCorners& corners, Id v0, Id v1, Id v2) {
+        // return v0 * bary_coord.x + v1 * bary_coord.y + v2 * bary_coord.z;
+        const Id p0{OpVectorTimesScalar(vec4_id, v0, corners.bary_coord[0])};
+        const Id p1{OpVectorTimesScalar(vec4_id, v1, corners.bary_coord[1])};
+        const Id p2{OpVectorTimesScalar(vec4_id, v2, corners.bary_coord[2])};
+        return OpFAdd(vec4_id, p0, OpFAdd(vec4_id, p1, p2));
+    }
+
     Id AddInput(Id type) {
         const Id input{AddGlobalVariable(TypePointer(spv::StorageClass::Input, type),
                                          spv::StorageClass::Input)};
@@ -220,11 +295,17 @@ private:
 
     void DefineEntry(spv::ExecutionModel model) {
         AddCapability(spv::Capability::Shader);
-        AddCapability(spv::Capability::Tessellation);
+        AddCapability(model == spv::ExecutionModel::Geometry ? spv::Capability::Geometry
+                                                             : spv::Capability::Tessellation);
         const Id void_function{TypeFunction(void_id)};
         main = OpFunction(void_id, spv::FunctionControlMask::MaskNone, void_function);
         if (model == spv::ExecutionModel::TessellationControl) {
             AddExecutionMode(main, spv::ExecutionMode::OutputVertices, 4U);
+        } else if (model == spv::ExecutionModel::Geometry) {
+            AddExecutionMode(main, spv::ExecutionMode::Triangles);
+            AddExecutionMode(main, spv::ExecutionMode::OutputTriangleStrip);
+            AddExecutionMode(main, spv::ExecutionMode::OutputVertices, 4U);
+            AddExecutionMode(main, spv::ExecutionMode::Invocations, 1U);
         } else {
             AddExecutionMode(main, spv::ExecutionMode::Quads);
             AddExecutionMode(main, spv::ExecutionMode::SpacingEqual);
@@ -269,13 +350,16 @@ private:
         if (model == spv::ExecutionModel::TessellationEvaluation) {
             gl_tess_coord = AddInput(vec3_id);
             Decorate(gl_tess_coord, spv::Decoration::BuiltIn, spv::BuiltIn::TessCoord);
-        } else {
+        } else if (model == spv::ExecutionModel::TessellationControl) {
             gl_invocation_id = AddInput(int_id);
             Decorate(gl_invocation_id, spv::Decoration::BuiltIn, spv::BuiltIn::InvocationId);
         }
-        const Id gl_per_vertex_array{TypeArray(gl_per_vertex_type, Constant(uint_id, 32U))};
+        // Geometry shaders take exactly the vertices of the input triangle.
+        const u32 num_vertices = model == spv::ExecutionModel::Geometry ? 3U : 32U;
+        const Id gl_per_vertex_array{
+            TypeArray(gl_per_vertex_type, Constant(uint_id, num_vertices))};
         gl_in = AddInput(gl_per_vertex_array);
-        const Id float_arr{TypeArray(vec4_id, Int(32))};
+        const Id float_arr{TypeArray(vec4_id, Int(num_vertices))};
         for (int i = 0; i < fs_info.num_inputs; i++) {
             const auto& input = fs_info.inputs[i];
             if (input.IsDefault()) {
@@ -318,12 +402,15 @@ private:
     std::vector<Id> interfaces;
 };
 
-std::vector<u32> EmitAuxilaryTessShader(AuxShaderType type, const FragmentRuntimeInfo& fs_info) {
+std::vector<u32> EmitAuxilaryShader(AuxShaderType type, const FragmentRuntimeInfo& fs_info) {
     QuadRectListEmitter ctx{fs_info};
     switch (type) {
     case AuxShaderType::RectListTCS:
         ctx.EmitRectListTCS();
         break;
+    case AuxShaderType::RectListGS:
+        ctx.EmitRectListGS();
+        break;
     case AuxShaderType::QuadListTCS:
         ctx.EmitQuadListTCS();
         break;
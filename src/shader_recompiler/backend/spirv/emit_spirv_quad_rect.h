@@ -16,9 +16,10 @@ enum class AuxShaderType : u32 {
     RectListTCS,
     QuadListTCS,
     PassthroughTES,
+    RectListGS,
 };
 
-[[nodiscard]] std::vector<u32> EmitAuxilaryTessShader(AuxShaderType type,
-                                                      const FragmentRuntimeInfo& fs_info);
+[[nodiscard]] std::vector<u32> EmitAuxilaryShader(AuxShaderType type,
+                                                  const FragmentRuntimeInfo& fs_info);
 
 } // namespace Shader::Backend::SPIRV
@@ -50,13 +50,19 @@ void ConvertPositionToClipSpace(EmitContext& ctx) {
                                           ctx.push_data_block,
                                           ctx.ConstU32(PushData::YScaleIndex))};
     const Id yscale{ctx.OpLoad(type, yscale_ptr)};
+    const Id render_scale_ptr{
+        ctx.OpAccessChain(ctx.TypePointer(spv::StorageClass::PushConstant, type),
+                          ctx.push_data_block, ctx.ConstU32(PushData::RenderScaleIndex))};
+    const Id render_scale{ctx.OpLoad(type, render_scale_ptr)};
     const Id vport_w =
         ctx.Constant(type, float(std::min<u32>(ctx.profile.max_viewport_width / 2, 8_KB)));
-    const Id wnd_x = ctx.OpFAdd(type, ctx.OpFMul(type, x, xscale), xoffset);
+    const Id wnd_x = ctx.OpFMul(type, ctx.OpFAdd(type, ctx.OpFMul(type, x, xscale), xoffset),
+                                render_scale);
     const Id ndc_x = ctx.OpFSub(type, ctx.OpFDiv(type, wnd_x, vport_w), ctx.Constant(type, 1.f));
     const Id vport_h =
         ctx.Constant(type, float(std::min<u32>(ctx.profile.max_viewport_height / 2, 8_KB)));
-    const Id wnd_y = ctx.OpFAdd(type, ctx.OpFMul(type, y, yscale), yoffset);
+    const Id wnd_y = ctx.OpFMul(type, ctx.OpFAdd(type, ctx.OpFMul(type, y, yscale), yoffset),
+                                render_scale);
     const Id ndc_y = ctx.OpFSub(type, ctx.OpFDiv(type, wnd_y, vport_h), ctx.Constant(type, 1.f));
     const Id vector{ctx.OpCompositeConstruct(ctx.F32[4], std::array<Id, 4>({ndc_x, ndc_y, z, w}))};
     ctx.OpStore(ctx.output_position, vector);
@@ -75,6 +75,7 @@ struct ImageResource {
     bool is_atomic{};
     bool is_array{};
     bool is_written{};
+    bool is_texel_access{}; ///< Addressed with texel coordinates or queried for its size
 
     [[nodiscard]] constexpr AmdGpu::Image GetSharp(const Info& info) const noexcept;
 };
@@ -106,6 +107,7 @@ struct PushData {
     static constexpr u32 YScaleIndex = 5;
     static constexpr u32 UdRegsIndex = 6;
     static constexpr u32 BufOffsetIndex = UdRegsIndex + NumUserDataRegs / 4;
+    static constexpr u32 RenderScaleIndex = BufOffsetIndex + NumBuffers / 16;
 
     u32 step0;
     u32 step1;
@@ -115,6 +117,7 @@ struct PushData {
     float yscale;
     std::array<u32, NumUserDataRegs> ud_regs;
     std::array<u8, NumBuffers> buf_offsets;
+    float render_scale;
 
     void AddOffset(u32 binding, u32 offset) {
         ASSERT(offset < 256 && binding < buf_offsets.size());
@@ -18,6 +18,37 @@ static bool IsBufferFormatStore(const IR::Inst& inst) {
     return inst.GetOpcode() == IR::Opcode::StoreBufferFormatF32;
 }
 
+static bool IsIntegerFormat(AmdGpu::NumberFormat num_fmt) {
+    return num_fmt == AmdGpu::NumberFormat::Uint || num_fmt == AmdGpu::NumberFormat::Sint;
+}
+
+/// Extracts only the used fields of an integer format instead of unpacking four of them. The raw
+/// value is zero extended by the narrow load, so a single unsigned field needs no extract at all.
+static IR::Value UnpackIntegerFields(IR::IREmitter& ir, AmdGpu::NumberFormat num_fmt,
+                                     const IR::U32& raw, u32 num_fields, u32 field_bits) {
+    const bool is_signed = num_fmt == AmdGpu::NumberFormat::Sint;
+    boost::container::static_vector<IR::Value, 2> fields;
+    for (u32 i = 0; i < num_fields; i++) {
+        const auto field = num_fields == 1 && !is_signed
+                               ? raw
+                               : ir.BitFieldExtract(raw, ir.Imm32(i * field_bits),
+                                                    ir.Imm32(field_bits), is_signed);
+        fields.push_back(ir.BitCast<IR::F32>(field));
+    }
+    return num_fields == 1 ? fields[0] : ir.CompositeConstruct(fields[0], fields[1]);
+}
+
+/// Packs only the used fields of an integer format, the narrow store drops the upper bits.
+static IR::U32 PackIntegerFields(IR::IREmitter& ir, const IR::Value& value, u32 num_fields,
+                                 u32 field_bits) {
+    if (num_fields == 1) {
+        return ir.BitCast<IR::U32>(IR::F32{value});
+    }
+    const auto x = ir.BitCast<IR::U32>(IR::F32{ir.CompositeExtract(value, 0)});
+    const auto y = ir.BitCast<IR::U32>(IR::F32{ir.CompositeExtract(value, 1)});
+    return ir.BitFieldInsert(x, y, ir.Imm32(field_bits), ir.Imm32(field_bits));
+}
+
 static IR::Value LoadBufferFormat(IR::IREmitter& ir, const AmdGpu::Buffer& buffer,
                                   const IR::Value handle, const IR::U32 address,
                                   const IR::BufferInstInfo info) {
@@ -32,12 +63,21 @@ static IR::Value LoadBufferFormat(IR::IREmitter& ir, const AmdGpu::Buffer& buffe
         interpreted = ir.Imm32(0.f);
         break;
     case AmdGpu::DataFormat::Format8: {
-        const auto unpacked = ir.Unpack4x8(num_fmt, ir.LoadBufferU8(handle, address, info));
+        const auto raw = ir.LoadBufferU8(handle, address, info);
+        if (IsIntegerFormat(num_fmt)) {
+            interpreted = UnpackIntegerFields(ir, num_fmt, raw, 1, 8);
+            break;
+        }
+        const auto unpacked = ir.Unpack4x8(num_fmt, raw);
         interpreted = ir.CompositeExtract(unpacked, 0);
         break;
     }
     case AmdGpu::DataFormat::Format8_8: {
         const auto raw = ir.LoadBufferU16(handle, address, info);
+        if (IsIntegerFormat(num_fmt)) {
+            interpreted = UnpackIntegerFields(ir, num_fmt, raw, 2, 8);
+            break;
+        }
         const auto unpacked = ir.Unpack4x8(num_fmt, raw);
         interpreted = ir.CompositeConstruct(ir.CompositeExtract(unpacked, 0),
                                             ir.CompositeExtract(unpacked, 1));
@@ -47,7 +87,12 @@ static IR::Value LoadBufferFormat(IR::IREmitter& ir, const AmdGpu::Buffer& buffe
         interpreted = ir.Unpack4x8(num_fmt, IR::U32{ir.LoadBufferU32(1, handle, address, info)});
         break;
     case AmdGpu::DataFormat::Format16: {
-        const auto unpacked = ir.Unpack2x16(num_fmt, ir.LoadBufferU16(handle, address, info));
+        const auto raw = ir.LoadBufferU16(handle, address, info);
+        if (IsIntegerFormat(num_fmt)) {
+            interpreted = UnpackIntegerFields(ir, num_fmt, raw, 1, 16);
+            break;
+        }
+        const auto unpacked = ir.Unpack2x16(num_fmt, raw);
         interpreted = ir.CompositeExtract(unpacked, 0);
         break;
     }
@@ -120,16 +165,20 @@ static void StoreBufferFormat(IR::IREmitter& ir, const AmdGpu::Buffer& buffer,
         break;
     case AmdGpu::DataFormat::Format8: {
         const auto packed =
-            ir.Pack4x8(num_fmt, ir.CompositeConstruct(real_value, ir.Imm32(0.f), ir.Imm32(0.f),
-                                                      ir.Imm32(0.f)));
+            IsIntegerFormat(num_fmt)
+                ? PackIntegerFields(ir, real_value, 1, 8)
+                : ir.Pack4x8(num_fmt, ir.CompositeConstruct(real_value, ir.Imm32(0.f),
+                                                            ir.Imm32(0.f), ir.Imm32(0.f)));
         ir.StoreBufferU8(handle, address, packed, info);
         break;
     }
     case AmdGpu::DataFormat::Format8_8: {
         const auto packed =
-            ir.Pack4x8(num_fmt, ir.CompositeConstruct(ir.CompositeExtract(real_value, 0),
-                                                      ir.CompositeExtract(real_value, 1),
-                                                      ir.Imm32(0.f), ir.Imm32(0.f)));
+            IsIntegerFormat(num_fmt)
+                ? PackIntegerFields(ir, real_value, 2, 8)
+                : ir.Pack4x8(num_fmt, ir.CompositeConstruct(ir.CompositeExtract(real_value, 0),
+                                                            ir.CompositeExtract(real_value, 1),
+                                                            ir.Imm32(0.f), ir.Imm32(0.f)));
         ir.StoreBufferU16(handle, address, packed, info);
         break;
     }
@@ -139,7 +188,10 @@ static void StoreBufferFormat(IR::IREmitter& ir, const AmdGpu::Buffer& buffer,
         break;
     }
     case AmdGpu::DataFormat::Format16: {
-        const auto packed = ir.Pack2x16(num_fmt, ir.CompositeConstruct(real_value, ir.Imm32(0.f)));
+        const auto packed =
+            IsIntegerFormat(num_fmt)
+                ? PackIntegerFields(ir, real_value, 1, 16)
+                : ir.Pack2x16(num_fmt, ir.CompositeConstruct(real_value, ir.Imm32(0.f)));
         ir.StoreBufferU16(handle, address, packed, info);
         break;
     }
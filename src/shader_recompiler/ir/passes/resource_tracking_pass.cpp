@@ -152,6 +152,7 @@ public:
         auto& image = image_resources[index];
         image.is_atomic |= desc.is_atomic;
         image.is_written |= desc.is_written;
+        image.is_texel_access |= desc.is_texel_access;
         return index;
     }
 
@@ -376,6 +377,8 @@ void PatchImageSharp(IR::Block& block, IR::Inst& inst, Info& info, Descriptors&
         .is_atomic = IsImageAtomicInstruction(inst),
         .is_array = bool(inst_info.is_array),
         .is_written = is_written,
+        .is_texel_access = inst.GetOpcode() != IR::Opcode::ImageSampleRaw &&
+                           inst.GetOpcode() != IR::Opcode::ImageQueryLod,
     });
 
     IR::IREmitter ir{block, IR::Block::InstructionList::s_iterator_to(inst)};
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <boost/preprocessor/stringize.hpp>
 
 #include "common/assert.h"
@@ -13,8 +14,8 @@
 #include "core/memory.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/amdgpu/pm4_cmds.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/renderdoc.h"
-#include "video_core/renderer_vulkan/vk_rasterizer.h"
 
 namespace AmdGpu {
 
@@ -49,6 +50,13 @@ static const char* acb_task_name[] = NAME_ARRAY(ACB_TASK, MAX_NAMES);
 
 std::array<u8, 48_KB> Liverpool::ConstantEngine::constants_heap;
 
+// Guest CPU stores to a label only reach NotifyMemoryWrite when they fault on a tracked page.
+// Blocked queues are therefore polled with a short spin first, so labels the CPU signals are
+// seen quickly, and only then parked with a backoff.
+constexpr u32 MemoryWaitSpinRounds = 64;
+constexpr std::chrono::microseconds MinMemoryWaitTimeout{50};
+constexpr std::chrono::microseconds MaxMemoryWaitTimeout{1000};
+
 static std::span<const u32> NextPacket(std::span<const u32> span, size_t offset) {
     if (offset > span.size()) {
         LOG_ERROR(
@@ -88,11 +96,15 @@ void Liverpool::Process(std::stop_token stoken) {
         VideoCore::StartCapture();
 
         curr_qid = -1;
+        u32 num_idle_queues = 0;
+        u32 num_idle_rounds = 0;
 
         while (num_submits || num_commands) {
 
             // Process incoming commands with high priority
             while (num_commands) {
+                num_idle_queues = 0;
+                num_idle_rounds = 0;
 
                 Common::UniqueFunction<void> callback{};
                 {
@@ -106,6 +118,13 @@ void Liverpool::Process(std::stop_token stoken) {
                 --num_commands;
             }
 
+            // Every queue is either empty or blocked in WaitRegMem, so resuming them again
+            // would only spin on the same conditions.
+            if (num_idle_queues >= num_mapped_queues) {
+                WaitForMemoryWrite(num_idle_rounds++);
+                num_idle_queues = 0;
+            }
+
             curr_qid = (curr_qid + 1) % num_mapped_queues;
 
             auto& queue = mapped_queues[curr_qid];
@@ -114,12 +133,20 @@ void Liverpool::Process(std::stop_token stoken) {
             {
                 std::scoped_lock lock{queue.m_access};
                 if (queue.submits.empty()) {
+                    ++num_idle_queues;
                     continue;
                 }
                 task = queue.submits.front();
             }
             task.resume();
 
+            if (queue.wait_address != 0) {
+                ++num_idle_queues;
+            } else {
+                num_idle_queues = 0;
+                num_idle_rounds = 0;
+            }
+
             if (task.done()) {
                 task.destroy();
 
@@ -145,6 +172,55 @@ void Liverpool::Process(std::stop_token stoken) {
     }
 }
 
+void Liverpool::NotifyMemoryWrite(VAddr address, u64 size) {
+    if (num_waiting_queues == 0) {
+        return;
+    }
+    const VAddr end = address + size;
+    const bool is_waited = std::ranges::any_of(mapped_queues, [&](const GpuQueue& queue) {
+        const VAddr wait_address = queue.wait_address;
+        return wait_address != 0 && wait_address >= address && wait_address < end;
+    });
+    if (!is_waited) {
+        return;
+    }
+    std::scoped_lock lk{submit_mutex};
+    memory_written = true;
+    submit_cv.notify_all();
+}
+
+void Liverpool::NotifyDmaWrite(const PM4DmaData* dma_data) {
+    const u32 num_bytes =
+        dma_data->src_sel == DmaDataSrc::Data ? u32(sizeof(u32)) : dma_data->NumBytes();
+    NotifyMemoryWrite(dma_data->DstAddress<VAddr>(), num_bytes);
+}
+
+void Liverpool::BeginMemoryWait(u32 qid, VAddr address) {
+    mapped_queues[qid].wait_address = address;
+    ++num_waiting_queues;
+}
+
+void Liverpool::EndMemoryWait(u32 qid) {
+    mapped_queues[qid].wait_address = 0;
+    --num_waiting_queues;
+}
+
+void Liverpool::WaitForMemoryWrite(u32 num_idle_rounds) {
+    if (num_idle_rounds < MemoryWaitSpinRounds) {
+        std::this_thread::yield();
+        return;
+    }
+    const u32 num_park_rounds = std::min(num_idle_rounds - MemoryWaitSpinRounds, 5U);
+    const auto timeout =
+        std::min(MinMemoryWaitTimeout * (1U << num_park_rounds), MaxMemoryWaitTimeout);
+    const u32 prev_submits = num_submits;
+    std::unique_lock lk{submit_mutex};
+    submit_cv.wait_for(lk, timeout, [&] {
+        return memory_written || num_commands || num_submits != prev_submits;
+    });
+    memory_written = false;
+}
+
 Liverpool::Task Liverpool::ProcessCeUpdate(std::span<const u32> ccb) {
     FIBER_ENTER(ccb_task_name);
 
@@ -567,29 +643,31 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::EventWriteEos: {
                 const auto* event_eos = reinterpret_cast<const PM4CmdEventWriteEos*>(header);
-                event_eos->SignalFence([](void* address, u64 data, u32 num_bytes) {
+                event_eos->SignalFence([this](void* address, u64 data, u32 num_bytes) {
                     auto* memory = Core::Memory::Instance();
                     if (!memory->TryWriteBacking(address, &data, num_bytes)) {
                         memcpy(address, &data, num_bytes);
                     }
+                    NotifyMemoryWrite(reinterpret_cast<VAddr>(address), num_bytes);
                 });
                 if (event_eos->command == PM4CmdEventWriteEos::Command::GdsStore) {
                     ASSERT(event_eos->size == 1);
                     if (rasterizer) {
-                        rasterizer->Finish();
-                        const u32 value = rasterizer->ReadDataFromGds(event_eos->gds_index);
-                        *event_eos->Address() = value;
+                        rasterizer->CopyGdsToMemory(event_eos->Address<VAddr>(),
+                                                    event_eos->gds_index, sizeof(u32));
+                        NotifyMemoryWrite(event_eos->Address<VAddr>(), sizeof(u32));
                     }
                 }
                 break;
             }
             case PM4ItOpcode::EventWriteEop: {
                 const auto* event_eop = reinterpret_cast<const PM4CmdEventWriteEop*>(header);
-                event_eop->SignalFence([](void* address, u64 data, u32 num_bytes) {
+                event_eop->SignalFence([this](void* address, u64 data, u32 num_bytes) {
                     auto* memory = Core::Memory::Instance();
                     if (!memory->TryWriteBacking(address, &data, num_bytes)) {
                         memcpy(address, &data, num_bytes);
                     }
+                    NotifyMemoryWrite(reinterpret_cast<VAddr>(address), num_bytes);
                 });
                 break;
             }
@@ -603,16 +681,17 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                                            true);
                 } else if (dma_data->src_sel == DmaDataSrc::Memory &&
                            dma_data->dst_sel == DmaDataDst::Gds) {
-                    rasterizer->InlineData(dma_data->dst_addr_lo,
-                                           dma_data->SrcAddress<const void*>(),
-                                           dma_data->NumBytes(), true);
+                    rasterizer->CopyMemoryToGds(dma_data->dst_addr_lo,
+                                                dma_data->SrcAddress<VAddr>(),
+                                                dma_data->NumBytes());
                 } else if (dma_data->src_sel == DmaDataSrc::Data &&
                            dma_data->dst_sel == DmaDataDst::Memory) {
                     rasterizer->InlineData(dma_data->DstAddress<VAddr>(), &dma_data->data,
                                            sizeof(u32), false);
                 } else if (dma_data->src_sel == DmaDataSrc::Gds &&
                            dma_data->dst_sel == DmaDataDst::Memory) {
-                    // LOG_WARNING(Render_Vulkan, "GDS memory read");
+                    rasterizer->CopyGdsToMemory(dma_data->DstAddress<VAddr>(),
+                                                dma_data->src_addr_lo, dma_data->NumBytes());
                 } else if (dma_data->src_sel == DmaDataSrc::Memory &&
                            dma_data->dst_sel == DmaDataDst::Memory) {
                     rasterizer->InlineData(dma_data->DstAddress<VAddr>(),
@@ -622,6 +701,9 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                     UNREACHABLE_MSG("WriteData src_sel = {}, dst_sel = {}",
                                     u32(dma_data->src_sel.Value()), u32(dma_data->dst_sel.Value()));
                 }
+                if (dma_data->dst_sel == DmaDataDst::Memory) {
+                    NotifyDmaWrite(dma_data);
+                }
                 break;
             }
             case PM4ItOpcode::WriteData: {
@@ -634,6 +716,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 } else {
                     UNREACHABLE();
                 }
+                NotifyMemoryWrite(reinterpret_cast<VAddr>(address), data_size);
                 break;
             }
             case PM4ItOpcode::MemSemaphore: {
@@ -671,9 +754,11 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                     num_submits == mapped_queues[GfxQueueId].submits.size()) {
                     vo_port->WaitVoLabel([&] { return wait_reg_mem->Test(); });
                 }
+                BeginMemoryWait(GfxQueueId, wait_reg_mem->Address<VAddr>());
                 while (!wait_reg_mem->Test()) {
                     YIELD_GFX();
                 }
+                EndMemoryWait(GfxQueueId);
                 break;
             }
             case PM4ItOpcode::IndirectBuffer: {
@@ -767,15 +852,16 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
                 rasterizer->InlineData(dma_data->dst_addr_lo, &dma_data->data, sizeof(u32), true);
             } else if (dma_data->src_sel == DmaDataSrc::Memory &&
                        dma_data->dst_sel == DmaDataDst::Gds) {
-                rasterizer->InlineData(dma_data->dst_addr_lo, dma_data->SrcAddress<const void*>(),
-                                       dma_data->NumBytes(), true);
+                rasterizer->CopyMemoryToGds(dma_data->dst_addr_lo, dma_data->SrcAddress<VAddr>(),
+                                            dma_data->NumBytes());
             } else if (dma_data->src_sel == DmaDataSrc::Data &&
                        dma_data->dst_sel == DmaDataDst::Memory) {
                 rasterizer->InlineData(dma_data->DstAddress<VAddr>(), &dma_data->data, sizeof(u32),
                                        false);
             } else if (dma_data->src_sel == DmaDataSrc::Gds &&
                        dma_data->dst_sel == DmaDataDst::Memory) {
-                // LOG_WARNING(Render_Vulkan, "GDS memory read");
+                rasterizer->CopyGdsToMemory(dma_data->DstAddress<VAddr>(), dma_data->src_addr_lo,
+                                            dma_data->NumBytes());
             } else if (dma_data->src_sel == DmaDataSrc::Memory &&
                        dma_data->dst_sel == DmaDataDst::Memory) {
                 rasterizer->InlineData(dma_data->DstAddress<VAddr>(),
@@ -785,6 +871,9 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
                 UNREACHABLE_MSG("WriteData src_sel = {}, dst_sel = {}",
                                 u32(dma_data->src_sel.Value()), u32(dma_data->dst_sel.Value()));
             }
+            if (dma_data->dst_sel == DmaDataDst::Memory) {
+                NotifyDmaWrite(dma_data);
+            }
             break;
         }
         case PM4ItOpcode::AcquireMem: {
@@ -861,6 +950,7 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
             } else {
                 UNREACHABLE();
             }
+            NotifyMemoryWrite(write_data->Address<VAddr>(), data_size);
             break;
         }
         case PM4ItOpcode::MemSemaphore: {
@@ -878,14 +968,17 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
         case PM4ItOpcode::WaitRegMem: {
             const auto* wait_reg_mem = reinterpret_cast<const PM4CmdWaitRegMem*>(header);
             ASSERT(wait_reg_mem->engine.Value() == PM4CmdWaitRegMem::Engine::Me);
+            BeginMemoryWait(vqid + 1, wait_reg_mem->Address<VAddr>());
             while (!wait_reg_mem->Test()) {
                 YIELD_ASC(vqid);
             }
+            EndMemoryWait(vqid + 1);
             break;
         }
         case PM4ItOpcode::ReleaseMem: {
             const auto* release_mem = reinterpret_cast<const PM4CmdReleaseMem*>(header);
             release_mem->SignalFence(static_cast<Platform::InterruptId>(queue.pipe_id));
+            NotifyMemoryWrite(reinterpret_cast<VAddr>(release_mem->Address<u64>()), sizeof(u64));
             break;
         }
         case PM4ItOpcode::EventWrite: {
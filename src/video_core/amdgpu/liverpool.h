@@ -4,6 +4,8 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <coroutine>
 #include <exception>
@@ -24,8 +26,8 @@
 #include "video_core/amdgpu/resource.h"
 #include "video_core/amdgpu/types.h"
 
-namespace Vulkan {
-class Rasterizer;
+namespace VideoCore {
+class RasterizerInterface;
 }
 
 namespace Libraries::VideoOut {
@@ -34,6 +36,8 @@ struct VideoOutPort;
 
 namespace AmdGpu {
 
+struct PM4DmaData;
+
 #define GFX6_3D_REG_INDEX(field_name) (offsetof(AmdGpu::Liverpool::Regs, field_name) / sizeof(u32))
 
 #define CONCAT2(x, y) DO_CONCAT2(x, y)
@@ -1472,7 +1476,7 @@ public:
         vo_port = port;
     }
 
-    void BindRasterizer(Vulkan::Rasterizer* rasterizer_) {
+    void BindRasterizer(VideoCore::RasterizerInterface* rasterizer_) {
         rasterizer = rasterizer_;
     }
 
@@ -1483,6 +1487,10 @@ public:
         submit_cv.notify_one();
     }
 
+    /// Reports a write to guest memory that a queue blocked in WaitRegMem may be polling.
+    /// Wakes the command processor when the range covers one of the registered wait addresses.
+    void NotifyMemoryWrite(VAddr address, u64 size);
+
     void reserveCopyBufferSpace() {
         GpuQueue& gfx_queue = mapped_queues[GfxQueueId];
         std::scoped_lock<std::mutex> lk(gfx_queue.m_access);
@@ -1546,6 +1554,17 @@ private:
 
     void Process(std::stop_token stoken);
 
+    /// Reports the guest memory written by a DmaData packet with a memory destination.
+    void NotifyDmaWrite(const PM4DmaData* dma_data);
+
+    /// Registers the address a queue polls in WaitRegMem, so that writes to it wake us up.
+    void BeginMemoryWait(u32 qid, VAddr address);
+    void EndMemoryWait(u32 qid);
+
+    /// Spins, then parks the command processor, after a round in which every queue stayed
+    /// blocked.
+    void WaitForMemoryWrite(u32 num_idle_rounds);
+
     struct GpuQueue {
         std::mutex m_access{};
         std::atomic<u32> dcb_buffer_offset;
@@ -1554,6 +1573,7 @@ private:
         std::vector<u32> ccb_buffer;
         std::queue<Task::Handle> submits{};
         ComputeProgram cs_state{};
+        std::atomic<VAddr> wait_address{}; ///< Address polled by a blocked WaitRegMem, if any
     };
     std::array<GpuQueue, NumTotalQueues> mapped_queues{};
     u32 num_mapped_queues{1u}; // GFX is always available
@@ -1578,7 +1598,7 @@ private:
         static std::array<u8, 48_KB> constants_heap;
     } cblock{};
 
-    Vulkan::Rasterizer* rasterizer{};
+    VideoCore::RasterizerInterface* rasterizer{};
     Libraries::VideoOut::VideoOutPort* vo_port{};
     std::jthread process_thread{};
     std::atomic<u32> num_submits{};
@@ -1587,6 +1607,8 @@ private:
     std::mutex submit_mutex;
     std::condition_variable_any submit_cv;
     std::queue<Common::UniqueFunction<void>> command_queue{};
+    std::atomic<u32> num_waiting_queues{};
+    bool memory_written{};
     int curr_qid{-1};
 };
 
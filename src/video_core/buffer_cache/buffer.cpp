@@ -3,6 +3,7 @@
 
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/renderer_vulkan/liverpool_to_vk.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
@@ -92,6 +93,13 @@ Buffer::Buffer(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                VAddr cpu_addr_, vk::BufferUsageFlags flags, u64 size_bytes_)
     : cpu_addr{cpu_addr_}, size_bytes{size_bytes_}, instance{&instance_}, scheduler{&scheduler_},
       usage{usage_}, buffer{instance->GetDevice(), instance->GetAllocator()} {
+    // Descriptor buffers reference bound buffers by their device address.
+    if (instance->IsDescriptorBufferSupported() &&
+        (flags & (vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+                  vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT))) {
+        flags |= vk::BufferUsageFlagBits::eShaderDeviceAddress;
+    }
+
     // Create buffer object.
     const vk::BufferCreateInfo buffer_ci = {
         .size = size_bytes,
@@ -102,6 +110,9 @@ Buffer::Buffer(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
 
     const auto device = instance->GetDevice();
     Vulkan::SetObjectName(device, Handle(), "Buffer {:#x}:{:#x}", cpu_addr, size_bytes);
+    if (flags & vk::BufferUsageFlagBits::eShaderDeviceAddress) {
+        device_addr = device.getBufferAddress({.buffer = Handle()});
+    }
 
     // Map it if it is host visible.
     VkMemoryPropertyFlags property_flags{};
@@ -112,14 +123,11 @@ Buffer::Buffer(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
     is_coherent = property_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 }
 
-constexpr u64 WATCHES_INITIAL_RESERVE = 0x4000;
-constexpr u64 WATCHES_RESERVE_CHUNK = 0x1000;
-
 StreamBuffer::StreamBuffer(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
-                           MemoryUsage usage, u64 size_bytes)
-    : Buffer{instance, scheduler, usage, 0, AllFlags, size_bytes} {
-    ReserveWatches(current_watches, WATCHES_INITIAL_RESERVE);
-    ReserveWatches(previous_watches, WATCHES_INITIAL_RESERVE);
+                           MemoryUsage usage, u64 size_bytes, u64 max_size_bytes_,
+                           vk::BufferUsageFlags flags)
+    : Buffer{instance, scheduler, usage, 0, flags, size_bytes}, usage_flags{flags},
+      max_size_bytes{std::max(max_size_bytes_, size_bytes)}, slice_size{size_bytes / NumSlices} {
     const auto device = instance.GetDevice();
     Vulkan::SetObjectName(device, Handle(), "StreamBuffer({}):{:#x}", BufferTypeName(usage),
                           size_bytes);
@@ -130,64 +138,141 @@ std::pair<u8*, u64> StreamBuffer::Map(u64 size, u64 alignment) {
         size = Common::AlignUp(size, instance->NonCoherentAtomSize());
     }
 
-    ASSERT(size <= this->size_bytes);
-    mapped_size = size;
-
-    if (alignment > 0) {
-        offset = Common::AlignUp(offset, alignment);
+    if (pending_grow_size != 0 && scheduler->CurrentTick() != grow_request_tick) {
+        // A submit happened since growth was requested, nobody is holding the old handle.
+        Grow(pending_grow_size);
     }
+    // Growing here would swap the buffer in the middle of a batch, so bigger requests must be
+    // served elsewhere and reported through RecordFallback.
+    ASSERT(CanFit(size));
+    mapped_size = size;
 
-    if (offset + size > this->size_bytes) {
-        // The buffer would overflow, save the amount of used watches and reset the state.
-        invalidation_mark = current_watch_cursor;
-        current_watch_cursor = 0;
-        offset = 0;
-
-        // Swap watches and reset waiting cursors.
-        std::swap(previous_watches, current_watches);
-        wait_cursor = 0;
-        wait_bound = 0;
+    // Reserve the range with the same CAS loop as inline copies so neither can overlap the other.
+    u64 cur_offset = offset.load(std::memory_order_relaxed);
+    u64 map_offset{};
+    bool wrapped{};
+    do {
+        map_offset = alignment > 0 ? Common::AlignUp(cur_offset, alignment) : cur_offset;
+        // The buffer would overflow, continue from the start.
+        wrapped = map_offset + size > size_bytes;
+        if (wrapped) {
+            map_offset = 0;
+        }
+    } while (!offset.compare_exchange_weak(cur_offset, map_offset + size,
+                                           std::memory_order_acq_rel, std::memory_order_relaxed));
+    if (wrapped) {
+        current_slice.store(NumSlices, std::memory_order_release);
+        ++stats.wraps;
     }
 
-    const u64 mapped_upper_bound = offset + size;
-    WaitPendingOperations(mapped_upper_bound);
-    return std::make_pair(mapped_data.data() + offset, offset);
+    AcquireSlices(map_offset, map_offset + size);
+    mapped_offset = map_offset;
+    return std::make_pair(mapped_data.data() + map_offset, map_offset);
 }
 
 void StreamBuffer::Commit() {
+    const u64 map_offset = mapped_offset;
     if (!is_coherent) {
         if (usage == MemoryUsage::Download) {
-            vmaInvalidateAllocation(instance->GetAllocator(), buffer.allocation, offset,
+            vmaInvalidateAllocation(instance->GetAllocator(), buffer.allocation, map_offset,
                                     mapped_size);
         } else {
-            vmaFlushAllocation(instance->GetAllocator(), buffer.allocation, offset, mapped_size);
+            vmaFlushAllocation(instance->GetAllocator(), buffer.allocation, map_offset,
+                               mapped_size);
+        }
+    }
+
+    MarkSlices(map_offset, map_offset + mapped_size);
+    mapped_size = 0;
+}
+
+std::optional<u64> StreamBuffer::TryCopyInline(const void* src, u64 size, u64 alignment) {
+    if (!is_coherent || size == 0) {
+        return std::nullopt;
+    }
+    const u32 slice = current_slice.load(std::memory_order_acquire);
+    u64 cur_offset = offset.load(std::memory_order_relaxed);
+    u64 new_offset{};
+    u64 alloc_offset{};
+    do {
+        alloc_offset = alignment > 0 ? Common::AlignUp(cur_offset, alignment) : cur_offset;
+        new_offset = alloc_offset + size;
+        // Leaving the current slice requires synchronization with the GPU, use the slow path.
+        if (slice >= NumSlices || new_offset > size_bytes || SliceOf(new_offset - 1) != slice) {
+            return std::nullopt;
+        }
+    } while (!offset.compare_exchange_weak(cur_offset, new_offset, std::memory_order_acq_rel,
+                                           std::memory_order_relaxed));
+
+    std::memcpy(mapped_data.data() + alloc_offset, src, size);
+    slice_ticks[slice].store(scheduler->CurrentTick(), std::memory_order_relaxed);
+    return alloc_offset;
+}
+
+void StreamBuffer::AcquireSlices(u64 begin, u64 end) {
+    const u32 last_slice = std::min(SliceOf(end - 1), NumSlices - 1);
+    for (u32 slice = SliceOf(begin); slice <= last_slice; ++slice) {
+        if (slice == current_slice.load(std::memory_order_relaxed)) {
+            // Already owned by the CPU in this lap.
+            continue;
+        }
+        const u64 tick = slice_ticks[slice].load(std::memory_order_relaxed);
+        if (tick != 0 && !scheduler->IsFree(tick)) {
+            RequestGrow(size_bytes * 2);
+            ++stats.stalls;
+            scheduler->Wait(tick);
         }
     }
+    current_slice.store(last_slice, std::memory_order_release);
+}
 
-    offset += mapped_size;
-    if (current_watch_cursor + 1 >= current_watches.size()) {
-        // Ensure that there are enough watches.
-        ReserveWatches(current_watches, WATCHES_RESERVE_CHUNK);
+void StreamBuffer::RecordFallback(u64 size) {
+    ++stats.fallbacks;
+    if (size <= max_size_bytes) {
+        RequestGrow(size);
     }
+}
 
-    auto& watch = current_watches[current_watch_cursor++];
-    watch.upper_bound = offset;
-    watch.tick = scheduler->CurrentTick();
+void StreamBuffer::RequestGrow(u64 min_size) {
+    if (size_bytes >= max_size_bytes || pending_grow_size >= min_size) {
+        return;
+    }
+    // Callers may still hold the current handle, so only grow after the next submit.
+    pending_grow_size = min_size;
+    grow_request_tick = scheduler->CurrentTick();
 }
 
-void StreamBuffer::ReserveWatches(std::vector<Watch>& watches, std::size_t grow_size) {
-    watches.resize(watches.size() + grow_size);
+void StreamBuffer::Grow(u64 min_size) {
+    const u64 new_size = std::min(std::max(min_size, size_bytes * 2), max_size_bytes);
+    LOG_INFO(Render_Vulkan, "Growing {} stream buffer from {:#x} to {:#x} bytes",
+             BufferTypeName(usage), size_bytes, new_size);
+
+    Buffer new_buffer{*instance, *scheduler, usage, 0, usage_flags, new_size};
+    std::swap(static_cast<Buffer&>(*this), new_buffer);
+    Vulkan::SetObjectName(instance->GetDevice(), Handle(), "StreamBuffer({}):{:#x}",
+                          BufferTypeName(usage), size_bytes);
+
+    // Previous memory might still be in use by the GPU.
+    scheduler->DeferAsyncOperation([buffer = std::move(new_buffer)]() mutable {});
+
+    slice_size = size_bytes / NumSlices;
+    for (auto& tick : slice_ticks) {
+        tick.store(0, std::memory_order_relaxed);
+    }
+    offset.store(0, std::memory_order_relaxed);
+    current_slice.store(0, std::memory_order_relaxed);
+    pending_grow_size = 0;
+    ++stats.grows;
 }
 
-void StreamBuffer::WaitPendingOperations(u64 requested_upper_bound) {
-    if (!invalidation_mark) {
+void StreamBuffer::MarkSlices(u64 begin, u64 end) {
+    if (begin == end) {
         return;
     }
-    while (requested_upper_bound > wait_bound && wait_cursor < *invalidation_mark) {
-        auto& watch = previous_watches[wait_cursor];
-        wait_bound = watch.upper_bound;
-        scheduler->Wait(watch.tick);
-        ++wait_cursor;
+    const u64 tick = scheduler->CurrentTick();
+    const u32 last_slice = std::min(SliceOf(end - 1), NumSlices - 1);
+    for (u32 slice = SliceOf(begin); slice <= last_slice; ++slice) {
+        slice_ticks[slice].store(tick, std::memory_order_relaxed);
     }
 }
 
@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstring>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -115,6 +118,11 @@ public:
         return buffer;
     }
 
+    /// Returns the GPU address of the buffer, zero when device addresses are not in use
+    vk::DeviceAddress DeviceAddress() const noexcept {
+        return device_addr;
+    }
+
     std::optional<vk::BufferMemoryBarrier2> GetBarrier(
         vk::Flags<vk::AccessFlagBits2> dst_acess_mask, vk::PipelineStageFlagBits2 dst_stage,
         u32 offset = 0) {
@@ -145,6 +153,7 @@ public:
     bool is_deleted{};
     int stream_score = 0;
     size_t size_bytes = 0;
+    vk::DeviceAddress device_addr{};
     std::span<u8> mapped_data;
     const Vulkan::Instance* instance;
     Vulkan::Scheduler* scheduler;
@@ -158,8 +167,17 @@ public:
 
 class StreamBuffer : public Buffer {
 public:
+    /// Allocation counters, useful to tune buffer sizes.
+    struct Stats {
+        u64 stalls{};    ///< Times the CPU had to wait for the GPU to release a slice.
+        u64 wraps{};     ///< Times the write cursor wrapped to the buffer start.
+        u64 grows{};     ///< Times the buffer was reallocated with a bigger size.
+        u64 fallbacks{}; ///< Requests that did not fit and were served elsewhere.
+    };
+
     explicit StreamBuffer(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
-                          MemoryUsage usage, u64 size_bytes_);
+                          MemoryUsage usage, u64 size_bytes_, u64 max_size_bytes_ = 0,
+                          vk::BufferUsageFlags flags = AllFlags);
 
     /// Reserves a region of memory from the stream buffer.
     std::pair<u8*, u64> Map(u64 size, u64 alignment = 0);
@@ -169,6 +187,12 @@ public:
 
     /// Maps and commits a memory region with user provided data
     u64 Copy(auto src, size_t size, size_t alignment = 0) {
+        if (size <= InlineThreshold) {
+            if (const auto offset = TryCopyInline(reinterpret_cast<const void*>(src), size,
+                                                  alignment)) {
+                return *offset;
+            }
+        }
         const auto [data, offset] = Map(size, alignment);
         std::memcpy(data, reinterpret_cast<const void*>(src), size);
         Commit();
@@ -176,30 +200,58 @@ public:
     }
 
     u64 GetFreeSize() const {
-        return size_bytes - offset - mapped_size;
+        return size_bytes - offset.load(std::memory_order_relaxed);
+    }
+
+    /// Returns true when a request of this size can be served by the current allocation.
+    [[nodiscard]] bool CanFit(u64 size) const noexcept {
+        return size <= size_bytes;
+    }
+
+    /// Records a request that was served outside of the stream buffer. Schedules growth to its
+    /// size for the next submit, if the cap allows it.
+    void RecordFallback(u64 size);
+
+    [[nodiscard]] const Stats& GetStats() const noexcept {
+        return stats;
     }
 
 private:
-    struct Watch {
-        u64 tick{};
-        u64 upper_bound{};
-    };
+    static constexpr u32 NumSlices = 16;
+    static constexpr u64 InlineThreshold = 4_KB;
+
+    [[nodiscard]] u32 SliceOf(u64 buffer_offset) const noexcept {
+        return static_cast<u32>(buffer_offset / slice_size);
+    }
+
+    /// Lock-free suballocation for small data that fits in the slice currently written.
+    std::optional<u64> TryCopyInline(const void* src, u64 size, u64 alignment);
+
+    /// Makes sure slices in the provided range are no longer in use by the GPU.
+    /// Schedules growth for the next safe point when it had to wait.
+    void AcquireSlices(u64 begin, u64 end);
+
+    /// Asks for the buffer to grow to at least min_size once the current batch is submitted.
+    void RequestGrow(u64 min_size);
 
-    /// Increases the amount of watches available.
-    void ReserveWatches(std::vector<Watch>& watches, std::size_t grow_size);
+    /// Replaces the backing buffer with a larger one. Old memory is released once the GPU is done.
+    void Grow(u64 min_size);
 
-    /// Waits pending watches until requested upper bound.
-    void WaitPendingOperations(u64 requested_upper_bound);
+    /// Marks the slices of the provided range as used by the current tick.
+    void MarkSlices(u64 begin, u64 end);
 
 private:
-    u64 offset{};
+    vk::BufferUsageFlags usage_flags;
+    u64 max_size_bytes{};
+    u64 slice_size{};
+    std::atomic<u64> offset{};
+    u64 mapped_offset{};
     u64 mapped_size{};
-    std::vector<Watch> current_watches;
-    std::size_t current_watch_cursor{};
-    std::optional<size_t> invalidation_mark;
-    std::vector<Watch> previous_watches;
-    std::size_t wait_cursor{};
-    u64 wait_bound{};
+    std::atomic<u32> current_slice{};
+    u64 pending_grow_size{};
+    u64 grow_request_tick{};
+    std::array<std::atomic<u64>, NumSlices> slice_ticks{};
+    Stats stats{};
 };
 
 } // namespace VideoCore
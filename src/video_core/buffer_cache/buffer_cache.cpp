@@ -2,32 +2,49 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <optional>
+#include <tuple>
 #include "common/alignment.h"
 #include "common/scope_exit.h"
 #include "common/types.h"
+#include "core/memory.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/buffer_cache/buffer_cache.h"
+#include "video_core/renderer_vulkan/liverpool_to_vk.h"
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/texture_cache/texture_cache.h"
 
+#include <vk_mem_alloc.h>
+
 namespace VideoCore {
 
 static constexpr size_t DataShareBufferSize = 64_KB;
-static constexpr size_t StagingBufferSize = 512_MB;
-static constexpr size_t UboStreamBufferSize = 128_MB;
+static constexpr size_t StagingBufferSize = 128_MB;
+static constexpr size_t MaxStagingBufferSize = 512_MB;
+static constexpr size_t UboStreamBufferSize = 32_MB;
+static constexpr size_t MaxUboStreamBufferSize = 128_MB;
+static constexpr u32 MinQuadIndexBufferQuads = 4096;
 
 BufferCache::BufferCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                          AmdGpu::Liverpool* liverpool_, TextureCache& texture_cache_,
                          PageManager& tracker_)
     : instance{instance_}, scheduler{scheduler_}, liverpool{liverpool_},
       texture_cache{texture_cache_}, tracker{tracker_},
-      staging_buffer{instance, scheduler, MemoryUsage::Upload, StagingBufferSize},
-      stream_buffer{instance, scheduler, MemoryUsage::Stream, UboStreamBufferSize},
-      gds_buffer{instance, scheduler, MemoryUsage::Stream, 0, AllFlags, DataShareBufferSize},
+      staging_buffer{instance, scheduler, MemoryUsage::Upload, StagingBufferSize,
+                     MaxStagingBufferSize},
+      stream_buffer{instance, scheduler, MemoryUsage::Stream, UboStreamBufferSize,
+                    MaxUboStreamBufferSize},
+      gds_buffer{instance, scheduler, MemoryUsage::DeviceLocal, 0, AllFlags, DataShareBufferSize},
+      gds_readback_buffer{instance, scheduler, MemoryUsage::Download, 0,
+                          vk::BufferUsageFlagBits::eTransferDst, DataShareBufferSize},
       memory_tracker{&tracker} {
     Vulkan::SetObjectName(instance.GetDevice(), gds_buffer.Handle(), "GDS Buffer");
+    Vulkan::SetObjectName(instance.GetDevice(), gds_readback_buffer.Handle(),
+                          "GDS Readback Buffer");
 
     // Ensure the first slot is used for the null buffer
     const auto null_id =
@@ -69,16 +86,34 @@ void BufferCache::DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 si
     if (total_size_bytes == 0) {
         return;
     }
-    const auto [staging, offset] = staging_buffer.Map(total_size_bytes);
+    u8* staging{};
+    u64 offset{};
+    vk::Buffer dst_buffer{};
+    std::optional<Buffer> temp_buffer;
+    if (staging_buffer.CanFit(total_size_bytes)) {
+        std::tie(staging, offset) = staging_buffer.Map(total_size_bytes);
+        staging_buffer.Commit();
+        dst_buffer = staging_buffer.Handle();
+    } else {
+        // Too large for the staging buffer in this batch, read back through a temporary one.
+        staging_buffer.RecordFallback(total_size_bytes);
+        temp_buffer.emplace(instance, scheduler, MemoryUsage::Download, 0,
+                            vk::BufferUsageFlagBits::eTransferDst, total_size_bytes);
+        staging = temp_buffer->mapped_data.data();
+        dst_buffer = temp_buffer->Handle();
+    }
     for (auto& copy : copies) {
         // Modify copies to have the staging offset in mind
         copy.dstOffset += offset;
     }
-    staging_buffer.Commit();
     scheduler.EndRendering();
     const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.copyBuffer(buffer.buffer, staging_buffer.Handle(), copies);
+    cmdbuf.copyBuffer(buffer.buffer, dst_buffer, copies);
     scheduler.Finish();
+    if (temp_buffer && !temp_buffer->is_coherent) {
+        vmaInvalidateAllocation(instance.GetAllocator(), temp_buffer->buffer.allocation, 0,
+                                total_size_bytes);
+    }
     for (const auto& copy : copies) {
         const VAddr copy_device_addr = buffer.CpuAddr() + copy.srcOffset;
         const u64 dst_offset = copy.dstOffset - offset;
@@ -92,10 +127,11 @@ void BufferCache::BindVertexBuffers(const Vulkan::GraphicsPipeline& pipeline) {
     Vulkan::VertexInputs<AmdGpu::Buffer> guest_buffers;
     pipeline.GetVertexInputs(attributes, bindings, guest_buffers);
 
+    auto& state_tracker = scheduler.GetStateTracker();
     if (instance.IsVertexInputDynamicState()) {
         // Update current vertex inputs.
-        const auto cmdbuf = scheduler.CommandBuffer();
-        cmdbuf.setVertexInputEXT(bindings, attributes);
+        state_tracker.SetVertexInput({bindings.data(), bindings.size()},
+                                     {attributes.data(), attributes.size()});
     }
 
     if (bindings.empty()) {
@@ -172,13 +208,14 @@ void BufferCache::BindVertexBuffers(const Vulkan::GraphicsPipeline& pipeline) {
         host_strides.push_back(buffer.GetStride());
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
     const auto num_buffers = guest_buffers.size();
     if (instance.IsVertexInputDynamicState()) {
-        cmdbuf.bindVertexBuffers(0, num_buffers, host_buffers.data(), host_offsets.data());
+        state_tracker.BindVertexBuffers({host_buffers.data(), num_buffers},
+                                        {host_offsets.data(), num_buffers});
     } else {
-        cmdbuf.bindVertexBuffers2EXT(0, num_buffers, host_buffers.data(), host_offsets.data(),
-                                     host_sizes.data(), host_strides.data());
+        state_tracker.BindVertexBuffers(
+            {host_buffers.data(), num_buffers}, {host_offsets.data(), num_buffers},
+            {host_sizes.data(), num_buffers}, {host_strides.data(), num_buffers});
     }
 }
 
@@ -196,8 +233,58 @@ void BufferCache::BindIndexBuffer(u32 index_offset) {
     // Bind index buffer.
     const u32 index_buffer_size = regs.num_indices * index_size;
     const auto [vk_buffer, offset] = ObtainBuffer(index_address, index_buffer_size, false);
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.bindIndexBuffer(vk_buffer->Handle(), offset, index_type);
+    scheduler.GetStateTracker().BindIndexBuffer(vk_buffer->Handle(), offset, index_type);
+}
+
+u32 BufferCache::BindQuadListIndexBuffer(bool is_indexed, u32 index_offset) {
+    const auto& regs = liverpool->regs;
+    const u32 num_vertices = regs.num_indices;
+    const u32 num_indices = Vulkan::LiverpoolToVK::NumQuadListTriangleIndices(num_vertices);
+    auto& state_tracker = scheduler.GetStateTracker();
+
+    if (!is_indexed) {
+        // Sequential quads always expand to the same indices, so keep them around in a buffer
+        // that only grows when a bigger draw comes in.
+        const u32 num_quads = num_vertices / 4;
+        if (!quad_index_buffer || num_quads > quad_index_capacity) {
+            const u32 capacity = std::max(std::bit_ceil(num_quads), MinQuadIndexBufferQuads);
+            if (quad_index_buffer) {
+                scheduler.DeferAsyncOperation(
+                    [buffer = std::move(*quad_index_buffer)]() mutable {});
+            }
+            quad_index_buffer.emplace(instance, scheduler, MemoryUsage::Stream, 0,
+                                      vk::BufferUsageFlagBits::eIndexBuffer,
+                                      capacity * 6 * sizeof(u32));
+            Vulkan::SetObjectName(instance.GetDevice(), quad_index_buffer->Handle(),
+                                  "Quad List Index Buffer");
+            Vulkan::LiverpoolToVK::EmitQuadToTriangleListIndices(
+                reinterpret_cast<u32*>(quad_index_buffer->mapped_data.data()), capacity * 4);
+            quad_index_capacity = capacity;
+        }
+        state_tracker.BindIndexBuffer(quad_index_buffer->Handle(), 0, vk::IndexType::eUint32);
+        return num_indices;
+    }
+
+    // Expand the guest indices into the stream buffer, they are known to be CPU visible.
+    const bool is_index16 =
+        regs.index_buffer_type.index_type == AmdGpu::Liverpool::IndexType::Index16;
+    const vk::IndexType index_type = is_index16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+    const u32 index_size = is_index16 ? sizeof(u16) : sizeof(u32);
+    const VAddr index_address =
+        regs.index_base_address.Address<VAddr>() + index_offset * index_size;
+    const auto [data, offset] = stream_buffer.Map(num_indices * index_size, index_size);
+    if (is_index16) {
+        Vulkan::LiverpoolToVK::ConvertQuadToTriangleListIndices(
+            reinterpret_cast<u16*>(data), reinterpret_cast<const u16*>(index_address),
+            num_vertices);
+    } else {
+        Vulkan::LiverpoolToVK::ConvertQuadToTriangleListIndices(
+            reinterpret_cast<u32*>(data), reinterpret_cast<const u32*>(index_address),
+            num_vertices);
+    }
+    stream_buffer.Commit();
+    state_tracker.BindIndexBuffer(stream_buffer.Handle(), offset, index_type);
+    return num_indices;
 }
 
 void BufferCache::InlineData(VAddr address, const void* value, u32 num_bytes, bool is_gds) {
@@ -246,6 +333,122 @@ void BufferCache::InlineData(VAddr address, const void* value, u32 num_bytes, bo
     });
 }
 
+void BufferCache::CopyGdsToMemory(VAddr address, u32 gds_offset, u32 num_bytes) {
+    ASSERT_MSG(gds_offset % 4 == 0 && gds_offset + num_bytes <= DataShareBufferSize,
+               "Invalid GDS range {:#x}+{:#x}", gds_offset, num_bytes);
+    if (!IsRegionRegistered(address, num_bytes)) {
+        // Nothing on the GPU consumes this range, the guest can only observe it from the CPU.
+        ReadGds(gds_offset, std::bit_cast<void*>(address), num_bytes);
+        return;
+    }
+    // Guest CPU reads and WaitRegMem polls observe the value in guest memory, so keep it
+    // current like the other label writes. The backing is written directly to not fault on
+    // the tracked pages, the cached buffer receives the same data with the copy below.
+    boost::container::small_vector<u8, 64> data(num_bytes);
+    ReadGds(gds_offset, data.data(), num_bytes);
+    auto* memory = Core::Memory::Instance();
+    if (!memory->TryWriteBacking(std::bit_cast<void*>(address), data.data(), num_bytes)) {
+        std::memcpy(std::bit_cast<void*>(address), data.data(), num_bytes);
+    }
+
+    const BufferId buffer_id = FindBuffer(address, num_bytes);
+    Buffer& buffer = slot_buffers[buffer_id];
+    CopyBufferOrdered(gds_buffer.Handle(), gds_offset, buffer.Handle(), buffer.Offset(address),
+                      num_bytes);
+    memory_tracker.MarkRegionAsGpuModified(address, num_bytes);
+    gpu_modified_ranges.Add(address, num_bytes);
+}
+
+void BufferCache::CopyMemoryToGds(u32 gds_offset, VAddr address, u32 num_bytes) {
+    ASSERT_MSG(gds_offset % 4 == 0 && gds_offset + num_bytes <= DataShareBufferSize,
+               "Invalid GDS range {:#x}+{:#x}", gds_offset, num_bytes);
+    if (!IsRegionGpuModified(address, num_bytes)) {
+        // Guest memory holds the latest contents, upload them inline.
+        InlineData(gds_offset, std::bit_cast<const void*>(address), num_bytes, true);
+        return;
+    }
+    const auto [buffer, offset] = ObtainBuffer(address, num_bytes, false);
+    CopyBufferOrdered(buffer->Handle(), offset, gds_buffer.Handle(), gds_offset, num_bytes);
+}
+
+void BufferCache::ReadGds(u32 gds_offset, void* data, u32 num_bytes) {
+    ASSERT_MSG(gds_offset + num_bytes <= DataShareBufferSize, "Invalid GDS range {:#x}+{:#x}",
+               gds_offset, num_bytes);
+    CopyBufferOrdered(gds_buffer.Handle(), gds_offset, gds_readback_buffer.Handle(), gds_offset,
+                      num_bytes);
+    // Make the copy visible to host reads of the mapped memory.
+    const vk::BufferMemoryBarrier2 host_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eHost,
+        .dstAccessMask = vk::AccessFlagBits2::eHostRead,
+        .buffer = gds_readback_buffer.Handle(),
+        .offset = gds_offset,
+        .size = num_bytes,
+    };
+    scheduler.CommandBuffer().pipelineBarrier2(vk::DependencyInfo{
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &host_barrier,
+    });
+    scheduler.Finish();
+    if (!gds_readback_buffer.is_coherent) {
+        vmaInvalidateAllocation(instance.GetAllocator(), gds_readback_buffer.buffer.allocation,
+                                gds_offset, num_bytes);
+    }
+    std::memcpy(data, gds_readback_buffer.mapped_data.data() + gds_offset, num_bytes);
+}
+
+void BufferCache::CopyBufferOrdered(vk::Buffer src, u64 src_offset, vk::Buffer dst,
+                                    u64 dst_offset, u32 num_bytes) {
+    scheduler.EndRendering();
+    const auto cmdbuf = scheduler.CommandBuffer();
+    const std::array pre_barriers = {
+        vk::BufferMemoryBarrier2{
+            .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
+            .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+            .buffer = src,
+            .offset = src_offset,
+            .size = num_bytes,
+        },
+        vk::BufferMemoryBarrier2{
+            .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .srcAccessMask = vk::AccessFlagBits2::eMemoryRead,
+            .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+            .buffer = dst,
+            .offset = dst_offset,
+            .size = num_bytes,
+        },
+    };
+    const vk::BufferMemoryBarrier2 post_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
+        .buffer = dst,
+        .offset = dst_offset,
+        .size = num_bytes,
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+        .bufferMemoryBarrierCount = static_cast<u32>(pre_barriers.size()),
+        .pBufferMemoryBarriers = pre_barriers.data(),
+    });
+    const vk::BufferCopy copy = {
+        .srcOffset = src_offset,
+        .dstOffset = dst_offset,
+        .size = num_bytes,
+    };
+    cmdbuf.copyBuffer(src, dst, copy);
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &post_barrier,
+    });
+}
+
 std::pair<Buffer*, u32> BufferCache::ObtainBuffer(VAddr device_addr, u32 size, bool is_written,
                                                   bool is_texel_buffer, BufferId buffer_id) {
     // For small uniform buffers that have not been modified by gpu
@@ -286,6 +489,11 @@ std::pair<Buffer*, u32> BufferCache::ObtainViewBuffer(VAddr gpu_addr, u32 size,
     if (prefer_gpu && memory_tracker.IsRegionGpuModified(gpu_addr, size)) {
         return ObtainBuffer(gpu_addr, size, false, false);
     }
+    // Requests too large for the staging buffer go through a cached buffer instead.
+    if (!staging_buffer.CanFit(size)) {
+        staging_buffer.RecordFallback(size);
+        return ObtainBuffer(gpu_addr, size, false, false);
+    }
     // In all other cases, just do a CPU copy to the staging buffer.
     const u32 offset = staging_buffer.Copy(gpu_addr, size, 16);
     return {&staging_buffer, offset};
@@ -534,9 +742,10 @@ void BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size,
     if (total_size_bytes == 0) {
         return;
     }
-    vk::Buffer src_buffer = staging_buffer.Handle();
-    if (total_size_bytes < StagingBufferSize) {
+    vk::Buffer src_buffer{};
+    if (staging_buffer.CanFit(total_size_bytes)) {
         const auto [staging, offset] = staging_buffer.Map(total_size_bytes);
+        src_buffer = staging_buffer.Handle();
         for (auto& copy : copies) {
             u8* const src_pointer = staging + copy.srcOffset;
             const VAddr device_addr = buffer.CpuAddr() + copy.dstOffset;
@@ -548,6 +757,7 @@ void BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size,
     } else {
         // For large one time transfers use a temporary host buffer.
         // RenderDoc can lag quite a bit if the stream buffer is too large.
+        staging_buffer.RecordFallback(total_size_bytes);
         Buffer temp_buffer{instance,
                            scheduler,
                            MemoryUsage::Upload,
@@ -561,7 +771,7 @@ void BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size,
             const VAddr device_addr = buffer.CpuAddr() + copy.dstOffset;
             std::memcpy(src_pointer, std::bit_cast<const u8*>(device_addr), copy.size);
         }
-        scheduler.DeferOperation([buffer = std::move(temp_buffer)]() mutable {});
+        scheduler.DeferAsyncOperation([buffer = std::move(temp_buffer)]() mutable {});
     }
     scheduler.EndRendering();
     const auto cmdbuf = scheduler.CommandBuffer();
@@ -648,6 +858,21 @@ bool BufferCache::SynchronizeBufferFromImage(Buffer& buffer, VAddr device_addr,
     }
     if (!copies.empty()) {
         scheduler.EndRendering();
+
+        // Images rendered at the internal resolution are read back through a copy at guest
+        // resolution.
+        std::optional<Image> native_image;
+        if (image.info.IsScaled()) {
+            auto native_info = image.info;
+            native_info.resolution_scale = 1.0f;
+            native_image.emplace(instance, scheduler, native_info);
+            native_image->aspect_mask = image.aspect_mask;
+            image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead,
+                          {});
+            native_image->CopyImage(image);
+        }
+        auto& src_image = native_image ? *native_image : image;
+
         const vk::BufferMemoryBarrier2 pre_barrier = {
             .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
             .srcAccessMask = vk::AccessFlagBits2::eMemoryRead,
@@ -666,9 +891,9 @@ bool BufferCache::SynchronizeBufferFromImage(Buffer& buffer, VAddr device_addr,
             .offset = max_offset - size,
             .size = size,
         };
-        auto barriers = image.GetBarriers(vk::ImageLayout::eTransferSrcOptimal,
-                                          vk::AccessFlagBits2::eTransferRead,
-                                          vk::PipelineStageFlagBits2::eTransfer, {});
+        auto barriers = src_image.GetBarriers(vk::ImageLayout::eTransferSrcOptimal,
+                                              vk::AccessFlagBits2::eTransferRead,
+                                              vk::PipelineStageFlagBits2::eTransfer, {});
         const auto cmdbuf = scheduler.CommandBuffer();
         cmdbuf.pipelineBarrier2(vk::DependencyInfo{
             .dependencyFlags = vk::DependencyFlagBits::eByRegion,
@@ -677,13 +902,16 @@ bool BufferCache::SynchronizeBufferFromImage(Buffer& buffer, VAddr device_addr,
             .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
             .pImageMemoryBarriers = barriers.data(),
         });
-        cmdbuf.copyImageToBuffer(image.image, vk::ImageLayout::eTransferSrcOptimal, buffer.Handle(),
-                                 copies);
+        cmdbuf.copyImageToBuffer(src_image.image, vk::ImageLayout::eTransferSrcOptimal,
+                                 buffer.Handle(), copies);
         cmdbuf.pipelineBarrier2(vk::DependencyInfo{
             .dependencyFlags = vk::DependencyFlagBits::eByRegion,
             .bufferMemoryBarrierCount = 1,
             .pBufferMemoryBarriers = &post_barrier,
         });
+        if (native_image) {
+            scheduler.DeferAsyncOperation([native = std::move(*native_image)] {});
+        }
     }
     return true;
 }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <optional>
 #include <shared_mutex>
 #include <boost/container/small_vector.hpp>
 #include "common/div_ceil.h"
@@ -63,7 +64,7 @@ public:
                          PageManager& tracker);
     ~BufferCache();
 
-    /// Returns a pointer to GDS device local buffer.
+    /// Returns a pointer to GDS device local buffer. Not host visible, use ReadGds to read it.
     [[nodiscard]] const Buffer* GetGdsBuffer() const noexcept {
         return &gds_buffer;
     }
@@ -87,9 +88,22 @@ public:
     /// Bind host index buffer for the current draw.
     void BindIndexBuffer(u32 index_offset);
 
+    /// Binds a triangle list index buffer that draws the current quad list draw as pairs of
+    /// triangles. Returns the number of indices to draw.
+    u32 BindQuadListIndexBuffer(bool is_indexed, u32 index_offset);
+
     /// Writes a value to GPU buffer.
     void InlineData(VAddr address, const void* value, u32 num_bytes, bool is_gds);
 
+    /// Copies a GDS range to guest memory in GPU order.
+    void CopyGdsToMemory(VAddr address, u32 gds_offset, u32 num_bytes);
+
+    /// Copies guest memory to a GDS range in GPU order.
+    void CopyMemoryToGds(u32 gds_offset, VAddr address, u32 num_bytes);
+
+    /// Reads a GDS range back to the host. Waits for all submitted GPU work.
+    void ReadGds(u32 gds_offset, void* data, u32 num_bytes);
+
     /// Obtains a buffer for the specified region.
     [[nodiscard]] std::pair<Buffer*, u32> ObtainBuffer(VAddr gpu_addr, u32 size, bool is_written,
                                                        bool is_texel_buffer = false,
@@ -149,6 +163,9 @@ private:
 
     void DeleteBuffer(BufferId buffer_id);
 
+    void CopyBufferOrdered(vk::Buffer src, u64 src_offset, vk::Buffer dst, u64 dst_offset,
+                           u32 num_bytes);
+
     const Vulkan::Instance& instance;
     Vulkan::Scheduler& scheduler;
     AmdGpu::Liverpool* liverpool;
@@ -157,6 +174,9 @@ private:
     StreamBuffer staging_buffer;
     StreamBuffer stream_buffer;
     Buffer gds_buffer;
+    Buffer gds_readback_buffer;
+    std::optional<Buffer> quad_index_buffer;
+    u32 quad_index_capacity{};
     std::shared_mutex mutex;
     Common::SlotVector<Buffer> slot_buffers;
     RangeSet gpu_modified_ranges;
@@ -4,6 +4,7 @@
 set(SOURCE_FILE ${CMAKE_ARGV3})
 set(HEADER_FILE ${CMAKE_ARGV4})
 set(INPUT_FILE ${CMAKE_ARGV5})
+set(SPIRV_INCLUDE ${CMAKE_ARGV6})
 
 get_filename_component(CONTENTS_NAME ${SOURCE_FILE} NAME)
 string(REPLACE "." "_" CONTENTS_NAME ${CONTENTS_NAME})
@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#version 450
+
+layout (location = 0) out vec4 color;
+
+layout (binding = 0) uniform sampler2DMS src;
+
+layout (push_constant) uniform params {
+    int num_samples;
+} pc;
+
+void main() {
+    const ivec2 coord = ivec2(gl_FragCoord.xy);
+    vec4 sum = vec4(0.0);
+    for (int i = 0; i < pc.num_samples; ++i) {
+        sum += texelFetch(src, coord, i);
+    }
+    color = sum / float(pc.num_samples);
+}
@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+
+#include "common/assert.h"
+#include "common/hash.h"
+#include "core/memory.h"
+#include "shader_recompiler/backend/spirv/emit_spirv.h"
+#include "shader_recompiler/info.h"
+#include "video_core/renderer_null/null_rasterizer.h"
+
+namespace Null {
+
+using Liverpool = AmdGpu::Liverpool;
+using Shader::LogicalStage;
+using Shader::Stage;
+
+Rasterizer::Rasterizer(AmdGpu::Liverpool* liverpool_)
+    : liverpool{liverpool_}, memory{Core::Memory::Instance()} {
+    // Describes a typical desktop GPU, there is no device to query.
+    profile = Shader::Profile{
+        .supported_spirv = 0x00010600U,
+        .subgroup_size = 64,
+        .support_fp32_denorm_preserve = true,
+        .support_fp32_denorm_flush = true,
+        .support_explicit_workgroup_layout = true,
+        .supports_image_load_store_lod = true,
+        .supports_robust_buffer_access = true,
+        .max_ubo_size = 64_KB,
+        .max_viewport_width = 16384,
+        .max_viewport_height = 16384,
+        .max_shared_memory_size = 64_KB,
+    };
+    liverpool->BindRasterizer(this);
+    memory->SetRasterizer(this);
+}
+
+Rasterizer::~Rasterizer() {
+    LOG_INFO(Render, "Null renderer: {} draws, {} dispatches, {} pipelines, {} shaders",
+             stats.draws.load(), stats.dispatches.load(), stats.pipelines.load(),
+             stats.shaders.load());
+}
+
+void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
+    ++stats.draws;
+    RefreshGraphicsKey();
+}
+
+void Rasterizer::DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u32 size,
+                              u32 max_count, VAddr count_address) {
+    ++stats.draws;
+    RefreshGraphicsKey();
+}
+
+void Rasterizer::DispatchDirect() {
+    ++stats.dispatches;
+    RefreshComputeKey();
+}
+
+void Rasterizer::DispatchIndirect(VAddr address, u32 offset, u32 size) {
+    ++stats.dispatches;
+    RefreshComputeKey();
+}
+
+void Rasterizer::InlineData(VAddr address, const void* value, u32 num_bytes, bool is_gds) {
+    ++stats.inline_writes;
+    if (is_gds) {
+        ASSERT(address + num_bytes <= gds.size());
+        std::memcpy(gds.data() + address, value, num_bytes);
+        return;
+    }
+    WriteMemory(address, value, num_bytes);
+}
+
+void Rasterizer::CopyGdsToMemory(VAddr address, u32 gds_offset, u32 num_bytes) {
+    ASSERT(gds_offset + num_bytes <= gds.size());
+    WriteMemory(address, gds.data() + gds_offset, num_bytes);
+}
+
+void Rasterizer::CopyMemoryToGds(u32 gds_offset, VAddr address, u32 num_bytes) {
+    ASSERT(gds_offset + num_bytes <= gds.size());
+    std::memcpy(gds.data() + gds_offset, reinterpret_cast<const void*>(address), num_bytes);
+}
+
+u32 Rasterizer::ReadDataFromGds(u32 gds_offset) {
+    ASSERT(gds_offset + sizeof(u32) <= gds.size());
+    u32 value;
+    std::memcpy(&value, gds.data() + gds_offset, sizeof(u32));
+    return value;
+}
+
+bool Rasterizer::InvalidateMemory(VAddr addr, u64 size) {
+    if (!IsMapped(addr, size)) {
+        return false;
+    }
+    ++stats.invalidations;
+    liverpool->NotifyMemoryWrite(addr, size);
+    return true;
+}
+
+bool Rasterizer::IsMapped(VAddr addr, u64 size) {
+    if (size == 0) {
+        return false;
+    }
+    std::scoped_lock lk{mapped_mutex};
+    return mapped_ranges.find(boost::icl::interval<VAddr>::right_open(addr, addr + size)) !=
+           mapped_ranges.end();
+}
+
+void Rasterizer::MapMemory(VAddr addr, u64 size) {
+    std::scoped_lock lk{mapped_mutex};
+    mapped_ranges += boost::icl::interval<VAddr>::right_open(addr, addr + size);
+}
+
+void Rasterizer::UnmapMemory(VAddr addr, u64 size) {
+    std::scoped_lock lk{mapped_mutex};
+    mapped_ranges -= boost::icl::interval<VAddr>::right_open(addr, addr + size);
+}
+
+void Rasterizer::CpSync() {
+    ++stats.cp_syncs;
+}
+
+u64 Rasterizer::Flush() {
+    return flush_tick.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Rasterizer::RefreshGraphicsKey() {
+    const auto& regs = liverpool->regs;
+    u64 key = regs.stage_enable.raw;
+    for (u32 stage_idx = 0; stage_idx < static_cast<u32>(Stage::Compute); ++stage_idx) {
+        if (!regs.stage_enable.IsStageEnabled(stage_idx)) {
+            continue;
+        }
+        const auto* pgm = regs.ProgramForStage(stage_idx);
+        if (!pgm || !pgm->Address<u32*>() || !Liverpool::GetBinaryInfo(*pgm).Valid()) {
+            continue;
+        }
+        const auto params = Liverpool::GetParams(*pgm);
+        key = HashCombine(key, params.hash);
+
+        // Only the plain vertex pipeline has enough state in registers to be recompiled
+        // without the runtime info the pipeline cache derives from the full graphics key.
+        if (regs.stage_enable.raw != Liverpool::ShaderStageEnable::VgtStages::Vs) {
+            continue;
+        }
+        const auto stage = static_cast<Stage>(stage_idx);
+        Shader::RuntimeInfo runtime_info{};
+        runtime_info.Initialize(stage);
+        runtime_info.num_user_data = pgm->settings.num_user_regs;
+        runtime_info.num_input_vgprs = pgm->settings.vgpr_comp_cnt;
+        runtime_info.num_allocated_vgprs = pgm->NumVgprs();
+        runtime_info.fp_denorm_mode32 = pgm->settings.fp_denorm_mode32;
+        runtime_info.fp_round_mode32 = pgm->settings.fp_round_mode32;
+        if (stage == Stage::Fragment) {
+            runtime_info.fs_info.en_flags = regs.ps_input_ena;
+            runtime_info.fs_info.addr_flags = regs.ps_input_addr;
+            runtime_info.fs_info.num_inputs = regs.num_interp;
+            for (u32 i = 0; i < regs.num_interp; i++) {
+                const auto& input = regs.ps_inputs[i];
+                runtime_info.fs_info.inputs[i] = {
+                    .param_index = u8(input.input_offset.Value()),
+                    .is_default = bool(input.use_default),
+                    .is_flat = bool(input.flat_shade),
+                    .default_value = u8(input.default_value),
+                };
+            }
+        }
+        const auto l_stage =
+            stage == Stage::Fragment ? LogicalStage::Fragment : LogicalStage::Vertex;
+        CompileProgram(stage, l_stage, params, runtime_info);
+    }
+    if (pipeline_keys.insert(key).second) {
+        ++stats.pipelines;
+    }
+}
+
+void Rasterizer::RefreshComputeKey() {
+    const auto& cs_pgm = liverpool->GetCsRegs();
+    if (!cs_pgm.Address<u32*>()) {
+        return;
+    }
+    const auto params = Liverpool::GetParams(cs_pgm);
+    if (pipeline_keys.insert(params.hash).second) {
+        ++stats.pipelines;
+    }
+
+    Shader::RuntimeInfo runtime_info{};
+    runtime_info.Initialize(Stage::Compute);
+    runtime_info.num_user_data = cs_pgm.settings.num_user_regs;
+    runtime_info.num_allocated_vgprs = cs_pgm.settings.num_vgprs * 4;
+    runtime_info.cs_info.workgroup_size = {cs_pgm.num_thread_x.full, cs_pgm.num_thread_y.full,
+                                           cs_pgm.num_thread_z.full};
+    runtime_info.cs_info.tgid_enable = {cs_pgm.IsTgidEnabled(0), cs_pgm.IsTgidEnabled(1),
+                                        cs_pgm.IsTgidEnabled(2)};
+    runtime_info.cs_info.shared_memory_size = cs_pgm.SharedMemSize();
+    CompileProgram(Stage::Compute, LogicalStage::Compute, params, runtime_info);
+}
+
+void Rasterizer::CompileProgram(Stage stage, LogicalStage l_stage,
+                                const Shader::ShaderParams& params,
+                                Shader::RuntimeInfo& runtime_info) {
+    if (!program_hashes.insert(params.hash).second) {
+        return;
+    }
+    LOG_INFO(Render, "Compiling {} shader {:#x}", stage, params.hash);
+    Shader::Info info{stage, l_stage, params};
+    Shader::Backend::Bindings binding{};
+    // Nothing is kept after emitting, so the pools live only as long as this compilation.
+    Shader::Pools pools;
+    const auto ir_program =
+        Shader::TranslateProgram(params.code, pools, info, runtime_info, profile);
+    static_cast<void>(
+        Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, ir_program, binding));
+    ++stats.shaders;
+}
+
+void Rasterizer::WriteMemory(VAddr address, const void* data, u32 num_bytes) {
+    auto* ptr = reinterpret_cast<void*>(address);
+    if (!memory->TryWriteBacking(ptr, data, num_bytes)) {
+        std::memcpy(ptr, data, num_bytes);
+    }
+}
+
+} // namespace Null
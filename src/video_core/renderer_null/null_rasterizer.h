@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <boost/icl/interval_set.hpp>
+#include <tsl/robin_set.h>
+
+#include "shader_recompiler/profile.h"
+#include "shader_recompiler/recompiler.h"
+#include "shader_recompiler/runtime_info.h"
+#include "video_core/amdgpu/liverpool.h"
+#include "video_core/rasterizer_interface.h"
+
+namespace Core {
+class MemoryManager;
+}
+
+namespace Null {
+
+/// Backend that accepts GPU work without a host GPU. Commands are counted and shaders are
+/// recompiled the first time they are bound, but nothing is executed and no frame is rendered.
+/// Labels and fences are written by the command processor, so they complete immediately.
+class Rasterizer final : public VideoCore::RasterizerInterface {
+    static constexpr size_t DataShareBufferSize = 64_KB;
+
+public:
+    struct Stats {
+        std::atomic<u64> draws{};         ///< Direct and indirect draws
+        std::atomic<u64> dispatches{};    ///< Direct and indirect dispatches
+        std::atomic<u64> inline_writes{}; ///< Inline data writes to memory or GDS
+        std::atomic<u64> cp_syncs{};      ///< Command processor synchronizations
+        std::atomic<u64> invalidations{}; ///< CPU writes reported to the backend
+        std::atomic<u64> pipelines{};     ///< Distinct pipeline keys seen
+        std::atomic<u64> shaders{};       ///< Programs recompiled
+    };
+
+    explicit Rasterizer(AmdGpu::Liverpool* liverpool);
+    ~Rasterizer() override;
+
+    void Draw(bool is_indexed, u32 index_offset = 0) override;
+    void DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u32 size, u32 max_count,
+                      VAddr count_address) override;
+
+    void DispatchDirect() override;
+    void DispatchIndirect(VAddr address, u32 offset, u32 size) override;
+
+    void ScopeMarkerBegin(const std::string_view& str, bool from_guest = false) override {}
+    void ScopeMarkerEnd(bool from_guest = false) override {}
+    void ScopedMarkerInsert(const std::string_view& str, bool from_guest = false) override {}
+    void ScopedMarkerInsertColor(const std::string_view& str, const u32 color,
+                                 bool from_guest = false) override {}
+
+    void InlineData(VAddr address, const void* value, u32 num_bytes, bool is_gds) override;
+    void CopyGdsToMemory(VAddr address, u32 gds_offset, u32 num_bytes) override;
+    void CopyMemoryToGds(u32 gds_offset, VAddr address, u32 num_bytes) override;
+    u32 ReadDataFromGds(u32 gsd_offset) override;
+    bool InvalidateMemory(VAddr addr, u64 size) override;
+    bool IsMapped(VAddr addr, u64 size) override;
+    void MapMemory(VAddr addr, u64 size) override;
+    void UnmapMemory(VAddr addr, u64 size) override;
+
+    void CpSync() override;
+    u64 Flush() override;
+    void Finish() override {}
+
+    [[nodiscard]] const Stats& GetStats() const noexcept {
+        return stats;
+    }
+
+private:
+    void RefreshGraphicsKey();
+    void RefreshComputeKey();
+
+    /// Recompiles the program once per shader hash, as the pipeline cache would on a miss.
+    void CompileProgram(Shader::Stage stage, Shader::LogicalStage l_stage,
+                        const Shader::ShaderParams& params, Shader::RuntimeInfo& runtime_info);
+
+    /// Writes to guest memory the way the command processor writes labels.
+    void WriteMemory(VAddr address, const void* data, u32 num_bytes);
+
+    AmdGpu::Liverpool* liverpool;
+    Core::MemoryManager* memory;
+    Shader::Profile profile;
+    tsl::robin_set<u64> pipeline_keys;
+    tsl::robin_set<u64> program_hashes;
+    std::array<u8, DataShareBufferSize> gds{};
+    std::mutex mapped_mutex;
+    boost::icl::interval_set<VAddr> mapped_ranges;
+    std::atomic<u64> flush_tick{};
+    Stats stats{};
+};
+
+} // namespace Null
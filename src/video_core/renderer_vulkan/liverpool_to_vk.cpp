@@ -126,6 +126,18 @@ vk::PrimitiveTopology PrimitiveType(AmdGpu::PrimitiveType type) {
     }
 }
 
+void EmitQuadToTriangleListIndices(u32* out_data, u32 num_vertices) {
+    static constexpr u32 NUM_QUAD_VERTICES = 4;
+    for (u32 i = 0; i + NUM_QUAD_VERTICES <= num_vertices; i += NUM_QUAD_VERTICES) {
+        *out_data++ = i;
+        *out_data++ = i + 1;
+        *out_data++ = i + 2;
+        *out_data++ = i;
+        *out_data++ = i + 2;
+        *out_data++ = i + 3;
+    }
+}
+
 vk::PolygonMode PolygonMode(Liverpool::PolygonMode mode) {
     switch (mode) {
     case Liverpool::PolygonMode::Point:
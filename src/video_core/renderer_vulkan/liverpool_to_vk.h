@@ -98,6 +98,29 @@ static inline bool IsFormatStencilCompatible(vk::Format fmt) {
     }
 }
 
+/// Returns the number of triangle list indices a quad list of the given size expands to.
+static inline u32 NumQuadListTriangleIndices(u32 num_vertices) {
+    return num_vertices / 4 * 6;
+}
+
+/// Splits each quad of an indexed quad list into two triangles that share the v0-v2 diagonal.
+template <typename T>
+void ConvertQuadToTriangleListIndices(T* out_data, const T* in_data, u32 num_vertices) {
+    static constexpr u32 NUM_QUAD_VERTICES = 4;
+    for (u32 quad = 0; quad < num_vertices / NUM_QUAD_VERTICES; ++quad) {
+        const T* in_quad = in_data + quad * NUM_QUAD_VERTICES;
+        *out_data++ = in_quad[0];
+        *out_data++ = in_quad[1];
+        *out_data++ = in_quad[2];
+        *out_data++ = in_quad[0];
+        *out_data++ = in_quad[2];
+        *out_data++ = in_quad[3];
+    }
+}
+
+/// Emits the triangle list indices of a non-indexed quad list.
+void EmitQuadToTriangleListIndices(u32* out_data, u32 num_vertices);
+
 static inline vk::Format PromoteFormatToDepth(vk::Format fmt) {
     if (fmt == vk::Format::eR32Sfloat || fmt == vk::Format::eR32Uint) {
         return vk::Format::eD32Sfloat;
@@ -10,10 +10,11 @@
 namespace Vulkan {
 
 ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
-                                 DescriptorHeap& desc_heap, const Shader::Profile& profile,
-                                 vk::PipelineCache pipeline_cache, ComputePipelineKey compute_key_,
-                                 const Shader::Info& info_, vk::ShaderModule module)
-    : Pipeline{instance, scheduler, desc_heap, profile, pipeline_cache, true},
+                                 DescriptorHeap& desc_heap, DescriptorBuffer* desc_buffer,
+                                 const Shader::Profile& profile, vk::PipelineCache pipeline_cache,
+                                 ComputePipelineKey compute_key_, const Shader::Info& info_,
+                                 vk::ShaderModule module)
+    : Pipeline{instance, scheduler, desc_heap, desc_buffer, profile, pipeline_cache, true},
       compute_key{compute_key_} {
     auto& info = stages[int(Shader::LogicalStage::Compute)];
     info = &info_;
@@ -61,12 +62,8 @@ ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
         .size = sizeof(Shader::PushData),
     };
 
-    uses_push_descriptors = binding < instance.MaxPushDescriptors();
-    const auto flags = uses_push_descriptors
-                           ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR
-                           : vk::DescriptorSetLayoutCreateFlagBits{};
     const vk::DescriptorSetLayoutCreateInfo desc_layout_ci = {
-        .flags = flags,
+        .flags = SelectBindingModel(binding),
         .bindingCount = static_cast<u32>(bindings.size()),
         .pBindings = bindings.data(),
     };
@@ -77,6 +74,7 @@ ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
                "Failed to create compute descriptor set layout: {}",
                vk::to_string(descriptor_set_result));
     desc_layout = std::move(descriptor_set);
+    InitBindingModel(binding);
 
     const vk::DescriptorSetLayout set_layout = *desc_layout;
     const vk::PipelineLayoutCreateInfo layout_info = {
@@ -92,6 +90,7 @@ ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
     SetObjectName(device, *pipeline_layout, "Compute PipelineLayout {}", debug_str);
 
     const vk::ComputePipelineCreateInfo compute_pipeline_ci = {
+        .flags = GetBindingModelFlags(),
         .stage = shader_ci,
         .layout = *pipeline_layout,
     };
@@ -31,7 +31,8 @@ struct ComputePipelineKey {
 class ComputePipeline : public Pipeline {
 public:
     ComputePipeline(const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
-                    const Shader::Profile& profile, vk::PipelineCache pipeline_cache,
+                    DescriptorBuffer* desc_buffer, const Shader::Profile& profile,
+                    vk::PipelineCache pipeline_cache,
                     ComputePipelineKey compute_key, const Shader::Info& info,
                     vk::ShaderModule module);
     ~ComputePipeline();
@@ -0,0 +1,197 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/assert.h"
+#include "common/hash.h"
+#include "video_core/renderer_vulkan/vk_descriptor_buffer.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+
+namespace Vulkan {
+
+static constexpr u64 DescriptorBufferSize = 4_MB;
+static constexpr u64 MaxDescriptorBufferSize = 64_MB;
+
+static constexpr vk::BufferUsageFlags DescriptorBufferUsage =
+    vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT |
+    vk::BufferUsageFlagBits::eSamplerDescriptorBufferEXT |
+    vk::BufferUsageFlagBits::eShaderDeviceAddress;
+
+static u64 MaxRingSize(const vk::PhysicalDeviceDescriptorBufferPropertiesEXT& props) {
+    // The ring holds both sampler and resource descriptors, so it is bound by both ranges.
+    // Keep room for the previous allocation to stay alive while the ring grows.
+    return std::min({MaxDescriptorBufferSize, props.maxResourceDescriptorBufferRange,
+                     props.maxSamplerDescriptorBufferRange,
+                     props.resourceDescriptorBufferAddressSpaceSize / 2,
+                     props.samplerDescriptorBufferAddressSpaceSize / 2});
+}
+
+DescriptorBuffer::DescriptorBuffer(const Instance& instance_, Scheduler& scheduler)
+    : instance{instance_}, device{instance.GetDevice()}, usage{DescriptorBufferUsage},
+      buffer{instance,
+             scheduler,
+             VideoCore::MemoryUsage::Stream,
+             std::min(DescriptorBufferSize, MaxRingSize(instance.GetDescriptorBufferProperties())),
+             MaxRingSize(instance.GetDescriptorBufferProperties()),
+             DescriptorBufferUsage} {
+    const auto& props = instance.GetDescriptorBufferProperties();
+    const bool robust = instance.IsRobustBufferAccessSupported();
+    alignment = props.descriptorBufferOffsetAlignment;
+    uniform_buffer_size =
+        robust ? props.robustUniformBufferDescriptorSize : props.uniformBufferDescriptorSize;
+    storage_buffer_size =
+        robust ? props.robustStorageBufferDescriptorSize : props.storageBufferDescriptorSize;
+    sampled_image_size = props.sampledImageDescriptorSize;
+    storage_image_size = props.storageImageDescriptorSize;
+    sampler_size = props.samplerDescriptorSize;
+    ASSERT_MSG(std::max({uniform_buffer_size, storage_buffer_size, sampled_image_size,
+                         storage_image_size, sampler_size}) <= MaxDescriptorSize,
+               "Descriptor sizes exceed {} bytes", MaxDescriptorSize);
+}
+
+DescriptorBuffer::~DescriptorBuffer() = default;
+
+DescriptorBuffer::SetLayout DescriptorBuffer::GetSetLayout(vk::DescriptorSetLayout set_layout,
+                                                           u32 num_bindings) const {
+    SetLayout layout{
+        .size = device.getDescriptorSetLayoutSizeEXT(set_layout),
+    };
+    layout.binding_offsets.reserve(num_bindings);
+    for (u32 binding = 0; binding < num_bindings; binding++) {
+        layout.binding_offsets.push_back(
+            device.getDescriptorSetLayoutBindingOffsetEXT(set_layout, binding));
+    }
+    return layout;
+}
+
+vk::DeviceSize DescriptorBuffer::Commit(const SetLayout& set_layout,
+                                        std::span<const vk::WriteDescriptorSet> set_writes,
+                                        std::span<const vk::DescriptorBufferInfo> buffer_infos,
+                                        std::span<const vk::DeviceAddress> buffer_addresses) {
+    const auto [data, offset] = buffer.Map(set_layout.size, alignment);
+    for (const auto& set_write : set_writes) {
+        ASSERT(set_write.descriptorCount == 1);
+        u8* dst = data + set_layout.binding_offsets[set_write.dstBinding];
+        const auto type = set_write.descriptorType;
+        switch (type) {
+        case vk::DescriptorType::eUniformBuffer:
+        case vk::DescriptorType::eStorageBuffer: {
+            const size_t index = set_write.pBufferInfo - buffer_infos.data();
+            ASSERT(index < buffer_addresses.size());
+            std::memcpy(dst,
+                        GetBufferDescriptor(*set_write.pBufferInfo, buffer_addresses[index], type)
+                            .data(),
+                        DescriptorSize(type));
+            break;
+        }
+        case vk::DescriptorType::eSampler:
+            std::memcpy(dst, GetSamplerDescriptor(set_write.pImageInfo->sampler).data(),
+                        sampler_size);
+            break;
+        case vk::DescriptorType::eSampledImage:
+        case vk::DescriptorType::eStorageImage:
+            GetImageDescriptor(*set_write.pImageInfo, type, dst);
+            break;
+        default:
+            UNREACHABLE_MSG("Unsupported descriptor type {}", vk::to_string(type));
+        }
+    }
+    buffer.Commit();
+    ++stats.sets;
+    return offset;
+}
+
+size_t DescriptorBuffer::BufferKeyHash::operator()(const BufferKey& key) const noexcept {
+    return HashCombine(HashCombine(key.address, key.range), static_cast<u64>(key.type));
+}
+
+size_t DescriptorBuffer::DescriptorSize(vk::DescriptorType type) const noexcept {
+    switch (type) {
+    case vk::DescriptorType::eUniformBuffer:
+        return uniform_buffer_size;
+    case vk::DescriptorType::eStorageBuffer:
+        return storage_buffer_size;
+    case vk::DescriptorType::eSampledImage:
+        return sampled_image_size;
+    case vk::DescriptorType::eStorageImage:
+        return storage_image_size;
+    case vk::DescriptorType::eSampler:
+        return sampler_size;
+    default:
+        return 0;
+    }
+}
+
+const DescriptorBuffer::DescriptorData& DescriptorBuffer::GetBufferDescriptor(
+    const vk::DescriptorBufferInfo& info, vk::DeviceAddress buffer_address,
+    vk::DescriptorType type) {
+    ASSERT_MSG(!info.buffer || buffer_address != 0, "Buffer was created without device address");
+    const vk::DeviceAddress address = info.buffer ? buffer_address + info.offset : 0;
+    const BufferKey key = {
+        .address = address,
+        .range = info.range,
+        .type = type,
+    };
+    if (const auto it = buffer_descriptors.find(key); it != buffer_descriptors.end()) {
+        ++stats.cache_hits;
+        return it->second;
+    }
+    ++stats.cache_misses;
+
+    // Stream buffer offsets change every draw, do not let them accumulate forever.
+    if (buffer_descriptors.size() >= MaxCachedDescriptors) {
+        buffer_descriptors.clear();
+    }
+
+    const vk::DescriptorAddressInfoEXT address_info = {
+        .address = address,
+        .range = info.range,
+    };
+    // A null buffer handle produces a null descriptor.
+    const auto* address_info_ptr = info.buffer ? &address_info : nullptr;
+    const vk::DescriptorGetInfoEXT get_info = {
+        .type = type,
+        .data = type == vk::DescriptorType::eUniformBuffer
+                    ? vk::DescriptorDataEXT{.pUniformBuffer = address_info_ptr}
+                    : vk::DescriptorDataEXT{.pStorageBuffer = address_info_ptr},
+    };
+    DescriptorData descriptor{};
+    device.getDescriptorEXT(get_info, DescriptorSize(type), descriptor.data());
+    return buffer_descriptors.emplace(key, descriptor).first->second;
+}
+
+const DescriptorBuffer::DescriptorData& DescriptorBuffer::GetSamplerDescriptor(
+    vk::Sampler sampler) {
+    const VkSampler key = sampler;
+    if (const auto it = sampler_descriptors.find(key); it != sampler_descriptors.end()) {
+        ++stats.cache_hits;
+        return it->second;
+    }
+    ++stats.cache_misses;
+
+    const vk::DescriptorGetInfoEXT get_info = {
+        .type = vk::DescriptorType::eSampler,
+        .data = vk::DescriptorDataEXT{.pSampler = &sampler},
+    };
+    DescriptorData descriptor{};
+    device.getDescriptorEXT(get_info, sampler_size, descriptor.data());
+    return sampler_descriptors.emplace(key, descriptor).first->second;
+}
+
+void DescriptorBuffer::GetImageDescriptor(const vk::DescriptorImageInfo& info,
+                                          vk::DescriptorType type, u8* out) const {
+    // A null image view produces a null descriptor.
+    const auto* image_info = info.imageView ? &info : nullptr;
+    const vk::DescriptorGetInfoEXT get_info = {
+        .type = type,
+        .data = type == vk::DescriptorType::eSampledImage
+                    ? vk::DescriptorDataEXT{.pSampledImage = image_info}
+                    : vk::DescriptorDataEXT{.pStorageImage = image_info},
+    };
+    device.getDescriptorEXT(get_info, DescriptorSize(type), out);
+}
+
+} // namespace Vulkan
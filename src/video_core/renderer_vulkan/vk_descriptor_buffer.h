@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <boost/container/small_vector.hpp>
+#include <tsl/robin_map.h>
+
+#include "common/types.h"
+#include "video_core/buffer_cache/buffer.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+class Instance;
+class Scheduler;
+
+/// Ring of host visible memory descriptors are written to directly (VK_EXT_descriptor_buffer).
+/// Descriptor sets are suballocated per draw and bound by their offset in the ring.
+class DescriptorBuffer {
+    static constexpr u32 MaxDescriptorSize = 64;
+    static constexpr size_t MaxCachedDescriptors = 16384;
+
+public:
+    struct Stats {
+        u64 sets{};         ///< Descriptor sets written to the ring
+        u64 cache_hits{};   ///< Buffer and sampler descriptors reused from the cache
+        u64 cache_misses{}; ///< Buffer and sampler descriptors fetched from the driver
+    };
+
+    /// Placement of the bindings of a descriptor set layout in the ring.
+    struct SetLayout {
+        vk::DeviceSize size{};
+        boost::container::small_vector<vk::DeviceSize, 32> binding_offsets;
+    };
+
+    explicit DescriptorBuffer(const Instance& instance, Scheduler& scheduler);
+    ~DescriptorBuffer();
+
+    /// Queries the size and binding offsets of a layout created with the descriptor buffer flag.
+    [[nodiscard]] SetLayout GetSetLayout(vk::DescriptorSetLayout set_layout,
+                                         u32 num_bindings) const;
+
+    /// Writes the descriptors of a set to the ring and returns its offset. Buffer writes point
+    /// into buffer_infos, and buffer_addresses holds the device address of each of its buffers.
+    vk::DeviceSize Commit(const SetLayout& set_layout,
+                          std::span<const vk::WriteDescriptorSet> set_writes,
+                          std::span<const vk::DescriptorBufferInfo> buffer_infos,
+                          std::span<const vk::DeviceAddress> buffer_addresses);
+
+    /// Returns the GPU address of the ring, which changes when the ring grows.
+    [[nodiscard]] vk::DeviceAddress Address() const noexcept {
+        return buffer.DeviceAddress();
+    }
+
+    [[nodiscard]] vk::BufferUsageFlags Usage() const noexcept {
+        return usage;
+    }
+
+    [[nodiscard]] const Stats& GetStats() const noexcept {
+        return stats;
+    }
+
+private:
+    using DescriptorData = std::array<u8, MaxDescriptorSize>;
+
+    struct BufferKey {
+        vk::DeviceAddress address;
+        vk::DeviceSize range;
+        vk::DescriptorType type;
+
+        bool operator==(const BufferKey&) const noexcept = default;
+    };
+
+    struct BufferKeyHash {
+        size_t operator()(const BufferKey& key) const noexcept;
+    };
+
+    /// Returns the size of a descriptor of the provided type.
+    [[nodiscard]] size_t DescriptorSize(vk::DescriptorType type) const noexcept;
+
+    /// Fetches a buffer descriptor, reusing previously fetched bytes when possible.
+    const DescriptorData& GetBufferDescriptor(const vk::DescriptorBufferInfo& info,
+                                              vk::DeviceAddress buffer_address,
+                                              vk::DescriptorType type);
+
+    /// Fetches a sampler descriptor, reusing previously fetched bytes when possible.
+    const DescriptorData& GetSamplerDescriptor(vk::Sampler sampler);
+
+    /// Fetches the descriptor of an image from the driver.
+    void GetImageDescriptor(const vk::DescriptorImageInfo& info, vk::DescriptorType type,
+                            u8* out) const;
+
+private:
+    const Instance& instance;
+    vk::Device device;
+    vk::BufferUsageFlags usage;
+    VideoCore::StreamBuffer buffer;
+    vk::DeviceSize alignment;
+    size_t uniform_buffer_size{};
+    size_t storage_buffer_size{};
+    size_t sampled_image_size{};
+    size_t storage_image_size{};
+    size_t sampler_size{};
+    tsl::robin_map<BufferKey, DescriptorData, BufferKeyHash> buffer_descriptors;
+    tsl::robin_map<VkSampler, DescriptorData> sampler_descriptors;
+    Stats stats{};
+};
+
+} // namespace Vulkan
@@ -7,6 +7,7 @@
 #include <boost/container/static_vector.hpp>
 
 #include "common/assert.h"
+#include "common/hash.h"
 #include "shader_recompiler/backend/spirv/emit_spirv_quad_rect.h"
 #include "shader_recompiler/frontend/fetch_shader.h"
 #include "video_core/amdgpu/resource.h"
@@ -30,13 +31,13 @@ static constexpr std::array LogicalStageToStageBit = {
 
 GraphicsPipeline::GraphicsPipeline(
     const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
-    const Shader::Profile& profile, const GraphicsPipelineKey& key_,
-    vk::PipelineCache pipeline_cache, std::span<const Shader::Info*, MaxShaderStages> infos,
+    DescriptorBuffer* desc_buffer, const Shader::Profile& profile, const GraphicsPipelineKey& key_,
+    vk::PipelineCache pipeline_cache_, std::span<const Shader::Info*, MaxShaderStages> infos,
     std::span<const Shader::RuntimeInfo, MaxShaderStages> runtime_infos,
     std::optional<const Shader::Gcn::FetchShaderData> fetch_shader_,
-    std::span<const vk::ShaderModule> modules)
-    : Pipeline{instance, scheduler, desc_heap, profile, pipeline_cache}, key{key_},
-      fetch_shader{std::move(fetch_shader_)} {
+    std::span<const vk::ShaderModule> modules, GraphicsLibraryCache* library_cache)
+    : Pipeline{instance, scheduler, desc_heap, desc_buffer, profile, pipeline_cache_}, key{key_},
+      fetch_shader{std::move(fetch_shader_)}, pipeline_cache{pipeline_cache_} {
     const vk::Device device = instance.GetDevice();
     std::ranges::copy(infos, stages.begin());
     BuildDescSetLayout();
@@ -82,13 +83,13 @@ GraphicsPipeline::GraphicsPipeline(
         prim_restart = false;
     }
     const vk::PipelineInputAssemblyStateCreateInfo input_assembly = {
-        .topology = LiverpoolToVK::PrimitiveType(key.prim_type),
+        .topology = GetPrimitiveTopology(key),
         .primitiveRestartEnable = prim_restart,
     };
     ASSERT_MSG(!prim_restart || key.primitive_restart_index == 0xFFFF ||
                    key.primitive_restart_index == 0xFFFFFFFF,
                "Primitive restart index other than -1 is not supported yet");
-    const bool is_rect_list = key.prim_type == AmdGpu::PrimitiveType::RectList;
+    const bool is_rect_list = key.prim_type == AmdGpu::PrimitiveType::RectList && !key.rect_list_gs;
     const bool is_quad_list = key.prim_type == AmdGpu::PrimitiveType::QuadList;
     const auto& fs_info = runtime_infos[u32(Shader::LogicalStage::Fragment)].fs_info;
     const vk::PipelineTessellationStateCreateInfo tessellation_state = {
@@ -123,7 +124,7 @@ GraphicsPipeline::GraphicsPipeline(
         .pNext = instance.IsDepthClipControlSupported() ? &clip_control : nullptr,
     };
 
-    boost::container::static_vector<vk::DynamicState, 14> dynamic_states = {
+    boost::container::static_vector<vk::DynamicState, 32> dynamic_states = {
         vk::DynamicState::eViewportWithCountEXT,
         vk::DynamicState::eScissorWithCountEXT,
         vk::DynamicState::eBlendConstants,
@@ -133,8 +134,30 @@ GraphicsPipeline::GraphicsPipeline(
         vk::DynamicState::eStencilCompareMask,
         vk::DynamicState::eStencilWriteMask,
         vk::DynamicState::eStencilOpEXT,
+        vk::DynamicState::eCullModeEXT,
+        vk::DynamicState::eFrontFaceEXT,
+        vk::DynamicState::ePrimitiveTopologyEXT,
+        vk::DynamicState::eDepthTestEnableEXT,
+        vk::DynamicState::eDepthWriteEnableEXT,
+        vk::DynamicState::eDepthCompareOpEXT,
+        vk::DynamicState::eDepthBoundsTestEnableEXT,
+        vk::DynamicState::eStencilTestEnableEXT,
     };
 
+    if (instance.IsExtendedDynamicState2Supported()) {
+        dynamic_states.push_back(vk::DynamicState::eDepthBiasEnableEXT);
+        dynamic_states.push_back(vk::DynamicState::ePrimitiveRestartEnableEXT);
+    }
+    if (instance.IsDynamicPolygonModeSupported()) {
+        dynamic_states.push_back(vk::DynamicState::ePolygonModeEXT);
+    }
+    if (instance.IsDynamicRasterizationSamplesSupported()) {
+        dynamic_states.push_back(vk::DynamicState::eRasterizationSamplesEXT);
+    }
+    if (instance.IsDynamicColorBlendSupported()) {
+        dynamic_states.push_back(vk::DynamicState::eColorBlendEnableEXT);
+        dynamic_states.push_back(vk::DynamicState::eColorBlendEquationEXT);
+    }
     if (instance.IsDynamicColorWriteMaskSupported()) {
         dynamic_states.push_back(vk::DynamicState::eColorWriteMaskEXT);
     }
@@ -174,6 +197,13 @@ GraphicsPipeline::GraphicsPipeline(
             .module = modules[stage],
             .pName = "main",
         });
+    } else if (key.rect_list_gs) {
+        auto gs = Shader::Backend::SPIRV::EmitAuxilaryShader(AuxShaderType::RectListGS, fs_info);
+        shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
+            .stage = vk::ShaderStageFlagBits::eGeometry,
+            .module = CompileSPV(gs, instance.GetDevice()),
+            .pName = "main",
+        });
     }
     stage = u32(Shader::LogicalStage::TessellationControl);
     if (infos[stage]) {
@@ -184,7 +214,7 @@ GraphicsPipeline::GraphicsPipeline(
         });
     } else if (is_rect_list || is_quad_list) {
         const auto type = is_quad_list ? AuxShaderType::QuadListTCS : AuxShaderType::RectListTCS;
-        auto tcs = Shader::Backend::SPIRV::EmitAuxilaryTessShader(type, fs_info);
+        auto tcs = Shader::Backend::SPIRV::EmitAuxilaryShader(type, fs_info);
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eTessellationControl,
             .module = CompileSPV(tcs, instance.GetDevice()),
@@ -200,7 +230,7 @@ GraphicsPipeline::GraphicsPipeline(
         });
     } else if (is_rect_list || is_quad_list) {
         auto tes =
-            Shader::Backend::SPIRV::EmitAuxilaryTessShader(AuxShaderType::PassthroughTES, fs_info);
+            Shader::Backend::SPIRV::EmitAuxilaryShader(AuxShaderType::PassthroughTES, fs_info);
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eTessellationEvaluation,
             .module = CompileSPV(tes, instance.GetDevice()),
@@ -226,52 +256,23 @@ GraphicsPipeline::GraphicsPipeline(
     std::array<vk::PipelineColorBlendAttachmentState, Liverpool::NumColorBuffers> attachments;
     for (u32 i = 0; i < key.num_color_attachments; i++) {
         const auto& control = key.blend_controls[i];
-        const auto src_color = LiverpoolToVK::BlendFactor(control.color_src_factor);
-        const auto dst_color = LiverpoolToVK::BlendFactor(control.color_dst_factor);
-        const auto color_blend = LiverpoolToVK::BlendOp(control.color_func);
+        const auto has_alpha_masked_out =
+            (key.cb_shader_mask.GetMask(i) & Liverpool::ColorBufferMask::ComponentA) == 0;
+        const auto equation = GetBlendEquation(control, has_alpha_masked_out);
         attachments[i] = vk::PipelineColorBlendAttachmentState{
             .blendEnable = control.enable,
-            .srcColorBlendFactor = src_color,
-            .dstColorBlendFactor = dst_color,
-            .colorBlendOp = color_blend,
-            .srcAlphaBlendFactor = control.separate_alpha_blend
-                                       ? LiverpoolToVK::BlendFactor(control.alpha_src_factor)
-                                       : src_color,
-            .dstAlphaBlendFactor = control.separate_alpha_blend
-                                       ? LiverpoolToVK::BlendFactor(control.alpha_dst_factor)
-                                       : dst_color,
-            .alphaBlendOp = control.separate_alpha_blend
-                                ? LiverpoolToVK::BlendOp(control.alpha_func)
-                                : color_blend,
+            .srcColorBlendFactor = equation.srcColorBlendFactor,
+            .dstColorBlendFactor = equation.dstColorBlendFactor,
+            .colorBlendOp = equation.colorBlendOp,
+            .srcAlphaBlendFactor = equation.srcAlphaBlendFactor,
+            .dstAlphaBlendFactor = equation.dstAlphaBlendFactor,
+            .alphaBlendOp = equation.alphaBlendOp,
             .colorWriteMask =
                 instance.IsDynamicColorWriteMaskSupported()
                     ? vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
                           vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
                     : key.write_masks[i],
         };
-
-        // On GCN GPU there is an additional mask which allows to control color components exported
-        // from a pixel shader. A situation possible, when the game may mask out the alpha channel,
-        // while it is still need to be used in blending ops. For such cases, HW will default alpha
-        // to 1 and perform the blending, while shader normally outputs 0 in the last component.
-        // Unfortunatelly, Vulkan doesn't provide any control on blend inputs, so below we detecting
-        // such cases and override alpha value in order to emulate HW behaviour.
-        const auto has_alpha_masked_out =
-            (key.cb_shader_mask.GetMask(i) & Liverpool::ColorBufferMask::ComponentA) == 0;
-        const auto has_src_alpha_in_src_blend = src_color == vk::BlendFactor::eSrcAlpha ||
-                                                src_color == vk::BlendFactor::eOneMinusSrcAlpha;
-        const auto has_src_alpha_in_dst_blend = dst_color == vk::BlendFactor::eSrcAlpha ||
-                                                dst_color == vk::BlendFactor::eOneMinusSrcAlpha;
-        if (has_alpha_masked_out && has_src_alpha_in_src_blend) {
-            attachments[i].srcColorBlendFactor = src_color == vk::BlendFactor::eSrcAlpha
-                                                     ? vk::BlendFactor::eOne
-                                                     : vk::BlendFactor::eZero; // 1-A
-        }
-        if (has_alpha_masked_out && has_src_alpha_in_dst_blend) {
-            attachments[i].dstColorBlendFactor = dst_color == vk::BlendFactor::eSrcAlpha
-                                                     ? vk::BlendFactor::eOne
-                                                     : vk::BlendFactor::eZero; // 1-A
-        }
     }
 
     const vk::PipelineColorBlendStateCreateInfo color_blending = {
@@ -284,6 +285,7 @@ GraphicsPipeline::GraphicsPipeline(
 
     const vk::GraphicsPipelineCreateInfo pipeline_info = {
         .pNext = &pipeline_rendering_ci,
+        .flags = GetBindingModelFlags(),
         .stageCount = static_cast<u32>(shader_stages.size()),
         .pStages = shader_stages.data(),
         .pVertexInputState = !instance.IsVertexInputDynamicState() ? &vertex_input_info : nullptr,
@@ -298,15 +300,209 @@ GraphicsPipeline::GraphicsPipeline(
         .layout = *pipeline_layout,
     };
 
+    if (library_cache) {
+        LinkLibraries(*library_cache, pipeline_info);
+    } else {
+        auto [pipeline_result, pipe] =
+            device.createGraphicsPipelineUnique(pipeline_cache, pipeline_info);
+        ASSERT_MSG(pipeline_result == vk::Result::eSuccess,
+                   "Failed to create graphics pipeline: {}", vk::to_string(pipeline_result));
+        pipeline = std::move(pipe);
+    }
+    current_pipeline.store(*pipeline, std::memory_order_release);
+    SetObjectName(device, *pipeline, "Graphics Pipeline {}", debug_str);
+}
+
+GraphicsPipeline::~GraphicsPipeline() = default;
+
+void GraphicsPipeline::LinkLibraries(GraphicsLibraryCache& library_cache,
+                                     const vk::GraphicsPipelineCreateInfo& pipeline_info) {
+    const auto hash_state = [](const auto&... state) {
+        u64 hash = 0;
+        ((hash = HashCombine(hash, XXH3_64bits(&state, sizeof(state)))), ...);
+        return hash;
+    };
+    // Shader libraries depend on every stage through the shared descriptor set layout.
+    const u64 stages_hash = hash_state(key.stage_hashes);
+    const std::array<u64, NumGraphicsLibraries> hashes = {
+        hash_state(key.prim_type, key.enable_primitive_restart, bool(key.rect_list_gs)),
+        HashCombine(stages_hash,
+                    hash_state(key.prim_type, key.patch_control_points, key.polygon_mode,
+                               key.cull_mode, key.front_face, key.clip_space,
+                               bool(key.depth_bias_enable), bool(key.rect_list_gs))),
+        HashCombine(stages_hash,
+                    hash_state(bool(key.depth_test_enable), bool(key.depth_write_enable),
+                               bool(key.depth_bounds_test_enable), bool(key.stencil_test_enable),
+                               key.depth_compare_op, key.num_samples)),
+        hash_state(key.num_color_attachments, key.color_formats, key.depth_format,
+                   key.stencil_format, key.blend_controls, key.write_masks, key.cb_shader_mask,
+                   key.num_samples),
+    };
+
+    // Each library only consumes the shader stages of its own subset.
+    const std::span<const vk::PipelineShaderStageCreateInfo> all_stages{pipeline_info.pStages,
+                                                                        pipeline_info.stageCount};
+    boost::container::static_vector<vk::PipelineShaderStageCreateInfo, MaxShaderStages>
+        pre_raster_stages;
+    boost::container::static_vector<vk::PipelineShaderStageCreateInfo, 1> fragment_stages;
+    for (const auto& stage : all_stages) {
+        if (stage.stage == vk::ShaderStageFlagBits::eFragment) {
+            fragment_stages.push_back(stage);
+        } else {
+            pre_raster_stages.push_back(stage);
+        }
+    }
+
+    for (u32 i = 0; i < NumGraphicsLibraries; i++) {
+        auto library_info = pipeline_info;
+        if (i == u32(GraphicsLibrary::PreRasterization)) {
+            library_info.stageCount = static_cast<u32>(pre_raster_stages.size());
+            library_info.pStages = pre_raster_stages.data();
+        } else if (i == u32(GraphicsLibrary::FragmentShader)) {
+            library_info.stageCount = static_cast<u32>(fragment_stages.size());
+            library_info.pStages = fragment_stages.data();
+        } else {
+            library_info.stageCount = 0;
+            library_info.pStages = nullptr;
+        }
+        libraries[i] = library_cache.Get(GraphicsLibrary(i), hashes[i], library_info);
+    }
+
+    const vk::PipelineLibraryCreateInfoKHR link_info = {
+        .libraryCount = NumGraphicsLibraries,
+        .pLibraries = libraries.data(),
+    };
+    const vk::GraphicsPipelineCreateInfo fast_link_info = {
+        .pNext = &link_info,
+        .flags = GetBindingModelFlags(),
+        .layout = *pipeline_layout,
+    };
     auto [pipeline_result, pipe] =
-        device.createGraphicsPipelineUnique(pipeline_cache, pipeline_info);
-    ASSERT_MSG(pipeline_result == vk::Result::eSuccess, "Failed to create graphics pipeline: {}",
+        instance.GetDevice().createGraphicsPipelineUnique(pipeline_cache, fast_link_info);
+    ASSERT_MSG(pipeline_result == vk::Result::eSuccess, "Failed to link graphics pipeline: {}",
                vk::to_string(pipeline_result));
     pipeline = std::move(pipe);
-    SetObjectName(device, *pipeline, "Graphics Pipeline {}", debug_str);
+    is_fast_linked = true;
 }
 
-GraphicsPipeline::~GraphicsPipeline() = default;
+bool GraphicsPipeline::Optimize() {
+    const vk::PipelineLibraryCreateInfoKHR link_info = {
+        .libraryCount = NumGraphicsLibraries,
+        .pLibraries = libraries.data(),
+    };
+    const vk::GraphicsPipelineCreateInfo optimized_info = {
+        .pNext = &link_info,
+        .flags = GetBindingModelFlags() | vk::PipelineCreateFlagBits::eLinkTimeOptimizationEXT,
+        .layout = *pipeline_layout,
+    };
+    auto [pipeline_result, pipe] =
+        instance.GetDevice().createGraphicsPipelineUnique(pipeline_cache, optimized_info);
+    if (pipeline_result != vk::Result::eSuccess) {
+        LOG_WARNING(Render_Vulkan, "Failed to optimize graphics pipeline: {}",
+                    vk::to_string(pipeline_result));
+        return false;
+    }
+    optimized_pipeline = std::move(pipe);
+    SetObjectName(instance.GetDevice(), *optimized_pipeline, "Optimized Graphics Pipeline {}",
+                  GetDebugString());
+    // The fast-linked pipeline is kept alive as command buffers may still reference it.
+    current_pipeline.store(*optimized_pipeline, std::memory_order_release);
+    return true;
+}
+
+GraphicsLibraryCache::GraphicsLibraryCache(const Instance& instance_,
+                                           vk::PipelineCache pipeline_cache_)
+    : instance{instance_}, pipeline_cache{pipeline_cache_} {}
+
+GraphicsLibraryCache::~GraphicsLibraryCache() = default;
+
+vk::Pipeline GraphicsLibraryCache::Get(GraphicsLibrary type, u64 hash,
+                                       const vk::GraphicsPipelineCreateInfo& info) {
+    static constexpr std::array<vk::GraphicsPipelineLibraryFlagsEXT, NumGraphicsLibraries>
+        LibraryFlags = {
+            vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface,
+            vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders,
+            vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader,
+            vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface,
+        };
+
+    auto& cache = libraries[u32(type)];
+    const auto [it, is_new] = cache.try_emplace(hash);
+    if (!is_new) {
+        ++hits;
+        return *it->second;
+    }
+    ++misses;
+
+    const vk::GraphicsPipelineLibraryCreateInfoEXT library_info = {
+        .pNext = info.pNext,
+        .flags = LibraryFlags[u32(type)],
+    };
+    auto create_info = info;
+    create_info.pNext = &library_info;
+    create_info.flags |= vk::PipelineCreateFlagBits::eLibraryKHR |
+                         vk::PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT;
+    auto [library_result, library] =
+        instance.GetDevice().createGraphicsPipelineUnique(pipeline_cache, create_info);
+    ASSERT_MSG(library_result == vk::Result::eSuccess,
+               "Failed to create graphics pipeline library: {}", vk::to_string(library_result));
+    it.value() = std::move(library);
+    return *it->second;
+}
+
+void GraphicsLibraryCache::ClearShaderLibraries() {
+    libraries[u32(GraphicsLibrary::PreRasterization)].clear();
+    libraries[u32(GraphicsLibrary::FragmentShader)].clear();
+}
+
+vk::PrimitiveTopology GraphicsPipeline::GetPrimitiveTopology(const GraphicsPipelineKey& key) {
+    if (key.rect_list_gs) {
+        return vk::PrimitiveTopology::eTriangleList;
+    }
+    return LiverpoolToVK::PrimitiveType(key.prim_type);
+}
+
+vk::ColorBlendEquationEXT GraphicsPipeline::GetBlendEquation(const Liverpool::BlendControl& control,
+                                                             bool has_alpha_masked_out) {
+    const auto src_color = LiverpoolToVK::BlendFactor(control.color_src_factor);
+    const auto dst_color = LiverpoolToVK::BlendFactor(control.color_dst_factor);
+    const auto color_blend = LiverpoolToVK::BlendOp(control.color_func);
+    vk::ColorBlendEquationEXT equation = {
+        .srcColorBlendFactor = src_color,
+        .dstColorBlendFactor = dst_color,
+        .colorBlendOp = color_blend,
+        .srcAlphaBlendFactor = control.separate_alpha_blend
+                                   ? LiverpoolToVK::BlendFactor(control.alpha_src_factor)
+                                   : src_color,
+        .dstAlphaBlendFactor = control.separate_alpha_blend
+                                   ? LiverpoolToVK::BlendFactor(control.alpha_dst_factor)
+                                   : dst_color,
+        .alphaBlendOp =
+            control.separate_alpha_blend ? LiverpoolToVK::BlendOp(control.alpha_func) : color_blend,
+    };
+
+    // On GCN GPU there is an additional mask which allows to control color components exported
+    // from a pixel shader. A situation possible, when the game may mask out the alpha channel,
+    // while it is still need to be used in blending ops. For such cases, HW will default alpha
+    // to 1 and perform the blending, while shader normally outputs 0 in the last component.
+    // Unfortunatelly, Vulkan doesn't provide any control on blend inputs, so below we detecting
+    // such cases and override alpha value in order to emulate HW behaviour.
+    const auto has_src_alpha_in_src_blend =
+        src_color == vk::BlendFactor::eSrcAlpha || src_color == vk::BlendFactor::eOneMinusSrcAlpha;
+    const auto has_src_alpha_in_dst_blend =
+        dst_color == vk::BlendFactor::eSrcAlpha || dst_color == vk::BlendFactor::eOneMinusSrcAlpha;
+    if (has_alpha_masked_out && has_src_alpha_in_src_blend) {
+        equation.srcColorBlendFactor = src_color == vk::BlendFactor::eSrcAlpha
+                                           ? vk::BlendFactor::eOne
+                                           : vk::BlendFactor::eZero; // 1-A
+    }
+    if (has_alpha_masked_out && has_src_alpha_in_dst_blend) {
+        equation.dstColorBlendFactor = dst_color == vk::BlendFactor::eSrcAlpha
+                                           ? vk::BlendFactor::eOne
+                                           : vk::BlendFactor::eZero; // 1-A
+    }
+    return equation;
+}
 
 template <typename Attribute, typename Binding>
 void GraphicsPipeline::GetVertexInputs(VertexInputs<Attribute>& attributes,
@@ -391,12 +587,8 @@ void GraphicsPipeline::BuildDescSetLayout() {
             });
         }
     }
-    uses_push_descriptors = binding < instance.MaxPushDescriptors();
-    const auto flags = uses_push_descriptors
-                           ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR
-                           : vk::DescriptorSetLayoutCreateFlagBits{};
     const vk::DescriptorSetLayoutCreateInfo desc_layout_ci = {
-        .flags = flags,
+        .flags = SelectBindingModel(binding),
         .bindingCount = static_cast<u32>(bindings.size()),
         .pBindings = bindings.data(),
     };
@@ -405,6 +597,7 @@ void GraphicsPipeline::BuildDescSetLayout() {
     ASSERT_MSG(layout_result == vk::Result::eSuccess,
                "Failed to create graphics descriptor set layout: {}", vk::to_string(layout_result));
     desc_layout = std::move(layout);
+    InitBindingModel(binding);
 }
 
 } // namespace Vulkan
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/container/static_vector.hpp>
+#include <tsl/robin_map.h>
 #include <xxhash.h>
 
 #include "common/types.h"
@@ -46,8 +48,9 @@ struct GraphicsPipelineKey {
         bool depth_bounds_test_enable : 1;
         bool depth_bias_enable : 1;
         bool stencil_test_enable : 1;
+        bool rect_list_gs : 1;
         // Must be named to be zero-initialized.
-        u8 _unused : 2;
+        u8 _unused : 1;
     };
     vk::CompareOp depth_compare_op;
 
@@ -71,17 +74,72 @@ struct GraphicsPipelineKey {
     }
 };
 
+/// Parts of a graphics pipeline compiled separately with VK_EXT_graphics_pipeline_library.
+enum class GraphicsLibrary : u32 {
+    VertexInput,
+    PreRasterization,
+    FragmentShader,
+    FragmentOutput,
+};
+static constexpr u32 NumGraphicsLibraries = 4;
+
+/// Caches graphics pipeline libraries by the hash of the key state each of them consumes.
+class GraphicsLibraryCache {
+public:
+    explicit GraphicsLibraryCache(const Instance& instance, vk::PipelineCache pipeline_cache);
+    ~GraphicsLibraryCache();
+
+    /// Returns the library for the provided sub-key hash, compiling it from the
+    /// relevant subset of the pipeline create info on a miss.
+    vk::Pipeline Get(GraphicsLibrary type, u64 hash, const vk::GraphicsPipelineCreateInfo& info);
+
+    /// Destroys cached shader libraries, used when shader modules are replaced.
+    void ClearShaderLibraries();
+
+    u64 GetHits() const noexcept {
+        return hits;
+    }
+
+    u64 GetMisses() const noexcept {
+        return misses;
+    }
+
+private:
+    const Instance& instance;
+    vk::PipelineCache pipeline_cache;
+    std::array<tsl::robin_map<u64, vk::UniquePipeline>, NumGraphicsLibraries> libraries;
+    u64 hits{};
+    u64 misses{};
+};
+
 class GraphicsPipeline : public Pipeline {
 public:
     GraphicsPipeline(const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
-                     const Shader::Profile& profile, const GraphicsPipelineKey& key,
+                     DescriptorBuffer* desc_buffer, const Shader::Profile& profile,
+                     const GraphicsPipelineKey& key,
                      vk::PipelineCache pipeline_cache,
                      std::span<const Shader::Info*, MaxShaderStages> stages,
                      std::span<const Shader::RuntimeInfo, MaxShaderStages> runtime_infos,
                      std::optional<const Shader::Gcn::FetchShaderData> fetch_shader,
-                     std::span<const vk::ShaderModule> modules);
+                     std::span<const vk::ShaderModule> modules,
+                     GraphicsLibraryCache* library_cache = nullptr);
     ~GraphicsPipeline();
 
+    /// Returns the pipeline to bind, which is the optimized one once it is available.
+    vk::Pipeline Handle() const noexcept {
+        return vk::Pipeline{current_pipeline.load(std::memory_order_acquire)};
+    }
+
+    /// Returns true when the pipeline was fast-linked from libraries and should be
+    /// queued for a link time optimized rebuild.
+    bool IsFastLinked() const noexcept {
+        return is_fast_linked;
+    }
+
+    /// Links the pipeline libraries again with link time optimization and atomically
+    /// swaps the result in. Called from the pipeline cache optimization thread.
+    bool Optimize();
+
     const std::optional<const Shader::Gcn::FetchShaderData>& GetFetchShader() const noexcept {
         return fetch_shader;
     }
@@ -99,15 +157,28 @@ public:
     }
 
     [[nodiscard]] bool IsPrimitiveListTopology() const {
-        return key.prim_type == AmdGpu::PrimitiveType::PointList ||
-               key.prim_type == AmdGpu::PrimitiveType::LineList ||
-               key.prim_type == AmdGpu::PrimitiveType::TriangleList ||
-               key.prim_type == AmdGpu::PrimitiveType::AdjLineList ||
-               key.prim_type == AmdGpu::PrimitiveType::AdjTriangleList ||
-               key.prim_type == AmdGpu::PrimitiveType::RectList ||
-               key.prim_type == AmdGpu::PrimitiveType::QuadList;
+        return IsPrimitiveListTopology(key.prim_type);
+    }
+
+    [[nodiscard]] static bool IsPrimitiveListTopology(AmdGpu::PrimitiveType prim_type) {
+        return prim_type == AmdGpu::PrimitiveType::PointList ||
+               prim_type == AmdGpu::PrimitiveType::LineList ||
+               prim_type == AmdGpu::PrimitiveType::TriangleList ||
+               prim_type == AmdGpu::PrimitiveType::AdjLineList ||
+               prim_type == AmdGpu::PrimitiveType::AdjTriangleList ||
+               prim_type == AmdGpu::PrimitiveType::RectList ||
+               prim_type == AmdGpu::PrimitiveType::QuadList;
     }
 
+    /// Returns the host topology of the key. Rect lists expanded by a geometry shader are drawn
+    /// as triangles, other quad and rect lists are tessellation patches.
+    [[nodiscard]] static vk::PrimitiveTopology GetPrimitiveTopology(const GraphicsPipelineKey& key);
+
+    /// Translates a guest blend control into a Vulkan blend equation. When the pixel shader
+    /// alpha export is masked out, source alpha factors are replaced as HW defaults alpha to 1.
+    [[nodiscard]] static vk::ColorBlendEquationEXT GetBlendEquation(
+        const Liverpool::BlendControl& control, bool has_alpha_masked_out);
+
     /// Gets the attributes and bindings for vertex inputs.
     template <typename Attribute, typename Binding>
     void GetVertexInputs(VertexInputs<Attribute>& attributes, VertexInputs<Binding>& bindings,
@@ -115,10 +186,17 @@ public:
 
 private:
     void BuildDescSetLayout();
+    void LinkLibraries(GraphicsLibraryCache& library_cache,
+                       const vk::GraphicsPipelineCreateInfo& pipeline_info);
 
 private:
     GraphicsPipelineKey key;
     std::optional<const Shader::Gcn::FetchShaderData> fetch_shader{};
+    vk::PipelineCache pipeline_cache;
+    std::array<vk::Pipeline, NumGraphicsLibraries> libraries{};
+    vk::UniquePipeline optimized_pipeline;
+    std::atomic<VkPipeline> current_pipeline{};
+    bool is_fast_linked{};
 };
 
 } // namespace Vulkan
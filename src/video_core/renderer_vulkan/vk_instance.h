@@ -33,6 +33,9 @@ public:
     [[nodiscard]] vk::Format GetSupportedFormat(vk::Format format,
                                                 vk::FormatFeatureFlags2 flags) const;
 
+    /// Determines if a format is supported for a set of feature flags.
+    [[nodiscard]] bool IsFormatSupported(vk::Format format, vk::FormatFeatureFlags2 flags) const;
+
     /// Returns the Vulkan instance
     vk::Instance GetInstance() const {
         return *instance;
@@ -84,6 +87,11 @@ public:
         return features.samplerAnisotropy;
     }
 
+    /// Returns true if robust buffer access is enabled
+    bool IsRobustBufferAccessSupported() const {
+        return features.robustBufferAccess;
+    }
+
     /// Returns true when VK_EXT_custom_border_color is supported
     bool IsCustomBorderColorSupported() const {
         return custom_border_color;
@@ -99,12 +107,42 @@ public:
         return depth_clip_control;
     }
 
+    /// Returns true when VK_EXT_depth_range_unrestricted is supported
+    bool IsDepthRangeUnrestrictedSupported() const {
+        return depth_range_unrestricted;
+    }
+
+    /// Returns true when VK_EXT_extended_dynamic_state2 is supported.
+    bool IsExtendedDynamicState2Supported() const {
+        return dynamic_state_2;
+    }
+
     /// Returns true when the extendedDynamicState3ColorWriteMask feature of
     /// VK_EXT_extended_dynamic_state3 is supported.
     bool IsDynamicColorWriteMaskSupported() const {
         return dynamic_state_3 && dynamic_state_3_features.extendedDynamicState3ColorWriteMask;
     }
 
+    /// Returns true when the extendedDynamicState3PolygonMode feature of
+    /// VK_EXT_extended_dynamic_state3 is supported.
+    bool IsDynamicPolygonModeSupported() const {
+        return dynamic_state_3 && dynamic_state_3_features.extendedDynamicState3PolygonMode;
+    }
+
+    /// Returns true when the extendedDynamicState3RasterizationSamples feature of
+    /// VK_EXT_extended_dynamic_state3 is supported.
+    bool IsDynamicRasterizationSamplesSupported() const {
+        return dynamic_state_3 && dynamic_state_3_features.extendedDynamicState3RasterizationSamples;
+    }
+
+    /// Returns true when both the extendedDynamicState3ColorBlendEnable and
+    /// extendedDynamicState3ColorBlendEquation features of VK_EXT_extended_dynamic_state3 are
+    /// supported.
+    bool IsDynamicColorBlendSupported() const {
+        return dynamic_state_3 && dynamic_state_3_features.extendedDynamicState3ColorBlendEnable &&
+               dynamic_state_3_features.extendedDynamicState3ColorBlendEquation;
+    }
+
     /// Returns true when VK_EXT_vertex_input_dynamic_state is supported.
     bool IsVertexInputDynamicState() const {
         return vertex_input_dynamic_state;
@@ -135,6 +173,21 @@ public:
         return legacy_vertex_attributes;
     }
 
+    /// Returns true when VK_EXT_graphics_pipeline_library is supported with fast linking.
+    bool IsGraphicsPipelineLibrarySupported() const {
+        return graphics_pipeline_library;
+    }
+
+    /// Returns true when VK_EXT_descriptor_buffer is supported.
+    bool IsDescriptorBufferSupported() const {
+        return descriptor_buffer;
+    }
+
+    /// Returns the descriptor sizes and alignments of VK_EXT_descriptor_buffer.
+    const vk::PhysicalDeviceDescriptorBufferPropertiesEXT& GetDescriptorBufferProperties() const {
+        return descriptor_buffer_props;
+    }
+
     /// Returns true when VK_AMD_shader_image_load_store_lod is supported.
     bool IsImageLoadStoreLodSupported() const {
         return image_load_store_lod;
@@ -296,9 +349,6 @@ private:
     /// Gets the supported feature flags for a format.
     [[nodiscard]] vk::FormatFeatureFlags2 GetFormatFeatureFlags(vk::Format format) const;
 
-    /// Determines if a format is supported for a set of feature flags.
-    [[nodiscard]] bool IsFormatSupported(vk::Format format, vk::FormatFeatureFlags2 flags) const;
-
 private:
     vk::UniqueInstance instance;
     vk::PhysicalDevice physical_device;
@@ -307,6 +357,7 @@ private:
     vk::PhysicalDeviceVulkan11Properties vk11_props;
     vk::PhysicalDeviceVulkan12Properties vk12_props;
     vk::PhysicalDevicePushDescriptorPropertiesKHR push_descriptor_props;
+    vk::PhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_props;
     vk::PhysicalDeviceFeatures features;
     vk::PhysicalDevicePortabilitySubsetFeaturesKHR portability_features;
     vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT dynamic_state_3_features;
@@ -325,10 +376,14 @@ private:
     bool custom_border_color{};
     bool fragment_shader_barycentric{};
     bool depth_clip_control{};
+    bool depth_range_unrestricted{};
+    bool dynamic_state_2{};
     bool dynamic_state_3{};
     bool vertex_input_dynamic_state{};
     bool robustness2{};
     bool list_restart{};
+    bool graphics_pipeline_library{};
+    bool descriptor_buffer{};
     bool legacy_vertex_attributes{};
     bool shader_stencil_export{};
     bool image_load_store_lod{};
@@ -1,15 +1,18 @@
 // SPDX-FileCopyrightText: Copyright 2020 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <limits>
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_master_semaphore.h"
 
 #include "common/assert.h"
+#include "common/thread.h"
 
 namespace Vulkan {
 
 constexpr u64 WAIT_TIMEOUT = std::numeric_limits<u64>::max();
+constexpr u64 COMPLETION_WAIT_TIMEOUT = 100'000'000; ///< Lets the completion thread see stops
 
 MasterSemaphore::MasterSemaphore(const Instance& instance_) : instance{instance_} {
     const vk::StructureChain semaphore_chain = {
@@ -24,6 +27,8 @@ MasterSemaphore::MasterSemaphore(const Instance& instance_) : instance{instance_
     ASSERT_MSG(semaphore_result == vk::Result::eSuccess, "Failed to create master semaphore: {}",
                vk::to_string(semaphore_result));
     semaphore = std::move(sem);
+    completion_thread =
+        std::jthread{[this](std::stop_token stop) { CompletionThread(std::move(stop)); }};
 }
 
 MasterSemaphore::~MasterSemaphore() = default;
@@ -67,4 +72,80 @@ void MasterSemaphore::Wait(u64 tick) {
     Refresh();
 }
 
+void MasterSemaphore::Submitted(u64 tick) {
+    {
+        std::scoped_lock lk{completion_mutex};
+        submitted_tick = std::max(submitted_tick, tick);
+    }
+    completion_cv.notify_one();
+}
+
+void MasterSemaphore::OnCompletion(u64 tick, Common::UniqueFunction<void>&& func) {
+    {
+        std::scoped_lock lk{completion_mutex};
+        callbacks.emplace(std::move(func), tick);
+    }
+    // The tick may already be reached, with no more submits coming to wake the thread.
+    completion_cv.notify_one();
+}
+
+MasterSemaphore::Completion MasterSemaphore::LastCompletion() const {
+    std::scoped_lock lk{completion_mutex};
+    return last_completion;
+}
+
+void MasterSemaphore::CompletionThread(std::stop_token stop) {
+    Common::SetCurrentThreadName("shadPS4:GpuCompletion");
+
+    while (!stop.stop_requested()) {
+        // Sleep until there is submitted work the GPU has not finished yet, or a callback
+        // whose tick was already reached.
+        u64 tick{};
+        bool is_gpu_busy{};
+        {
+            std::unique_lock lk{completion_mutex};
+            Common::CondvarWait(completion_cv, lk, stop, [this] {
+                return submitted_tick > KnownGpuTick() ||
+                       (!callbacks.empty() && IsFree(callbacks.front().gpu_tick));
+            });
+            if (stop.stop_requested()) {
+                return;
+            }
+            is_gpu_busy = submitted_tick > KnownGpuTick();
+            tick = KnownGpuTick() + 1;
+        }
+
+        if (is_gpu_busy) {
+            const vk::SemaphoreWaitInfo wait_info = {
+                .semaphoreCount = 1,
+                .pSemaphores = &semaphore.get(),
+                .pValues = &tick,
+            };
+            while (instance.GetDevice().waitSemaphores(&wait_info, COMPLETION_WAIT_TIMEOUT) !=
+                   vk::Result::eSuccess) {
+                if (stop.stop_requested()) {
+                    return;
+                }
+            }
+            Refresh();
+        }
+
+        // Callbacks run outside of the lock, so they may defer more work.
+        const auto now = Clock::now();
+        for (;;) {
+            Common::UniqueFunction<void> callback;
+            {
+                std::scoped_lock lk{completion_mutex};
+                last_completion = {KnownGpuTick(), now};
+                if (callbacks.empty() || !IsFree(callbacks.front().gpu_tick)) {
+                    break;
+                }
+                callback = std::move(callbacks.front().callback);
+                callbacks.pop();
+            }
+            callback();
+        }
+    }
+}
+
 } // namespace Vulkan
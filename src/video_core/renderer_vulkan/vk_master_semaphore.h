@@ -4,10 +4,14 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <queue>
+#include "common/polyfill_thread.h"
 #include "common/types.h"
+#include "common/unique_function.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 
 namespace Vulkan {
@@ -17,6 +21,13 @@ class Scheduler;
 
 class MasterSemaphore {
 public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Completion {
+        u64 tick;               ///< Last tick the completion thread saw the GPU reach
+        Clock::time_point time; ///< When the tick was observed
+    };
+
     explicit MasterSemaphore(const Instance& instance_);
     ~MasterSemaphore();
 
@@ -46,11 +57,37 @@ public:
     /// Waits for a tick to be hit on the GPU
     void Wait(u64 tick);
 
+    /// Lets the completion thread wait for a tick that was submitted to the GPU
+    void Submitted(u64 tick);
+
+    /// Runs a callback on the completion thread as soon as the GPU reaches a tick.
+    /// Callbacks run in the order they were added and must not touch state owned by other
+    /// threads; releasing resources that were kept alive for the GPU is the intended use.
+    void OnCompletion(u64 tick, Common::UniqueFunction<void>&& func);
+
+    /// Returns the most recent tick observed by the completion thread and when it was seen
+    [[nodiscard]] Completion LastCompletion() const;
+
 protected:
     const Instance& instance;
     vk::UniqueSemaphore semaphore;    ///< Timeline semaphore.
     std::atomic<u64> gpu_tick{0};     ///< Current known GPU tick.
     std::atomic<u64> current_tick{1}; ///< Current logical tick.
+
+private:
+    void CompletionThread(std::stop_token stop);
+
+    struct PendingCallback {
+        Common::UniqueFunction<void> callback;
+        u64 gpu_tick;
+    };
+
+    mutable std::mutex completion_mutex;
+    std::condition_variable_any completion_cv;
+    std::queue<PendingCallback> callbacks;
+    u64 submitted_tick{};
+    Completion last_completion{};
+    std::jthread completion_thread;
 };
 
 } // namespace Vulkan
@@ -1,12 +1,15 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <functional>
 #include <ranges>
 
 #include "common/config.h"
 #include "common/hash.h"
 #include "common/io_file.h"
 #include "common/path_util.h"
+#include "common/thread.h"
 #include "core/debug_state.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
 #include "shader_recompiler/info.h"
@@ -217,24 +220,55 @@ PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
     ASSERT_MSG(cache_result == vk::Result::eSuccess, "Failed to create pipeline cache: {}",
                vk::to_string(cache_result));
     pipeline_cache = std::move(cache);
+
+    if (instance.IsDescriptorBufferSupported()) {
+        desc_buffer = std::make_unique<DescriptorBuffer>(instance, scheduler);
+    }
+
+    // Libraries are only used with dynamic vertex input, so that the vertex input interface does
+    // not depend on the fetch shader and all pipelines share the same dynamic state.
+    if (instance.IsGraphicsPipelineLibrarySupported() && instance.IsVertexInputDynamicState()) {
+        library_cache = std::make_unique<GraphicsLibraryCache>(instance, *pipeline_cache);
+        optimize_thread = std::jthread{std::bind_front(&PipelineCache::OptimizeThread, this)};
+    }
 }
 
 PipelineCache::~PipelineCache() = default;
 
-const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
-    if (!RefreshGraphicsKey()) {
+const GraphicsPipeline* PipelineCache::GetGraphicsPipeline(bool expand_quad_list) {
+    if (!RefreshGraphicsKey(expand_quad_list)) {
         return nullptr;
     }
-    const auto [it, is_new] = graphics_pipelines.try_emplace(graphics_key);
+    const auto pipeline_key = StripDynamicState(graphics_key);
+    const auto [it, is_new] = graphics_pipelines.try_emplace(pipeline_key);
     if (is_new) {
-        it.value() = std::make_unique<GraphicsPipeline>(instance, scheduler, desc_heap, profile,
-                                                        graphics_key, *pipeline_cache, infos,
-                                                        runtime_infos, fetch_shader, modules);
+        const auto miss_time = std::chrono::steady_clock::now();
+        it.value() = std::make_unique<GraphicsPipeline>(
+            instance, scheduler, desc_heap, desc_buffer.get(), profile, pipeline_key,
+            *pipeline_cache, infos, runtime_infos, fetch_shader, modules, library_cache.get());
+        if (it->second->IsFastLinked()) {
+            ++graphics_stats.fast_linked;
+            {
+                std::scoped_lock lock{optimize_mutex};
+                optimize_queue.push_back(it->second.get());
+            }
+            optimize_cv.notify_one();
+        } else {
+            ++graphics_stats.monolithic;
+        }
+        const u64 elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now() - miss_time)
+                                   .count();
+        graphics_stats.compile_total_us += elapsed_us;
+        graphics_stats.compile_max_us = std::max(graphics_stats.compile_max_us, elapsed_us);
+        // Resource binding may still skip the draw, so the timing completes when it is bound.
+        first_draw_pipeline = it->second.get();
+        first_draw_miss_time = miss_time;
         if (Config::collectShadersForDebug()) {
             for (auto stage = 0; stage < MaxShaderStages; ++stage) {
                 if (infos[stage]) {
                     auto& m = modules[stage];
-                    module_related_pipelines[m].emplace_back(graphics_key);
+                    module_related_pipelines[m].emplace_back(pipeline_key);
                 }
             }
         }
@@ -242,15 +276,25 @@ const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
     return it->second.get();
 }
 
+void PipelineCache::RecordFirstDraw() {
+    const u64 elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - first_draw_miss_time)
+                               .count();
+    ++graphics_stats.first_draw_count;
+    graphics_stats.first_draw_total_us += elapsed_us;
+    graphics_stats.first_draw_max_us = std::max(graphics_stats.first_draw_max_us, elapsed_us);
+    first_draw_pipeline = nullptr;
+}
+
 const ComputePipeline* PipelineCache::GetComputePipeline() {
     if (!RefreshComputeKey()) {
         return nullptr;
     }
     const auto [it, is_new] = compute_pipelines.try_emplace(compute_key);
     if (is_new) {
-        it.value() =
-            std::make_unique<ComputePipeline>(instance, scheduler, desc_heap, profile,
-                                              *pipeline_cache, compute_key, *infos[0], modules[0]);
+        it.value() = std::make_unique<ComputePipeline>(instance, scheduler, desc_heap,
+                                                       desc_buffer.get(), profile, *pipeline_cache,
+                                                       compute_key, *infos[0], modules[0]);
         if (Config::collectShadersForDebug()) {
             auto& m = modules[0];
             module_related_pipelines[m].emplace_back(compute_key);
@@ -259,7 +303,7 @@ const ComputePipeline* PipelineCache::GetComputePipeline() {
     return it->second.get();
 }
 
-bool PipelineCache::RefreshGraphicsKey() {
+bool PipelineCache::RefreshGraphicsKey(bool expand_quad_list) {
     std::memset(&graphics_key, 0, sizeof(GraphicsPipelineKey));
 
     auto& regs = liverpool->regs;
@@ -293,6 +337,15 @@ bool PipelineCache::RefreshGraphicsKey() {
     }
 
     key.prim_type = regs.primitive_type;
+    if (expand_quad_list) {
+        ASSERT(regs.primitive_type == AmdGpu::PrimitiveType::QuadList);
+        key.prim_type = AmdGpu::PrimitiveType::TriangleList;
+    }
+    // Rect lists of plain vertex pipelines are expanded by a geometry shader when possible,
+    // tessellation is kept as fallback.
+    key.rect_list_gs = regs.primitive_type == AmdGpu::PrimitiveType::RectList &&
+                       regs.stage_enable.raw == Liverpool::ShaderStageEnable::VgtStages::Vs &&
+                       instance.IsGeometryStageSupported();
     key.enable_primitive_restart = regs.enable_primitive_restart & 1;
     key.primitive_restart_index = regs.primitive_restart_index;
     key.polygon_mode = regs.polygon_control.PolyMode();
@@ -502,6 +555,81 @@ bool PipelineCache::RefreshGraphicsKey() {
     return true;
 } // namespace Vulkan
 
+void PipelineCache::OptimizeThread(std::stop_token stop) {
+    Common::SetCurrentThreadName("shadPS4:PipelineOptimizer");
+    while (!stop.stop_requested()) {
+        std::unique_lock lock{optimize_mutex};
+        optimize_cv.wait(lock, stop, [this] { return !optimize_queue.empty(); });
+        if (stop.stop_requested()) {
+            break;
+        }
+        GraphicsPipeline* pipeline = optimize_queue.front();
+        optimize_queue.pop_front();
+
+        // Taken before releasing the queue so that the pipeline can't be erased meanwhile.
+        std::scoped_lock compile_lock{compile_mutex};
+        lock.unlock();
+        if (pipeline->Optimize()) {
+            ++graphics_stats.optimized;
+        }
+    }
+}
+
+GraphicsPipelineKey PipelineCache::StripDynamicState(const GraphicsPipelineKey& key) const {
+    // State covered by VK_EXT_extended_dynamic_state is always set by the rasterizer, so only
+    // the topology class has to be part of the pipeline key.
+    auto stripped = key;
+    stripped.depth_test_enable = false;
+    stripped.depth_write_enable = false;
+    stripped.depth_bounds_test_enable = false;
+    stripped.stencil_test_enable = false;
+    stripped.depth_compare_op = vk::CompareOp::eNever;
+    stripped.cull_mode = {};
+    stripped.front_face = {};
+    // Primitive restart is baked into the pipeline without VK_EXT_extended_dynamic_state2, and
+    // whether it applies depends on the actual topology, so only collapse it when it doesn't.
+    const bool dynamic_restart =
+        instance.IsExtendedDynamicState2Supported() || !key.enable_primitive_restart;
+    if (dynamic_restart) {
+        switch (key.prim_type) {
+        case AmdGpu::PrimitiveType::PointList:
+            break;
+        case AmdGpu::PrimitiveType::LineList:
+        case AmdGpu::PrimitiveType::LineStrip:
+        case AmdGpu::PrimitiveType::AdjLineList:
+        case AmdGpu::PrimitiveType::AdjLineStrip:
+            stripped.prim_type = AmdGpu::PrimitiveType::LineList;
+            break;
+        case AmdGpu::PrimitiveType::TriangleList:
+        case AmdGpu::PrimitiveType::TriangleStrip:
+        case AmdGpu::PrimitiveType::TriangleFan:
+        case AmdGpu::PrimitiveType::Polygon:
+        case AmdGpu::PrimitiveType::AdjTriangleList:
+        case AmdGpu::PrimitiveType::AdjTriangleStrip:
+            stripped.prim_type = AmdGpu::PrimitiveType::TriangleList;
+            break;
+        default:
+            // Patch, rect and quad lists select auxiliary tessellation or geometry stages.
+            break;
+        }
+    }
+    if (instance.IsExtendedDynamicState2Supported()) {
+        stripped.depth_bias_enable = false;
+        stripped.enable_primitive_restart = 0;
+        stripped.primitive_restart_index = 0;
+    }
+    if (instance.IsDynamicPolygonModeSupported()) {
+        stripped.polygon_mode = Liverpool::PolygonMode::Fill;
+    }
+    if (instance.IsDynamicRasterizationSamplesSupported()) {
+        stripped.num_samples = 1;
+    }
+    if (instance.IsDynamicColorBlendSupported()) {
+        stripped.blend_controls.fill({});
+    }
+    return stripped;
+}
+
 bool PipelineCache::RefreshComputeKey() {
     Shader::Backend::Bindings binding{};
     const auto& cs_pgm = liverpool->GetCsRegs();
@@ -593,6 +721,12 @@ std::optional<vk::ShaderModule> PipelineCache::ReplaceShader(vk::ShaderModule mo
             }
         }
     }
+    // Queued optimizations may reference the pipelines and libraries dropped below.
+    std::scoped_lock lock{optimize_mutex, compile_mutex};
+    optimize_queue.clear();
+    if (library_cache) {
+        library_cache->ClearShaderLibraries();
+    }
     if (module_related_pipelines.contains(module)) {
         auto& pipeline_keys = module_related_pipelines[module];
         for (auto& key : pipeline_keys) {
@@ -3,6 +3,11 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <variant>
 #include <tsl/robin_map.h>
 #include "shader_recompiler/profile.h"
@@ -49,11 +54,29 @@ struct Program {
 
 class PipelineCache {
 public:
+    struct GraphicsStats {
+        u64 monolithic{};             ///< Pipelines compiled without libraries
+        u64 fast_linked{};            ///< Pipelines fast-linked from libraries
+        std::atomic<u64> optimized{}; ///< Link time optimized pipelines swapped in
+        u64 compile_total_us{};       ///< Accumulated time spent creating pipelines on a miss
+        u64 compile_max_us{};         ///< Longest time spent creating a pipeline on a miss
+        u64 first_draw_count{};       ///< Misses accounted in the timings below
+        u64 first_draw_total_us{};    ///< Accumulated time from a miss to its first bind
+        u64 first_draw_max_us{};      ///< Longest time from a miss to its first bind
+
+        /// Returns the number of graphics pipelines created so far.
+        [[nodiscard]] u64 NumPipelines() const noexcept {
+            return monolithic + fast_linked;
+        }
+    };
+
     explicit PipelineCache(const Instance& instance, Scheduler& scheduler,
                            AmdGpu::Liverpool* liverpool);
     ~PipelineCache();
 
-    const GraphicsPipeline* GetGraphicsPipeline();
+    /// Returns the pipeline of the current draw. With expand_quad_list a quad list draw is
+    /// expected to be converted to a triangle list by the caller.
+    const GraphicsPipeline* GetGraphicsPipeline(bool expand_quad_list = false);
 
     const ComputePipeline* GetComputePipeline();
 
@@ -72,9 +95,41 @@ public:
         return profile;
     }
 
+    [[nodiscard]] const GraphicsStats& GetGraphicsStats() const noexcept {
+        return graphics_stats;
+    }
+
+    /// Returns the pipeline library cache, or null when pipeline libraries are not used.
+    [[nodiscard]] const GraphicsLibraryCache* GetLibraryCache() const noexcept {
+        return library_cache.get();
+    }
+
+    /// Returns the descriptor buffer, or null when descriptors are pushed or allocated from a heap.
+    [[nodiscard]] const DescriptorBuffer* GetDescriptorBuffer() const noexcept {
+        return desc_buffer.get();
+    }
+
+    /// Completes the first draw timing of a pipeline when it is bound after a cache miss.
+    void OnGraphicsPipelineBound(const GraphicsPipeline* pipeline) {
+        if (pipeline == first_draw_pipeline) {
+            RecordFirstDraw();
+        }
+    }
+
+    /// Returns the full key of the last graphics pipeline lookup, including the state that is
+    /// excluded from the pipeline key and set dynamically when drawing.
+    const GraphicsPipelineKey& GetGraphicsKey() const {
+        return graphics_key;
+    }
+
 private:
-    bool RefreshGraphicsKey();
+    bool RefreshGraphicsKey(bool expand_quad_list);
     bool RefreshComputeKey();
+    GraphicsPipelineKey StripDynamicState(const GraphicsPipelineKey& key) const;
+    void RecordFirstDraw();
+
+    /// Rebuilds fast-linked pipelines with link time optimization in the background.
+    void OptimizeThread(std::stop_token stop);
 
     void DumpShader(std::span<const u32> code, u64 hash, Shader::Stage stage, size_t perm_idx,
                     std::string_view ext);
@@ -90,6 +145,7 @@ private:
     Scheduler& scheduler;
     AmdGpu::Liverpool* liverpool;
     DescriptorHeap desc_heap;
+    std::unique_ptr<DescriptorBuffer> desc_buffer;
     vk::UniquePipelineCache pipeline_cache;
     vk::UniquePipelineLayout pipeline_layout;
     Shader::Profile profile{};
@@ -104,10 +160,22 @@ private:
     GraphicsPipelineKey graphics_key{};
     ComputePipelineKey compute_key{};
 
+    GraphicsStats graphics_stats{};
+    const GraphicsPipeline* first_draw_pipeline{};
+    std::chrono::steady_clock::time_point first_draw_miss_time{};
+
     // Only if Config::collectShadersForDebug()
     tsl::robin_map<vk::ShaderModule,
                    std::vector<std::variant<GraphicsPipelineKey, ComputePipelineKey>>>
         module_related_pipelines;
+
+    // Only if VK_EXT_graphics_pipeline_library is used
+    std::unique_ptr<GraphicsLibraryCache> library_cache;
+    std::deque<GraphicsPipeline*> optimize_queue;
+    std::mutex optimize_mutex;
+    std::mutex compile_mutex;
+    std::condition_variable_any optimize_cv;
+    std::jthread optimize_thread;
 };
 
 } // namespace Vulkan
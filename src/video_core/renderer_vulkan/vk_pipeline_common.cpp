@@ -14,15 +14,17 @@
 namespace Vulkan {
 
 Pipeline::Pipeline(const Instance& instance_, Scheduler& scheduler_, DescriptorHeap& desc_heap_,
-                   const Shader::Profile& profile_, vk::PipelineCache pipeline_cache,
-                   bool is_compute_ /*= false*/)
-    : instance{instance_}, scheduler{scheduler_}, desc_heap{desc_heap_}, profile{profile_},
-      is_compute{is_compute_} {}
+                   DescriptorBuffer* desc_buffer_, const Shader::Profile& profile_,
+                   vk::PipelineCache pipeline_cache, bool is_compute_ /*= false*/)
+    : instance{instance_}, scheduler{scheduler_}, desc_heap{desc_heap_}, desc_buffer{desc_buffer_},
+      profile{profile_}, is_compute{is_compute_} {}
 
 Pipeline::~Pipeline() = default;
 
 void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers& buffer_barriers,
-                             const Shader::PushData& push_data) const {
+                             const Shader::PushData& push_data,
+                             std::span<const vk::DescriptorBufferInfo> buffer_infos,
+                             std::span<const vk::DeviceAddress> buffer_addresses) const {
     const auto cmdbuf = scheduler.CommandBuffer();
     const auto bind_point =
         IsCompute() ? vk::PipelineBindPoint::eCompute : vk::PipelineBindPoint::eGraphics;
@@ -45,6 +47,17 @@ void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers&
         return;
     }
 
+    if (uses_descriptor_buffer) {
+        const vk::DeviceSize offset =
+            desc_buffer->Commit(desc_buffer_layout, set_writes, buffer_infos, buffer_addresses);
+        scheduler.GetStateTracker().BindDescriptorBuffer(desc_buffer->Address(),
+                                                         desc_buffer->Usage());
+        const u32 buffer_index = 0;
+        cmdbuf.setDescriptorBufferOffsetsEXT(bind_point, *pipeline_layout, 0, buffer_index,
+                                             offset);
+        return;
+    }
+
     if (uses_push_descriptors) {
         cmdbuf.pushDescriptorSetKHR(bind_point, *pipeline_layout, 0, set_writes);
         return;
@@ -58,6 +71,25 @@ void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers&
     cmdbuf.bindDescriptorSets(bind_point, *pipeline_layout, 0, desc_set, {});
 }
 
+vk::DescriptorSetLayoutCreateFlags Pipeline::SelectBindingModel(u32 num_bindings) {
+    // Descriptor buffers are preferred, push descriptors remain as the fallback.
+    uses_descriptor_buffer = desc_buffer != nullptr;
+    uses_push_descriptors = !uses_descriptor_buffer && num_bindings < instance.MaxPushDescriptors();
+    if (uses_descriptor_buffer) {
+        return vk::DescriptorSetLayoutCreateFlagBits::eDescriptorBufferEXT;
+    }
+    if (uses_push_descriptors) {
+        return vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR;
+    }
+    return {};
+}
+
+void Pipeline::InitBindingModel(u32 num_bindings) {
+    if (uses_descriptor_buffer) {
+        desc_buffer_layout = desc_buffer->GetSetLayout(*desc_layout, num_bindings);
+    }
+}
+
 std::string Pipeline::GetDebugString() const {
     std::string stage_desc;
     for (const auto& stage : stages) {
@@ -7,6 +7,7 @@
 #include "shader_recompiler/info.h"
 #include "shader_recompiler/profile.h"
 #include "video_core/renderer_vulkan/vk_common.h"
+#include "video_core/renderer_vulkan/vk_descriptor_buffer.h"
 #include "video_core/texture_cache/texture_cache.h"
 
 namespace VideoCore {
@@ -27,8 +28,8 @@ class DescriptorHeap;
 class Pipeline {
 public:
     Pipeline(const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
-             const Shader::Profile& profile, vk::PipelineCache pipeline_cache,
-             bool is_compute = false);
+             DescriptorBuffer* desc_buffer, const Shader::Profile& profile,
+             vk::PipelineCache pipeline_cache, bool is_compute = false);
     virtual ~Pipeline();
 
     vk::Pipeline Handle() const noexcept {
@@ -60,20 +61,37 @@ public:
     using BufferBarriers = boost::container::small_vector<vk::BufferMemoryBarrier2, 16>;
 
     void BindResources(DescriptorWrites& set_writes, const BufferBarriers& buffer_barriers,
-                       const Shader::PushData& push_data) const;
+                       const Shader::PushData& push_data,
+                       std::span<const vk::DescriptorBufferInfo> buffer_infos,
+                       std::span<const vk::DeviceAddress> buffer_addresses) const;
 
 protected:
     [[nodiscard]] std::string GetDebugString() const;
 
+    /// Selects how the descriptor set is bound and returns the matching layout flags.
+    vk::DescriptorSetLayoutCreateFlags SelectBindingModel(u32 num_bindings);
+
+    /// Returns the pipeline flags required by the selected binding model.
+    [[nodiscard]] vk::PipelineCreateFlags GetBindingModelFlags() const noexcept {
+        return uses_descriptor_buffer ? vk::PipelineCreateFlagBits::eDescriptorBufferEXT
+                                      : vk::PipelineCreateFlags{};
+    }
+
+    /// Finishes the setup of the binding model once the set layout has been created.
+    void InitBindingModel(u32 num_bindings);
+
     const Instance& instance;
     Scheduler& scheduler;
     DescriptorHeap& desc_heap;
+    DescriptorBuffer* desc_buffer;
     const Shader::Profile& profile;
     vk::UniquePipeline pipeline;
     vk::UniquePipelineLayout pipeline_layout;
     vk::UniqueDescriptorSetLayout desc_layout;
+    DescriptorBuffer::SetLayout desc_buffer_layout;
     std::array<const Shader::Info*, Shader::MaxStageTypes> stages{};
     bool uses_push_descriptors{};
+    bool uses_descriptor_buffer{};
     const bool is_compute;
 };
 
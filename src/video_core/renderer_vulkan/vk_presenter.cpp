@@ -107,11 +107,6 @@ static vk::Rect2D FitImage(s32 frame_width, s32 frame_height, s32 swapchain_widt
 }
 
 void Presenter::CreatePostProcessPipeline() {
-    static const std::array pp_shaders{
-        HostShaders::FS_TRI_VERT,
-        HostShaders::POST_PROCESS_FRAG,
-    };
-
     boost::container::static_vector<vk::DescriptorSetLayoutBinding, 2> bindings{
         {
             .binding = 0,
@@ -139,12 +134,14 @@ void Presenter::CreatePostProcessPipeline() {
     };
 
     const auto& vs_module =
-        Vulkan::Compile(pp_shaders[0], vk::ShaderStageFlagBits::eVertex, instance.GetDevice());
+        Vulkan::CompileHostShader(HostShaders::FS_TRI_VERT, HostShaders::FS_TRI_VERT_SPV,
+                                  vk::ShaderStageFlagBits::eVertex, instance.GetDevice());
     ASSERT(vs_module);
     Vulkan::SetObjectName(instance.GetDevice(), vs_module, "fs_tri.vert");
 
-    const auto& fs_module =
-        Vulkan::Compile(pp_shaders[1], vk::ShaderStageFlagBits::eFragment, instance.GetDevice());
+    const auto& fs_module = Vulkan::CompileHostShader(
+        HostShaders::POST_PROCESS_FRAG, HostShaders::POST_PROCESS_FRAG_SPV,
+        vk::ShaderStageFlagBits::eFragment, instance.GetDevice());
     ASSERT(fs_module);
     Vulkan::SetObjectName(instance.GetDevice(), fs_module, "post_process.frag");
 
@@ -299,12 +296,14 @@ Presenter::Presenter(Frontend::WindowSDL& window_, AmdGpu::Liverpool* liverpool_
       swapchain{instance, window},
       rasterizer{std::make_unique<Rasterizer>(instance, draw_scheduler, liverpool)},
       texture_cache{rasterizer->GetTextureCache()} {
-    const u32 num_images = swapchain.GetImageCount();
+    const u32 frames_in_flight = Config::getFramesInFlight();
+    const u32 num_frames = frames_in_flight != 0 ? std::clamp(frames_in_flight, 1U, 8U)
+                                                 : swapchain.GetImageCount();
     const vk::Device device = instance.GetDevice();
 
     // Create presentation frames.
-    present_frames.resize(num_images);
-    for (u32 i = 0; i < num_images; i++) {
+    present_frames.resize(num_frames);
+    for (u32 i = 0; i < num_frames; i++) {
         Frame& frame = present_frames[i];
         auto [fence_result, fence] =
             device.createFence({.flags = vk::FenceCreateFlagBits::eSignaled});
@@ -561,8 +560,10 @@ Frame* Presenter::PrepareFrameInternal(VideoCore::ImageId image_id, bool is_eop)
     Frame* frame = GetRenderFrame();
 
     if (image_id != VideoCore::NULL_IMAGE_ID) {
+        // Frames take the size of the image as rendered, so targets rendered at a higher
+        // internal resolution are presented at that resolution.
         const auto& image = texture_cache.GetImage(image_id);
-        const auto extent = image.info.size;
+        const auto extent = image.info.ScaledSize();
         if (frame->width != extent.width || frame->height != extent.height ||
             frame->is_hdr != swapchain.GetHDR()) {
             RecreateFrame(frame, extent.width, extent.height);
@@ -659,9 +660,10 @@ Frame* Presenter::PrepareFrameInternal(VideoCore::ImageId image_id, bool is_eop)
         };
 
         cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, *pp_pipeline);
+        scheduler.GetStateTracker().InvalidateGraphics();
 
-        const auto& dst_rect =
-            FitImage(image.info.size.width, image.info.size.height, frame->width, frame->height);
+        const auto size = image.info.ScaledSize();
+        const auto& dst_rect = FitImage(size.width, size.height, frame->width, frame->height);
 
         const std::array viewports = {
             vk::Viewport{
@@ -751,8 +753,13 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
 
     ImGuiID dockId = ImGui::Core::NewFrame(is_reusing_frame);
 
+    // Without visible overlay windows the frame is copied straight to the swapchain instead of
+    // being drawn again through the ImGui pass.
+    const bool composite_overlay =
+        ImGui::Core::IsOverlayVisible() ||
+        !CanBlitToSwapchain(instance.GetPhysicalDevice(), swapchain.GetSurfaceFormat().format);
+
     const vk::Image swapchain_image = swapchain.Image();
-    const vk::ImageView swapchain_image_view = swapchain.ImageView();
 
     auto& scheduler = present_scheduler;
     const auto cmdbuf = scheduler.CommandBuffer();
@@ -768,7 +775,133 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
         TracyVkNamedZoneC(profiler_ctx, renderer_gpu_zone, cmdbuf, "Host frame",
                           MarkersPalette::GpuMarkerColor, profiler_ctx != nullptr);
 
-        const vk::Extent2D extent = swapchain.GetExtent();
+        if (!composite_overlay) {
+            BlitToSwapchain(frame, cmdbuf, swapchain_image);
+            ImGui::EndFrame();
+        } else {
+            CompositeOverlay(frame, cmdbuf, dockId);
+        }
+
+        if (profiler_ctx) {
+            TracyVkCollect(profiler_ctx, cmdbuf);
+        }
+    }
+
+    if (Config::getVkHostMarkersEnabled()) {
+        cmdbuf.endDebugUtilsLabelEXT();
+    }
+
+    // Flush vulkan commands.
+    SubmitInfo info{};
+    info.AddWait(swapchain.GetImageAcquiredSemaphore());
+    info.AddWait(frame->ready_semaphore, frame->ready_tick);
+    info.AddSignal(swapchain.GetPresentReadySemaphore());
+    info.AddSignal(frame->present_done);
+    scheduler.Flush(info);
+
+    // Present to swapchain.
+    std::scoped_lock submit_lock{Scheduler::submit_mutex};
+    if (!swapchain.Present()) {
+        swapchain.Recreate(window.GetWidth(), window.GetHeight());
+    }
+
+    free_frame();
+    if (!is_reusing_frame) {
+        DebugState.IncFlipFrameNum();
+    }
+}
+
+void Presenter::BlitToSwapchain(const Frame* frame, vk::CommandBuffer cmdbuf,
+                                vk::Image swapchain_image) {
+    const vk::Extent2D extent = swapchain.GetExtent();
+    const auto subresources = vk::ImageSubresourceRange{
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = VK_REMAINING_ARRAY_LAYERS,
+    };
+
+    const std::array pre_barriers{
+        vk::ImageMemoryBarrier2{
+            .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .srcAccessMask = vk::AccessFlagBits2::eNone,
+            .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+            .oldLayout = vk::ImageLayout::eUndefined,
+            .newLayout = vk::ImageLayout::eTransferDstOptimal,
+            .image = swapchain_image,
+            .subresourceRange = subresources,
+        },
+        vk::ImageMemoryBarrier2{
+            .srcStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+            .srcAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+            .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+            .oldLayout = vk::ImageLayout::eGeneral,
+            .newLayout = vk::ImageLayout::eTransferSrcOptimal,
+            .image = frame->image,
+            .subresourceRange = subresources,
+        },
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .imageMemoryBarrierCount = static_cast<u32>(pre_barriers.size()),
+        .pImageMemoryBarriers = pre_barriers.data(),
+    });
+
+    // Clear the letterbox area, the blit below covers the rest.
+    const vk::ClearColorValue clear_color{std::array{0.0f, 0.0f, 0.0f, 1.0f}};
+    cmdbuf.clearColorImage(swapchain_image, vk::ImageLayout::eTransferDstOptimal, clear_color,
+                           subresources);
+    const vk::MemoryBarrier2 clear_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &clear_barrier,
+    });
+
+    cmdbuf.blitImage(frame->image, vk::ImageLayout::eTransferSrcOptimal, swapchain_image,
+                     vk::ImageLayout::eTransferDstOptimal,
+                     MakeImageBlitFit(frame->width, frame->height, extent.width, extent.height),
+                     vk::Filter::eLinear);
+
+    // Leave the frame image in the layout the overlay path would have left it in.
+    const std::array post_barriers{
+        vk::ImageMemoryBarrier2{
+            .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+            .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .dstAccessMask = vk::AccessFlagBits2::eMemoryRead,
+            .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+            .newLayout = vk::ImageLayout::ePresentSrcKHR,
+            .image = swapchain_image,
+            .subresourceRange = subresources,
+        },
+        vk::ImageMemoryBarrier2{
+            .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .srcAccessMask = vk::AccessFlagBits2::eTransferRead,
+            .dstStageMask = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+            .dstAccessMask = vk::AccessFlagBits2::eColorAttachmentWrite,
+            .oldLayout = vk::ImageLayout::eTransferSrcOptimal,
+            .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+            .image = frame->image,
+            .subresourceRange = subresources,
+        },
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .imageMemoryBarrierCount = static_cast<u32>(post_barriers.size()),
+        .pImageMemoryBarriers = post_barriers.data(),
+    });
+}
+
+void Presenter::CompositeOverlay(Frame* frame, vk::CommandBuffer cmdbuf, u32 dock_id) {
+    const vk::Image swapchain_image = swapchain.Image();
+    const vk::ImageView swapchain_image_view = swapchain.ImageView();
+    {
         const std::array pre_barriers{
             vk::ImageMemoryBarrier{
                 .srcAccessMask = vk::AccessFlagBits::eNone,
@@ -830,7 +963,7 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
             ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
             ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
             ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
-            ImGui::SetNextWindowDockID(dockId, ImGuiCond_Once);
+            ImGui::SetNextWindowDockID(dock_id, ImGuiCond_Once);
             ImGui::Begin("Display##game_display", nullptr, ImGuiWindowFlags_NoNav);
 
             ImVec2 contentArea = ImGui::GetContentRegionAvail();
@@ -853,33 +986,6 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
         cmdbuf.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
                                vk::PipelineStageFlagBits::eAllCommands,
                                vk::DependencyFlagBits::eByRegion, {}, {}, post_barrier);
-
-        if (profiler_ctx) {
-            TracyVkCollect(profiler_ctx, cmdbuf);
-        }
-    }
-
-    if (Config::getVkHostMarkersEnabled()) {
-        cmdbuf.endDebugUtilsLabelEXT();
-    }
-
-    // Flush vulkan commands.
-    SubmitInfo info{};
-    info.AddWait(swapchain.GetImageAcquiredSemaphore());
-    info.AddWait(frame->ready_semaphore, frame->ready_tick);
-    info.AddSignal(swapchain.GetPresentReadySemaphore());
-    info.AddSignal(frame->present_done);
-    scheduler.Flush(info);
-
-    // Present to swapchain.
-    std::scoped_lock submit_lock{Scheduler::submit_mutex};
-    if (!swapchain.Present()) {
-        swapchain.Recreate(window.GetWidth(), window.GetHeight());
-    }
-
-    free_frame();
-    if (!is_reusing_frame) {
-        DebugState.IncFlipFrameNum();
     }
 }
 
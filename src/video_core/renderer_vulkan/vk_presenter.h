@@ -120,6 +120,8 @@ private:
     void CreatePostProcessPipeline();
     Frame* PrepareFrameInternal(VideoCore::ImageId image_id, bool is_eop = true);
     Frame* GetRenderFrame();
+    void BlitToSwapchain(const Frame* frame, vk::CommandBuffer cmdbuf, vk::Image swapchain_image);
+    void CompositeOverlay(Frame* frame, vk::CommandBuffer cmdbuf, u32 dock_id);
 
 private:
     PostProcessSettings pp_settings{};
@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cmath>
+
 #include "common/config.h"
 #include "common/debug.h"
 #include "core/memory.h"
@@ -19,7 +22,26 @@
 
 namespace Vulkan {
 
-static Shader::PushData MakeUserData(const AmdGpu::Liverpool::Regs& regs) {
+static vk::PipelineStageFlags2 ShaderPipelineStage(Shader::LogicalStage stage) {
+    switch (stage) {
+    case Shader::LogicalStage::Fragment:
+        return vk::PipelineStageFlagBits2::eFragmentShader;
+    case Shader::LogicalStage::TessellationControl:
+        return vk::PipelineStageFlagBits2::eTessellationControlShader;
+    case Shader::LogicalStage::TessellationEval:
+        return vk::PipelineStageFlagBits2::eTessellationEvaluationShader;
+    case Shader::LogicalStage::Vertex:
+        return vk::PipelineStageFlagBits2::eVertexShader;
+    case Shader::LogicalStage::Geometry:
+        return vk::PipelineStageFlagBits2::eGeometryShader;
+    case Shader::LogicalStage::Compute:
+        return vk::PipelineStageFlagBits2::eComputeShader;
+    default:
+        return VideoCore::AnyShaderStage;
+    }
+}
+
+static Shader::PushData MakeUserData(const AmdGpu::Liverpool::Regs& regs, float render_scale) {
     Shader::PushData push_data{};
     push_data.step0 = regs.vgt_instance_step_rate_0;
     push_data.step1 = regs.vgt_instance_step_rate_1;
@@ -30,6 +52,7 @@ static Shader::PushData MakeUserData(const AmdGpu::Liverpool::Regs& regs) {
     push_data.xscale = regs.viewport_control.xscale_enable ? regs.viewports[0].xscale : 1.f;
     push_data.yoffset = regs.viewport_control.yoffset_enable ? regs.viewports[0].yoffset : 0.f;
     push_data.yscale = regs.viewport_control.yscale_enable ? regs.viewports[0].yscale : 1.f;
+    push_data.render_scale = render_scale;
     return push_data;
 }
 
@@ -38,10 +61,9 @@ Rasterizer::Rasterizer(const Instance& instance_, Scheduler& scheduler_,
     : instance{instance_}, scheduler{scheduler_}, page_manager{this},
       buffer_cache{instance, scheduler, liverpool_, texture_cache, page_manager},
       texture_cache{instance, scheduler, buffer_cache, page_manager}, liverpool{liverpool_},
-      memory{Core::Memory::Instance()}, pipeline_cache{instance, scheduler, liverpool} {
-    if (!Config::nullGpu()) {
-        liverpool->BindRasterizer(this);
-    }
+      memory{Core::Memory::Instance()}, pipeline_cache{instance, scheduler, liverpool},
+      resolve_pass{instance, scheduler} {
+    liverpool->BindRasterizer(this);
     memory->SetRasterizer(this);
 }
 
@@ -117,6 +139,18 @@ RenderState Rasterizer::PrepareRenderState(u32 mrt_mask) {
     cb_descs.clear();
     db_desc.reset();
 
+    // Metadata is only touched once the targets are final, as they may be looked up again.
+    boost::container::static_vector<std::pair<VAddr, u32>, Liverpool::NumColorBuffers + 1>
+        touched_metas;
+    const size_t num_bound_images = bound_images.size();
+    std::optional<float> target_scale;
+    bool scale_mismatch = false;
+    const auto add_target_scale = [&](const VideoCore::Image& image) {
+        const float scale = image.info.resolution_scale;
+        scale_mismatch |= target_scale && *target_scale != scale;
+        target_scale = scale;
+    };
+
     const auto& regs = liverpool->regs;
 
     if (regs.color_control.degamma_enable) {
@@ -157,11 +191,13 @@ RenderState Rasterizer::PrepareRenderState(u32 mrt_mask) {
 
         const auto slice = image_view.info.range.base.layer;
         const bool is_clear = texture_cache.IsMetaCleared(col_buf.CmaskAddress(), slice);
-        texture_cache.TouchMeta(col_buf.CmaskAddress(), slice, false);
+        touched_metas.emplace_back(col_buf.CmaskAddress(), slice);
 
         const auto mip = image_view.info.range.base.level;
-        state.width = std::min<u32>(state.width, std::max(image.info.size.width >> mip, 1u));
-        state.height = std::min<u32>(state.height, std::max(image.info.size.height >> mip, 1u));
+        const auto size = image.info.ScaledSize();
+        state.width = std::min<u32>(state.width, std::max(size.width >> mip, 1u));
+        state.height = std::min<u32>(state.height, std::max(size.height >> mip, 1u));
+        add_target_scale(image);
         state.color_attachments[state.num_color_attachments++] = {
             .imageView = *image_view.image_view,
             .imageLayout = vk::ImageLayout::eUndefined,
@@ -191,8 +227,10 @@ RenderState Rasterizer::PrepareRenderState(u32 mrt_mask) {
         const bool is_stencil_clear = regs.depth_render_control.stencil_clear_enable;
         ASSERT(desc.view_info.range.extent.levels == 1);
 
-        state.width = std::min<u32>(state.width, image.info.size.width);
-        state.height = std::min<u32>(state.height, image.info.size.height);
+        const auto size = image.info.ScaledSize();
+        state.width = std::min<u32>(state.width, size.width);
+        state.height = std::min<u32>(state.height, size.height);
+        add_target_scale(image);
         state.has_depth = regs.depth_buffer.DepthValid();
         state.has_stencil = regs.depth_buffer.StencilValid();
         if (state.has_depth) {
@@ -215,9 +253,33 @@ RenderState Rasterizer::PrepareRenderState(u32 mrt_mask) {
                 .clearValue = vk::ClearValue{.depthStencil = {.stencil = regs.stencil_clear}},
             };
         }
-        texture_cache.TouchMeta(htile_address, slice, false);
+        touched_metas.emplace_back(htile_address, slice);
     }
 
+    if (scale_mismatch) {
+        // All attachments of a pass have to be rendered at the same resolution. Bring the scaled
+        // ones back to guest resolution and look the targets up again.
+        boost::container::static_vector<VideoCore::ImageId, Liverpool::NumColorBuffers + 1>
+            scaled_images;
+        for (size_t i = num_bound_images; i < bound_images.size(); ++i) {
+            auto& image = texture_cache.GetImage(bound_images[i]);
+            image.binding.Reset();
+            if (image.info.IsScaled() && std::ranges::find(scaled_images, bound_images[i]) ==
+                                             scaled_images.end()) {
+                scaled_images.push_back(bound_images[i]);
+            }
+        }
+        bound_images.resize(num_bound_images);
+        for (const auto image_id : scaled_images) {
+            static_cast<void>(texture_cache.ScaleDown(image_id));
+        }
+        return PrepareRenderState(mrt_mask);
+    }
+
+    for (const auto& [address, slice] : touched_metas) {
+        texture_cache.TouchMeta(address, slice, false);
+    }
+    render_scale = target_scale.value_or(1.0f);
     return state;
 }
 
@@ -237,6 +299,27 @@ RenderState Rasterizer::PrepareRenderState(u32 mrt_mask) {
     return {vertex_offset, instance_offset};
 }
 
+bool Rasterizer::IsQuadListExpandable(bool is_indexed, u32 index_offset) {
+    // Quad lists are drawn as triangle lists when the host indices can be built on the CPU,
+    // otherwise they go through the auxiliary tessellation stages.
+    const auto& regs = liverpool->regs;
+    if (regs.primitive_type != AmdGpu::PrimitiveType::QuadList || regs.stage_enable.hs_en) {
+        return false;
+    }
+    if (!is_indexed) {
+        return true;
+    }
+    if (regs.enable_primitive_restart & 1) {
+        return false;
+    }
+    const bool is_index16 =
+        regs.index_buffer_type.index_type == AmdGpu::Liverpool::IndexType::Index16;
+    const u32 index_size = is_index16 ? sizeof(u16) : sizeof(u32);
+    const VAddr index_address =
+        regs.index_base_address.Address<VAddr>() + index_offset * index_size;
+    return !buffer_cache.IsRegionGpuModified(index_address, regs.num_indices * index_size);
+}
+
 void Rasterizer::EliminateFastClear() {
     auto& col_buf = liverpool->regs.color_buffers[0];
     if (!col_buf || !col_buf.info.fast_clear) {
@@ -277,7 +360,8 @@ void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
     }
 
     const auto& regs = liverpool->regs;
-    const GraphicsPipeline* pipeline = pipeline_cache.GetGraphicsPipeline();
+    const bool expand_quad_list = IsQuadListExpandable(is_indexed, index_offset);
+    const GraphicsPipeline* pipeline = pipeline_cache.GetGraphicsPipeline(expand_quad_list);
     if (!pipeline) {
         return;
     }
@@ -288,7 +372,10 @@ void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
     }
 
     buffer_cache.BindVertexBuffers(*pipeline);
-    if (is_indexed) {
+    u32 num_indices = regs.num_indices;
+    if (expand_quad_list) {
+        num_indices = buffer_cache.BindQuadListIndexBuffer(is_indexed, index_offset);
+    } else if (is_indexed) {
         buffer_cache.BindIndexBuffer(index_offset);
     }
 
@@ -300,10 +387,11 @@ void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
     const auto [vertex_offset, instance_offset] = GetDrawOffsets(regs, vs_info, fetch_shader);
 
     const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->Handle());
+    scheduler.GetStateTracker().BindGraphicsPipeline(pipeline->Handle());
+    pipeline_cache.OnGraphicsPipelineBound(pipeline);
 
-    if (is_indexed) {
-        cmdbuf.drawIndexed(regs.num_indices, regs.num_instances.NumInstances(), 0,
+    if (is_indexed || expand_quad_list) {
+        cmdbuf.drawIndexed(num_indices, regs.num_instances.NumInstances(), 0,
                            s32(vertex_offset), instance_offset);
     } else {
         cmdbuf.draw(regs.num_indices, regs.num_instances.NumInstances(), vertex_offset,
@@ -336,13 +424,17 @@ void Rasterizer::DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u3
         buffer_cache.BindIndexBuffer(0);
     }
 
-    const auto& [buffer, base] =
+    // Handles are read right away, stream buffers may be reallocated by following requests.
+    const auto [args_buffer, base] =
         buffer_cache.ObtainBuffer(arg_address + offset, stride * max_count, false);
+    const vk::Buffer buffer = args_buffer->Handle();
 
-    VideoCore::Buffer* count_buffer{};
+    vk::Buffer count_buffer{};
     u32 count_base{};
     if (count_address != 0) {
-        std::tie(count_buffer, count_base) = buffer_cache.ObtainBuffer(count_address, 4, false);
+        const auto [count_buf, count_offset] = buffer_cache.ObtainBuffer(count_address, 4, false);
+        count_buffer = count_buf->Handle();
+        count_base = count_offset;
     }
 
     BeginRendering(*pipeline, state);
@@ -352,25 +444,25 @@ void Rasterizer::DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u3
     // instance offsets will be automatically applied by Vulkan from indirect args buffer.
 
     const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->Handle());
+    scheduler.GetStateTracker().BindGraphicsPipeline(pipeline->Handle());
+    pipeline_cache.OnGraphicsPipelineBound(pipeline);
 
     if (is_indexed) {
         ASSERT(sizeof(VkDrawIndexedIndirectCommand) == stride);
 
         if (count_address != 0) {
-            cmdbuf.drawIndexedIndirectCount(buffer->Handle(), base, count_buffer->Handle(),
-                                            count_base, max_count, stride);
+            cmdbuf.drawIndexedIndirectCount(buffer, base, count_buffer, count_base, max_count,
+                                            stride);
         } else {
-            cmdbuf.drawIndexedIndirect(buffer->Handle(), base, max_count, stride);
+            cmdbuf.drawIndexedIndirect(buffer, base, max_count, stride);
         }
     } else {
         ASSERT(sizeof(VkDrawIndirectCommand) == stride);
 
         if (count_address != 0) {
-            cmdbuf.drawIndirectCount(buffer->Handle(), base, count_buffer->Handle(), count_base,
-                                     max_count, stride);
+            cmdbuf.drawIndirectCount(buffer, base, count_buffer, count_base, max_count, stride);
         } else {
-            cmdbuf.drawIndirect(buffer->Handle(), base, max_count, stride);
+            cmdbuf.drawIndirect(buffer, base, max_count, stride);
         }
     }
 
@@ -398,7 +490,7 @@ void Rasterizer::DispatchDirect() {
     scheduler.EndRendering();
 
     const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->Handle());
+    scheduler.GetStateTracker().BindComputePipeline(pipeline->Handle());
     cmdbuf.dispatch(cs_program.dim_x, cs_program.dim_y, cs_program.dim_z);
 
     ResetBindings();
@@ -422,7 +514,7 @@ void Rasterizer::DispatchIndirect(VAddr address, u32 offset, u32 size) {
     const auto [buffer, base] = buffer_cache.ObtainBuffer(address + offset, size, false);
 
     const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->Handle());
+    scheduler.GetStateTracker().BindComputePipeline(pipeline->Handle());
     cmdbuf.dispatchIndirect(buffer->Handle(), base);
 
     ResetBindings();
@@ -447,11 +539,12 @@ bool Rasterizer::BindResources(const Pipeline* pipeline) {
     set_writes.clear();
     buffer_barriers.clear();
     buffer_infos.clear();
+    buffer_addresses.clear();
     image_infos.clear();
 
     // Bind resource buffers and textures.
     Shader::Backend::Bindings binding{};
-    Shader::PushData push_data = MakeUserData(liverpool->regs);
+    Shader::PushData push_data = MakeUserData(liverpool->regs, render_scale);
     for (const auto* stage : pipeline->GetStages()) {
         if (!stage) {
             continue;
@@ -461,7 +554,8 @@ bool Rasterizer::BindResources(const Pipeline* pipeline) {
         BindTextures(*stage, binding);
     }
 
-    pipeline->BindResources(set_writes, buffer_barriers, push_data);
+    pipeline->BindResources(set_writes, buffer_barriers, push_data, buffer_infos,
+                            buffer_addresses);
     return true;
 }
 
@@ -520,12 +614,14 @@ void Rasterizer::BindBuffers(const Shader::Info& stage, Shader::Backend::Binding
             if (desc.buffer_type == Shader::BufferType::GdsBuffer) {
                 const auto* gds_buf = buffer_cache.GetGdsBuffer();
                 buffer_infos.emplace_back(gds_buf->Handle(), 0, gds_buf->SizeBytes());
+                buffer_addresses.emplace_back(gds_buf->DeviceAddress());
             } else if (desc.buffer_type == Shader::BufferType::ReadConstUbo) {
                 auto& vk_buffer = buffer_cache.GetStreamBuffer();
                 const u32 ubo_size = stage.flattened_ud_buf.size() * sizeof(u32);
                 const u64 offset = vk_buffer.Copy(stage.flattened_ud_buf.data(), ubo_size,
                                                   instance.UniformMinAlignment());
                 buffer_infos.emplace_back(vk_buffer.Handle(), offset, ubo_size);
+                buffer_addresses.emplace_back(vk_buffer.DeviceAddress());
             } else if (desc.buffer_type == Shader::BufferType::SharedMemory) {
                 auto& lds_buffer = buffer_cache.GetStreamBuffer();
                 const auto& cs_program = liverpool->GetCsRegs();
@@ -534,11 +630,14 @@ void Rasterizer::BindBuffers(const Shader::Info& stage, Shader::Backend::Binding
                     lds_buffer.Map(lds_size, instance.StorageMinAlignment());
                 std::memset(data, 0, lds_size);
                 buffer_infos.emplace_back(lds_buffer.Handle(), offset, lds_size);
+                buffer_addresses.emplace_back(lds_buffer.DeviceAddress());
             } else if (instance.IsNullDescriptorSupported()) {
                 buffer_infos.emplace_back(VK_NULL_HANDLE, 0, VK_WHOLE_SIZE);
+                buffer_addresses.emplace_back(0);
             } else {
                 auto& null_buffer = buffer_cache.GetBuffer(VideoCore::NULL_BUFFER_ID);
-                buffer_infos.emplace_back(null_buffer.Handle(), 0, VK_WHOLE_SIZE);
+                buffer_infos.emplace_back(null_buffer.Handle(), 0, null_buffer.SizeBytes());
+                buffer_addresses.emplace_back(null_buffer.DeviceAddress());
             }
         } else {
             const auto [vk_buffer, offset] = buffer_cache.ObtainBuffer(
@@ -550,6 +649,7 @@ void Rasterizer::BindBuffers(const Shader::Info& stage, Shader::Backend::Binding
             ASSERT(adjust % 4 == 0);
             push_data.AddOffset(binding.buffer, adjust);
             buffer_infos.emplace_back(vk_buffer->Handle(), offset_aligned, size + adjust);
+            buffer_addresses.emplace_back(vk_buffer->DeviceAddress());
             if (auto barrier =
                     vk_buffer->GetBarrier(desc.is_written ? vk::AccessFlagBits2::eShaderWrite
                                                           : vk::AccessFlagBits2::eShaderRead,
@@ -598,6 +698,13 @@ void Rasterizer::BindTextures(const Shader::Info& stage, Shader::Backend::Bindin
             image_id = image->depth_id;
             image = &texture_cache.GetImage(image_id);
         }
+        if (image->info.IsScaled() && (image_desc.is_texel_access || image_desc.is_written) &&
+            !image->binding.is_target) {
+            // The shader addresses the image in guest texels, so it has to stay at guest
+            // resolution from now on.
+            image_id = texture_cache.ScaleDown(image_id);
+            image = &texture_cache.GetImage(image_id);
+        }
         if (image->binding.is_bound) {
             // The image is already bound. In case if it is about to be used as storage we need
             // to force general layout on it.
@@ -611,8 +718,28 @@ void Rasterizer::BindTextures(const Shader::Info& stage, Shader::Backend::Bindin
         image->binding.is_bound = 1u;
     }
 
-    // Second pass to re-bind images that were updated after binding
+    // Second pass to re-bind images that were updated after binding. Lookups may upload or
+    // copy images, so they all happen before any transition is batched.
+    boost::container::static_vector<vk::ImageView, Shader::NumImages> image_views;
     for (auto& [image_id, desc] : image_bindings) {
+        if (!image_id) {
+            image_views.emplace_back();
+            continue;
+        }
+        if (auto& old_image = texture_cache.GetImage(image_id); old_image.binding.needs_rebind) {
+            old_image.binding.Reset(); // clean up previous image binding state
+            image_id = texture_cache.FindImage(desc);
+        }
+
+        bound_images.emplace_back(image_id);
+        image_views.emplace_back(*texture_cache.FindTexture(image_id, desc.view_info).image_view);
+    }
+
+    // Transitions of all images of the stage are recorded as one dependency.
+    const auto shader_stage = ShaderPipelineStage(stage.l_stage);
+    VideoCore::ImageBarrierBatch barriers{scheduler};
+    for (size_t i = 0; i < image_bindings.size(); ++i) {
+        const auto& [image_id, desc] = image_bindings[i];
         bool is_storage = desc.type == VideoCore::TextureCache::BindingType::Storage;
         if (!image_id) {
             if (instance.IsNullDescriptorSupported()) {
@@ -623,43 +750,32 @@ void Rasterizer::BindTextures(const Shader::Info& stage, Shader::Backend::Bindin
                                          vk::ImageLayout::eGeneral);
             }
         } else {
-            if (auto& old_image = texture_cache.GetImage(image_id);
-                old_image.binding.needs_rebind) {
-                old_image.binding.Reset(); // clean up previous image binding state
-                image_id = texture_cache.FindImage(desc);
-            }
-
-            bound_images.emplace_back(image_id);
-
             auto& image = texture_cache.GetImage(image_id);
-            auto& image_view = texture_cache.FindTexture(image_id, desc.view_info);
-
             if (image.binding.force_general || image.binding.is_target) {
                 image.Transit(vk::ImageLayout::eGeneral,
                               vk::AccessFlagBits2::eShaderRead |
                                   (image.info.IsDepthStencil()
                                        ? vk::AccessFlagBits2::eDepthStencilAttachmentWrite
                                        : vk::AccessFlagBits2::eColorAttachmentWrite),
-                              {});
+                              {}, barriers, shader_stage);
             } else {
                 if (is_storage) {
                     image.Transit(vk::ImageLayout::eGeneral,
                                   vk::AccessFlagBits2::eShaderRead |
                                       vk::AccessFlagBits2::eShaderWrite,
-                                  desc.view_info.range);
+                                  desc.view_info.range, barriers, shader_stage);
                 } else {
                     const auto new_layout = image.info.IsDepthStencil()
                                                 ? vk::ImageLayout::eDepthStencilReadOnlyOptimal
                                                 : vk::ImageLayout::eShaderReadOnlyOptimal;
                     image.Transit(new_layout, vk::AccessFlagBits2::eShaderRead,
-                                  desc.view_info.range);
+                                  desc.view_info.range, barriers, shader_stage);
                 }
             }
             image.usage.storage |= is_storage;
             image.usage.texture |= !is_storage;
 
-            image_infos.emplace_back(VK_NULL_HANDLE, *image_view.image_view,
-                                     image.last_state.layout);
+            image_infos.emplace_back(VK_NULL_HANDLE, image_views[i], image.last_state.layout);
         }
 
         set_writes.push_back({
@@ -672,6 +788,7 @@ void Rasterizer::BindTextures(const Shader::Info& stage, Shader::Backend::Bindin
             .pImageInfo = &image_infos.back(),
         });
     }
+    barriers.Flush();
 
     for (const auto& sampler : stage.samplers) {
         auto ssharp = sampler.GetSharp(stage);
@@ -706,20 +823,29 @@ void Rasterizer::BeginRendering(const GraphicsPipeline& pipeline, RenderState& s
             state.color_attachments[cb_index].imageLayout = image.last_state.layout;
 
             const auto mip = view.info.range.base.level;
-            state.width = std::min<u32>(state.width, std::max(image.info.size.width >> mip, 1u));
-            state.height = std::min<u32>(state.height, std::max(image.info.size.height >> mip, 1u));
+            const auto size = image.info.ScaledSize();
+            state.width = std::min<u32>(state.width, std::max(size.width >> mip, 1u));
+            state.height = std::min<u32>(state.height, std::max(size.height >> mip, 1u));
         }
+        ++cb_index;
+    }
+
+    // Attachment transitions are recorded as one dependency after all lookups.
+    VideoCore::ImageBarrierBatch barriers{scheduler};
+    cb_index = 0;
+    for (auto& [image_id, desc] : cb_descs) {
         auto& image = texture_cache.GetImage(image_id);
         if (image.binding.force_general) {
             image.Transit(
                 vk::ImageLayout::eGeneral,
-                vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eShaderRead, {});
+                vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eShaderRead, {},
+                barriers);
 
         } else {
             image.Transit(vk::ImageLayout::eColorAttachmentOptimal,
                           vk::AccessFlagBits2::eColorAttachmentWrite |
                               vk::AccessFlagBits2::eColorAttachmentRead,
-                          desc.view_info.range);
+                          desc.view_info.range, barriers);
         }
         image.usage.render_target = 1u;
         state.color_attachments[cb_index].imageLayout = image.last_state.layout;
@@ -739,7 +865,7 @@ void Rasterizer::BeginRendering(const GraphicsPipeline& pipeline, RenderState& s
             image.Transit(vk::ImageLayout::eGeneral,
                           vk::AccessFlagBits2::eDepthStencilAttachmentWrite |
                               vk::AccessFlagBits2::eShaderRead,
-                          {});
+                          {}, barriers);
         } else {
             const auto new_layout = desc.view_info.is_storage
                                         ? has_stencil
@@ -750,47 +876,153 @@ void Rasterizer::BeginRendering(const GraphicsPipeline& pipeline, RenderState& s
             image.Transit(new_layout,
                           vk::AccessFlagBits2::eDepthStencilAttachmentWrite |
                               vk::AccessFlagBits2::eDepthStencilAttachmentRead,
-                          desc.view_info.range);
+                          desc.view_info.range, barriers);
         }
         state.depth_attachment.imageLayout = image.last_state.layout;
         state.stencil_attachment.imageLayout = image.last_state.layout;
         image.usage.depth_target = true;
         image.usage.stencil = has_stencil;
     }
+    barriers.Flush();
 
     scheduler.BeginRendering(state);
 }
 
+vk::Extent2D Rasterizer::GetResolveExtent(u32 col_buf_id, const VideoCore::Image& image) const {
+    const auto& regs = liverpool->regs;
+    u32 width = image.info.size.width;
+    u32 height = image.info.size.height;
+
+    // Only the area the guest has actually rendered to needs to be resolved or copied.
+    const auto& hint = liverpool->last_cb_extent[col_buf_id];
+    if (hint.Valid()) {
+        width = std::min<u32>(width, hint.width);
+        height = std::min<u32>(height, hint.height);
+    }
+    const auto& scissor = regs.screen_scissor;
+    if (scissor.GetWidth() != 0 && scissor.GetHeight() != 0) {
+        width = std::min<u32>(width, Liverpool::Scissor::Clamp(scissor.bottom_right_x));
+        height = std::min<u32>(height, Liverpool::Scissor::Clamp(scissor.bottom_right_y));
+    }
+    return {std::max(width, 1u), std::max(height, 1u)};
+}
+
+void Rasterizer::MatchResolution(VideoCore::ImageId& lhs_id, VideoCore::ImageId& rhs_id) {
+    const auto& lhs_info = texture_cache.GetImage(lhs_id).info;
+    const auto& rhs_info = texture_cache.GetImage(rhs_id).info;
+    if (lhs_info.resolution_scale == rhs_info.resolution_scale) {
+        return;
+    }
+    // Copies and resolves require matching extents, fall back to guest resolution.
+    const bool lhs_scaled = lhs_info.IsScaled();
+    const bool rhs_scaled = rhs_info.IsScaled();
+    if (lhs_scaled) {
+        lhs_id = texture_cache.ScaleDown(lhs_id);
+    }
+    if (rhs_scaled) {
+        rhs_id = texture_cache.ScaleDown(rhs_id);
+    }
+}
+
 void Rasterizer::Resolve() {
     // Read from MRT0, average all samples, and write to MRT1, which is one-sample
+    const auto& mrt0_buffer = liverpool->regs.color_buffers[0];
+    const auto& mrt1_buffer = liverpool->regs.color_buffers[1];
     const auto& mrt0_hint = liverpool->last_cb_extent[0];
     const auto& mrt1_hint = liverpool->last_cb_extent[1];
-    VideoCore::TextureCache::RenderTargetDesc mrt0_desc{liverpool->regs.color_buffers[0],
-                                                        mrt0_hint};
-    VideoCore::TextureCache::RenderTargetDesc mrt1_desc{liverpool->regs.color_buffers[1],
-                                                        mrt1_hint};
-    auto& mrt0_image =
-        texture_cache.GetImage(texture_cache.FindImage(mrt0_desc, VideoCore::FindFlags::ExactFmt));
-    auto& mrt1_image =
-        texture_cache.GetImage(texture_cache.FindImage(mrt1_desc, VideoCore::FindFlags::ExactFmt));
+    VideoCore::TextureCache::RenderTargetDesc mrt0_desc{mrt0_buffer, mrt0_hint};
+    VideoCore::TextureCache::RenderTargetDesc mrt1_desc{mrt1_buffer, mrt1_hint};
+    auto mrt0_image_id = texture_cache.FindImage(mrt0_desc, VideoCore::FindFlags::ExactFmt);
+    auto mrt1_image_id = texture_cache.FindImage(mrt1_desc, VideoCore::FindFlags::ExactFmt);
+    MatchResolution(mrt0_image_id, mrt1_image_id);
+    auto& mrt0_image = texture_cache.GetImage(mrt0_image_id);
+    auto& mrt1_image = texture_cache.GetImage(mrt1_image_id);
 
     VideoCore::SubresourceRange mrt0_range;
-    mrt0_range.base.layer = liverpool->regs.color_buffers[0].view.slice_start;
-    mrt0_range.extent.layers = liverpool->regs.color_buffers[0].NumSlices() - mrt0_range.base.layer;
+    mrt0_range.base.layer = mrt0_buffer.view.slice_start;
+    mrt0_range.extent.layers = mrt0_buffer.NumSlices() - mrt0_range.base.layer;
     VideoCore::SubresourceRange mrt1_range;
-    mrt1_range.base.layer = liverpool->regs.color_buffers[1].view.slice_start;
-    mrt1_range.extent.layers = liverpool->regs.color_buffers[1].NumSlices() - mrt1_range.base.layer;
+    mrt1_range.base.layer = mrt1_buffer.view.slice_start;
+    mrt1_range.extent.layers = mrt1_buffer.NumSlices() - mrt1_range.base.layer;
+
+    auto extent = GetResolveExtent(1, mrt1_image);
+    extent.width = mrt1_image.info.Scale(std::min(extent.width, mrt0_image.info.size.width));
+    extent.height = mrt1_image.info.Scale(std::min(extent.height, mrt0_image.info.size.height));
+    const bool is_msaa = mrt0_image.info.num_samples > 1;
+    const bool is_single_layer = mrt0_range.extent.layers == 1 && mrt1_range.extent.layers == 1;
+    const bool same_format = mrt0_desc.view_info.format == mrt1_desc.view_info.format;
+
+    ScopeMarkerBegin(fmt::format("Resolve:MRT0={:#x}:MRT1={:#x}", mrt0_buffer.Address(),
+                                 mrt1_buffer.Address()));
+
+    if (is_msaa && is_single_layer && same_format) {
+        // Resolve as part of a rendering scope. MRT0 is usually still in the attachment layout
+        // from the previous pass, so this avoids transfer layout transitions on both images.
+        const auto mrt0_view = *texture_cache.FindTexture(mrt0_image_id, mrt0_desc.view_info)
+                                    .image_view;
+        const auto mrt1_view = *texture_cache.FindTexture(mrt1_image_id, mrt1_desc.view_info)
+                                    .image_view;
+        const auto attachment_access = vk::AccessFlagBits2::eColorAttachmentWrite |
+                                       vk::AccessFlagBits2::eColorAttachmentRead;
+        mrt0_image.Transit(vk::ImageLayout::eColorAttachmentOptimal, attachment_access,
+                           mrt0_range);
+        mrt1_image.Transit(vk::ImageLayout::eColorAttachmentOptimal, attachment_access,
+                           mrt1_range);
+
+        const auto number_fmt = mrt0_buffer.GetNumberFmt();
+        const bool is_integer =
+            number_fmt == AmdGpu::NumberFormat::Uint || number_fmt == AmdGpu::NumberFormat::Sint;
+
+        RenderState state{};
+        state.color_attachments[0] = {
+            .imageView = mrt0_view,
+            .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+            .resolveMode = is_integer ? vk::ResolveModeFlagBits::eSampleZero
+                                      : vk::ResolveModeFlagBits::eAverage,
+            .resolveImageView = mrt1_view,
+            .resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+            .loadOp = vk::AttachmentLoadOp::eLoad,
+            .storeOp = vk::AttachmentStoreOp::eStore,
+        };
+        state.num_color_attachments = 1;
+        state.width = extent.width;
+        state.height = extent.height;
+        scheduler.BeginRendering(state);
+        scheduler.EndRendering();
+        ScopeMarkerEnd();
+        return;
+    }
 
-    ScopeMarkerBegin(fmt::format("Resolve:MRT0={:#x}:MRT1={:#x}",
-                                 liverpool->regs.color_buffers[0].Address(),
-                                 liverpool->regs.color_buffers[1].Address()));
+    // The resolve shader samples MRT0 as float and writes a float color to MRT1.
+    const auto is_integer_fmt = [](AmdGpu::NumberFormat number_fmt) {
+        return number_fmt == AmdGpu::NumberFormat::Uint ||
+               number_fmt == AmdGpu::NumberFormat::Sint;
+    };
+    const bool is_integer =
+        is_integer_fmt(mrt0_buffer.GetNumberFmt()) || is_integer_fmt(mrt1_buffer.GetNumberFmt());
+    if (is_msaa && is_single_layer && !is_integer) {
+        // vkCmdResolveImage requires matching formats, resolve in a shader instead.
+        const auto mrt0_view = *texture_cache.FindTexture(mrt0_image_id, mrt0_desc.view_info)
+                                    .image_view;
+        const auto mrt1_view = *texture_cache.FindTexture(mrt1_image_id, mrt1_desc.view_info)
+                                    .image_view;
+        mrt0_image.Transit(vk::ImageLayout::eShaderReadOnlyOptimal,
+                           vk::AccessFlagBits2::eShaderRead, mrt0_range);
+        mrt1_image.Transit(vk::ImageLayout::eColorAttachmentOptimal,
+                           vk::AccessFlagBits2::eColorAttachmentWrite, mrt1_range);
+        resolve_pass.Resolve(mrt0_view, mrt0_image.info.num_samples, mrt1_view,
+                             mrt1_desc.view_info.format, extent);
+        scheduler.EndRendering();
+        ScopeMarkerEnd();
+        return;
+    }
 
     mrt0_image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead,
                        mrt0_range);
     mrt1_image.Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite,
                        mrt1_range);
 
-    if (mrt0_image.info.num_samples == 1) {
+    if (!is_msaa) {
         // Vulkan does not allow resolve from a single sample image, so change it to a copy.
         // Note that resolving a single-sampled image doesn't really make sense, but a game might do
         // it.
@@ -811,7 +1043,7 @@ void Rasterizer::Resolve() {
                     .layerCount = mrt1_range.extent.layers,
                 },
             .dstOffset = {0, 0, 0},
-            .extent = {mrt1_image.info.size.width, mrt1_image.info.size.height, 1},
+            .extent = {extent.width, extent.height, 1},
         };
         scheduler.CommandBuffer().copyImage(mrt0_image.image, vk::ImageLayout::eTransferSrcOptimal,
                                             mrt1_image.image, vk::ImageLayout::eTransferDstOptimal,
@@ -834,7 +1066,7 @@ void Rasterizer::Resolve() {
                     .layerCount = mrt1_range.extent.layers,
                 },
             .dstOffset = {0, 0, 0},
-            .extent = {mrt1_image.info.size.width, mrt1_image.info.size.height, 1},
+            .extent = {extent.width, extent.height, 1},
         };
         scheduler.CommandBuffer().resolveImage(
             mrt0_image.image, vk::ImageLayout::eTransferSrcOptimal, mrt1_image.image,
@@ -854,8 +1086,11 @@ void Rasterizer::DepthStencilCopy(bool is_depth, bool is_stencil) {
         regs.depth_buffer, regs.depth_view, regs.depth_control,
         regs.depth_htile_data_base.GetAddress(), liverpool->last_db_extent, true);
 
-    auto& read_image = texture_cache.GetImage(texture_cache.FindImage(read_desc));
-    auto& write_image = texture_cache.GetImage(texture_cache.FindImage(write_desc));
+    auto read_image_id = texture_cache.FindImage(read_desc);
+    auto write_image_id = texture_cache.FindImage(write_desc);
+    MatchResolution(read_image_id, write_image_id);
+    auto& read_image = texture_cache.GetImage(read_image_id);
+    auto& write_image = texture_cache.GetImage(write_image_id);
 
     VideoCore::SubresourceRange sub_range;
     sub_range.base.layer = liverpool->regs.depth_view.slice_start;
@@ -871,6 +1106,14 @@ void Rasterizer::DepthStencilCopy(bool is_depth, bool is_stencil) {
     write_image.Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite,
                         sub_range);
 
+    // Limit the copy to the area the guest has rendered to.
+    u32 width = std::min(read_image.info.size.width, write_image.info.size.width);
+    u32 height = std::min(read_image.info.size.height, write_image.info.size.height);
+    if (const auto& hint = liverpool->last_db_extent; hint.Valid()) {
+        width = std::min<u32>(width, hint.width);
+        height = std::min<u32>(height, hint.height);
+    }
+
     auto aspect_mask = vk::ImageAspectFlags(0);
     if (is_depth) {
         aspect_mask |= vk::ImageAspectFlagBits::eDepth;
@@ -895,7 +1138,7 @@ void Rasterizer::DepthStencilCopy(bool is_depth, bool is_stencil) {
                 .layerCount = sub_range.extent.layers,
             },
         .dstOffset = {0, 0, 0},
-        .extent = {write_image.info.size.width, write_image.info.size.height, 1},
+        .extent = {read_image.info.Scale(width), read_image.info.Scale(height), 1},
     };
     scheduler.CommandBuffer().copyImage(read_image.image, vk::ImageLayout::eTransferSrcOptimal,
                                         write_image.image, vk::ImageLayout::eTransferDstOptimal,
@@ -908,10 +1151,17 @@ void Rasterizer::InlineData(VAddr address, const void* value, u32 num_bytes, boo
     buffer_cache.InlineData(address, value, num_bytes, is_gds);
 }
 
+void Rasterizer::CopyGdsToMemory(VAddr address, u32 gds_offset, u32 num_bytes) {
+    buffer_cache.CopyGdsToMemory(address, gds_offset, num_bytes);
+}
+
+void Rasterizer::CopyMemoryToGds(u32 gds_offset, VAddr address, u32 num_bytes) {
+    buffer_cache.CopyMemoryToGds(gds_offset, address, num_bytes);
+}
+
 u32 Rasterizer::ReadDataFromGds(u32 gds_offset) {
-    auto* gds_buf = buffer_cache.GetGdsBuffer();
     u32 value;
-    std::memcpy(&value, gds_buf->mapped_data.data() + gds_offset, sizeof(u32));
+    buffer_cache.ReadGds(gds_offset, &value, sizeof(u32));
     return value;
 }
 
@@ -922,6 +1172,9 @@ bool Rasterizer::InvalidateMemory(VAddr addr, u64 size) {
     }
     buffer_cache.InvalidateMemory(addr, size);
     texture_cache.InvalidateMemory(addr, size);
+    // A write fault unprotects the whole page, so later stores to it are not reported.
+    const VAddr page_addr = Common::AlignDown(addr, 4_KB);
+    liverpool->NotifyMemoryWrite(page_addr, Common::AlignUp(addr + size, 4_KB) - page_addr);
     return true;
 }
 
@@ -949,75 +1202,104 @@ void Rasterizer::UnmapMemory(VAddr addr, u64 size) {
 void Rasterizer::UpdateDynamicState(const GraphicsPipeline& pipeline) {
     UpdateViewportScissorState(pipeline);
 
+    UpdatePipelineDynamicState();
+
     auto& regs = liverpool->regs;
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.setBlendConstants(&regs.blend_constants.red);
+    auto& state_tracker = scheduler.GetStateTracker();
+    state_tracker.SetBlendConstants({regs.blend_constants.red, regs.blend_constants.green,
+                                     regs.blend_constants.blue, regs.blend_constants.alpha});
 
     if (instance.IsDynamicColorWriteMaskSupported()) {
-        cmdbuf.setColorWriteMaskEXT(0, pipeline.GetWriteMasks());
+        state_tracker.SetColorWriteMasks(pipeline.GetWriteMasks());
     }
     if (regs.depth_control.depth_bounds_enable) {
-        cmdbuf.setDepthBounds(regs.depth_bounds_min, regs.depth_bounds_max);
+        state_tracker.SetDepthBounds(regs.depth_bounds_min, regs.depth_bounds_max);
     }
     if (regs.polygon_control.enable_polygon_offset_front) {
-        cmdbuf.setDepthBias(regs.poly_offset.front_offset, regs.poly_offset.depth_bias,
-                            regs.poly_offset.front_scale / 16.f);
+        state_tracker.SetDepthBias(regs.poly_offset.front_offset, regs.poly_offset.depth_bias,
+                                   regs.poly_offset.front_scale / 16.f);
     } else if (regs.polygon_control.enable_polygon_offset_back) {
-        cmdbuf.setDepthBias(regs.poly_offset.back_offset, regs.poly_offset.depth_bias,
-                            regs.poly_offset.back_scale / 16.f);
+        state_tracker.SetDepthBias(regs.poly_offset.back_offset, regs.poly_offset.depth_bias,
+                                   regs.poly_offset.back_scale / 16.f);
     }
 
     if (regs.depth_control.stencil_enable) {
-        const auto front_fail_op =
-            LiverpoolToVK::StencilOp(regs.stencil_control.stencil_fail_front);
-        const auto front_pass_op =
-            LiverpoolToVK::StencilOp(regs.stencil_control.stencil_zpass_front);
-        const auto front_depth_fail_op =
-            LiverpoolToVK::StencilOp(regs.stencil_control.stencil_zfail_front);
-        const auto front_compare_op = LiverpoolToVK::CompareOp(regs.depth_control.stencil_ref_func);
+        const StateTracker::StencilOps front_ops = {
+            .fail_op = LiverpoolToVK::StencilOp(regs.stencil_control.stencil_fail_front),
+            .pass_op = LiverpoolToVK::StencilOp(regs.stencil_control.stencil_zpass_front),
+            .depth_fail_op = LiverpoolToVK::StencilOp(regs.stencil_control.stencil_zfail_front),
+            .compare_op = LiverpoolToVK::CompareOp(regs.depth_control.stencil_ref_func),
+        };
         if (regs.depth_control.backface_enable) {
-            const auto back_fail_op =
-                LiverpoolToVK::StencilOp(regs.stencil_control.stencil_fail_back);
-            const auto back_pass_op =
-                LiverpoolToVK::StencilOp(regs.stencil_control.stencil_zpass_back);
-            const auto back_depth_fail_op =
-                LiverpoolToVK::StencilOp(regs.stencil_control.stencil_zfail_back);
-            const auto back_compare_op =
-                LiverpoolToVK::CompareOp(regs.depth_control.stencil_bf_func);
-            cmdbuf.setStencilOpEXT(vk::StencilFaceFlagBits::eFront, front_fail_op, front_pass_op,
-                                   front_depth_fail_op, front_compare_op);
-            cmdbuf.setStencilOpEXT(vk::StencilFaceFlagBits::eBack, back_fail_op, back_pass_op,
-                                   back_depth_fail_op, back_compare_op);
+            const StateTracker::StencilOps back_ops = {
+                .fail_op = LiverpoolToVK::StencilOp(regs.stencil_control.stencil_fail_back),
+                .pass_op = LiverpoolToVK::StencilOp(regs.stencil_control.stencil_zpass_back),
+                .depth_fail_op = LiverpoolToVK::StencilOp(regs.stencil_control.stencil_zfail_back),
+                .compare_op = LiverpoolToVK::CompareOp(regs.depth_control.stencil_bf_func),
+            };
+            state_tracker.SetStencilOps(front_ops, back_ops);
         } else {
-            cmdbuf.setStencilOpEXT(vk::StencilFaceFlagBits::eFrontAndBack, front_fail_op,
-                                   front_pass_op, front_depth_fail_op, front_compare_op);
+            state_tracker.SetStencilOps(front_ops, front_ops);
         }
 
         const auto front = regs.stencil_ref_front;
         const auto back = regs.stencil_ref_back;
-        if (front.stencil_test_val == back.stencil_test_val) {
-            cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eFrontAndBack,
-                                       front.stencil_test_val);
-        } else {
-            cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eFront, front.stencil_test_val);
-            cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eBack, back.stencil_test_val);
-        }
+        state_tracker.SetStencilReference(front.stencil_test_val, back.stencil_test_val);
+        state_tracker.SetStencilWriteMask(front.stencil_write_mask, back.stencil_write_mask);
+        state_tracker.SetStencilCompareMask(front.stencil_mask, back.stencil_mask);
+    }
+}
 
-        if (front.stencil_write_mask == back.stencil_write_mask) {
-            cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eFrontAndBack,
-                                       front.stencil_write_mask);
-        } else {
-            cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eFront, front.stencil_write_mask);
-            cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eBack, back.stencil_write_mask);
+void Rasterizer::UpdatePipelineDynamicState() {
+    const auto& key = pipeline_cache.GetGraphicsKey();
+    auto& state_tracker = scheduler.GetStateTracker();
+
+    state_tracker.SetPrimitiveTopology(GraphicsPipeline::GetPrimitiveTopology(key));
+    state_tracker.SetCullMode(LiverpoolToVK::IsPrimitiveCulled(key.prim_type)
+                                  ? LiverpoolToVK::CullMode(key.cull_mode)
+                                  : vk::CullModeFlagBits::eNone);
+    state_tracker.SetFrontFace(key.front_face == Liverpool::FrontFace::Clockwise
+                                   ? vk::FrontFace::eClockwise
+                                   : vk::FrontFace::eCounterClockwise);
+    state_tracker.SetDepthTestEnable(key.depth_test_enable);
+    state_tracker.SetDepthWriteEnable(key.depth_write_enable);
+    state_tracker.SetDepthCompareOp(key.depth_compare_op);
+    state_tracker.SetDepthBoundsTestEnable(key.depth_bounds_test_enable);
+    state_tracker.SetStencilTestEnable(key.stencil_test_enable);
+
+    if (instance.IsExtendedDynamicState2Supported()) {
+        auto prim_restart = key.enable_primitive_restart != 0;
+        if (prim_restart && GraphicsPipeline::IsPrimitiveListTopology(key.prim_type) &&
+            !instance.IsListRestartSupported()) {
+            LOG_WARNING(Render_Vulkan, "Primitive restart is enabled for list topology but not "
+                                       "supported by driver.");
+            prim_restart = false;
         }
-
-        if (front.stencil_mask == back.stencil_mask) {
-            cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eFrontAndBack,
-                                         front.stencil_mask);
-        } else {
-            cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eFront, front.stencil_mask);
-            cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eBack, back.stencil_mask);
+        ASSERT_MSG(!prim_restart || key.primitive_restart_index == 0xFFFF ||
+                       key.primitive_restart_index == 0xFFFFFFFF,
+                   "Primitive restart index other than -1 is not supported yet");
+        state_tracker.SetDepthBiasEnable(key.depth_bias_enable);
+        state_tracker.SetPrimitiveRestartEnable(prim_restart);
+    }
+    if (instance.IsDynamicPolygonModeSupported()) {
+        state_tracker.SetPolygonMode(LiverpoolToVK::PolygonMode(key.polygon_mode));
+    }
+    if (instance.IsDynamicRasterizationSamplesSupported()) {
+        state_tracker.SetRasterizationSamples(
+            LiverpoolToVK::NumSamples(key.num_samples, instance.GetFramebufferSampleCounts()));
+    }
+    if (instance.IsDynamicColorBlendSupported() && key.num_color_attachments > 0) {
+        std::array<vk::Bool32, Liverpool::NumColorBuffers> blend_enables;
+        std::array<vk::ColorBlendEquationEXT, Liverpool::NumColorBuffers> blend_equations;
+        for (u32 i = 0; i < key.num_color_attachments; i++) {
+            const auto& control = key.blend_controls[i];
+            const auto has_alpha_masked_out =
+                (key.cb_shader_mask.GetMask(i) & Liverpool::ColorBufferMask::ComponentA) == 0;
+            blend_enables[i] = control.enable;
+            blend_equations[i] = GraphicsPipeline::GetBlendEquation(control, has_alpha_masked_out);
         }
+        state_tracker.SetColorBlendEnables({blend_enables.data(), key.num_color_attachments});
+        state_tracker.SetColorBlendEquations({blend_equations.data(), key.num_color_attachments});
     }
 }
 
@@ -1053,6 +1335,14 @@ void Rasterizer::UpdateViewportScissorState(const GraphicsPipeline& pipeline) {
     boost::container::static_vector<vk::Viewport, Liverpool::NumViewports> viewports;
     boost::container::static_vector<vk::Rect2D, Liverpool::NumViewports> scissors;
 
+    // Targets may be rendered at the internal resolution, scissors are in guest pixels.
+    const auto scale_offset = [this](s32 value) {
+        return static_cast<s32>(std::floor(value * render_scale));
+    };
+    const auto scale_extent = [this](u32 value) {
+        return static_cast<u32>(std::ceil(value * render_scale));
+    };
+
     const auto& vp_ctl = regs.viewport_control;
     const float reduce_z =
         regs.clipper_control.clip_space == AmdGpu::Liverpool::ClipSpace::MinusWToW ? 1.0f : 0.0f;
@@ -1090,10 +1380,10 @@ void Rasterizer::UpdateViewportScissorState(const GraphicsPipeline& pipeline) {
             const auto yoffset = vp_ctl.yoffset_enable ? vp.yoffset : 0.f;
             const auto yscale = vp_ctl.yscale_enable ? vp.yscale : 1.f;
             viewports.push_back({
-                .x = xoffset - xscale,
-                .y = yoffset - yscale,
-                .width = xscale * 2.0f,
-                .height = yscale * 2.0f,
+                .x = (xoffset - xscale) * render_scale,
+                .y = (yoffset - yscale) * render_scale,
+                .width = xscale * 2.0f * render_scale,
+                .height = yscale * 2.0f * render_scale,
                 .minDepth = zoffset - zscale * reduce_z,
                 .maxDepth = zscale + zoffset,
             });
@@ -1111,8 +1401,8 @@ void Rasterizer::UpdateViewportScissorState(const GraphicsPipeline& pipeline) {
                 std::min(vp_scsr.bottom_right_y, regs.viewport_scissors[i].bottom_right_y);
         }
         scissors.push_back({
-            .offset = {vp_scsr.top_left_x, vp_scsr.top_left_y},
-            .extent = {vp_scsr.GetWidth(), vp_scsr.GetHeight()},
+            .offset = {scale_offset(vp_scsr.top_left_x), scale_offset(vp_scsr.top_left_y)},
+            .extent = {scale_extent(vp_scsr.GetWidth()), scale_extent(vp_scsr.GetHeight())},
         });
     }
 
@@ -1134,9 +1424,9 @@ void Rasterizer::UpdateViewportScissorState(const GraphicsPipeline& pipeline) {
         scissors.push_back(empty_scissor);
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.setViewportWithCountEXT(viewports);
-    cmdbuf.setScissorWithCountEXT(scissors);
+    auto& state_tracker = scheduler.GetStateTracker();
+    state_tracker.SetViewports({viewports.data(), viewports.size()});
+    state_tracker.SetScissors({scissors.data(), scissors.size()});
 }
 
 void Rasterizer::ScopeMarkerBegin(const std::string_view& str, bool from_guest) {
@@ -5,7 +5,9 @@
 
 #include "video_core/buffer_cache/buffer_cache.h"
 #include "video_core/page_manager.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/renderer_vulkan/vk_resolve_pass.h"
 #include "video_core/texture_cache/texture_cache.h"
 
 namespace AmdGpu {
@@ -22,11 +24,11 @@ class Scheduler;
 class RenderState;
 class GraphicsPipeline;
 
-class Rasterizer {
+class Rasterizer final : public VideoCore::RasterizerInterface {
 public:
     explicit Rasterizer(const Instance& instance, Scheduler& scheduler,
                         AmdGpu::Liverpool* liverpool);
-    ~Rasterizer();
+    ~Rasterizer() override;
 
     [[nodiscard]] Scheduler& GetScheduler() noexcept {
         return scheduler;
@@ -40,29 +42,31 @@ public:
         return texture_cache;
     }
 
-    void Draw(bool is_indexed, u32 index_offset = 0);
+    void Draw(bool is_indexed, u32 index_offset = 0) override;
     void DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u32 size, u32 max_count,
-                      VAddr count_address);
+                      VAddr count_address) override;
 
-    void DispatchDirect();
-    void DispatchIndirect(VAddr address, u32 offset, u32 size);
+    void DispatchDirect() override;
+    void DispatchIndirect(VAddr address, u32 offset, u32 size) override;
 
-    void ScopeMarkerBegin(const std::string_view& str, bool from_guest = false);
-    void ScopeMarkerEnd(bool from_guest = false);
-    void ScopedMarkerInsert(const std::string_view& str, bool from_guest = false);
+    void ScopeMarkerBegin(const std::string_view& str, bool from_guest = false) override;
+    void ScopeMarkerEnd(bool from_guest = false) override;
+    void ScopedMarkerInsert(const std::string_view& str, bool from_guest = false) override;
     void ScopedMarkerInsertColor(const std::string_view& str, const u32 color,
-                                 bool from_guest = false);
+                                 bool from_guest = false) override;
 
-    void InlineData(VAddr address, const void* value, u32 num_bytes, bool is_gds);
-    u32 ReadDataFromGds(u32 gsd_offset);
-    bool InvalidateMemory(VAddr addr, u64 size);
-    bool IsMapped(VAddr addr, u64 size);
-    void MapMemory(VAddr addr, u64 size);
-    void UnmapMemory(VAddr addr, u64 size);
+    void InlineData(VAddr address, const void* value, u32 num_bytes, bool is_gds) override;
+    void CopyGdsToMemory(VAddr address, u32 gds_offset, u32 num_bytes) override;
+    void CopyMemoryToGds(u32 gds_offset, VAddr address, u32 num_bytes) override;
+    u32 ReadDataFromGds(u32 gsd_offset) override;
+    bool InvalidateMemory(VAddr addr, u64 size) override;
+    bool IsMapped(VAddr addr, u64 size) override;
+    void MapMemory(VAddr addr, u64 size) override;
+    void UnmapMemory(VAddr addr, u64 size) override;
 
-    void CpSync();
-    u64 Flush();
-    void Finish();
+    void CpSync() override;
+    u64 Flush() override;
+    void Finish() override;
 
     PipelineCache& GetPipelineCache() {
         return pipeline_cache;
@@ -71,15 +75,20 @@ public:
 private:
     RenderState PrepareRenderState(u32 mrt_mask);
     void BeginRendering(const GraphicsPipeline& pipeline, RenderState& state);
+    vk::Extent2D GetResolveExtent(u32 col_buf_id, const VideoCore::Image& image) const;
+    void MatchResolution(VideoCore::ImageId& lhs_id, VideoCore::ImageId& rhs_id);
     void Resolve();
     void DepthStencilCopy(bool is_depth, bool is_stencil);
     void EliminateFastClear();
 
     void UpdateDynamicState(const GraphicsPipeline& pipeline);
+    void UpdatePipelineDynamicState();
     void UpdateViewportScissorState(const GraphicsPipeline& pipeline);
 
     bool FilterDraw();
 
+    bool IsQuadListExpandable(bool is_indexed, u32 index_offset);
+
     void BindBuffers(const Shader::Info& stage, Shader::Backend::Bindings& binding,
                      Shader::PushData& push_data);
 
@@ -105,6 +114,7 @@ private:
     Core::MemoryManager* memory;
     boost::icl::interval_set<VAddr> mapped_ranges;
     PipelineCache pipeline_cache;
+    ResolvePass resolve_pass;
 
     boost::container::static_vector<
         std::pair<VideoCore::ImageId, VideoCore::TextureCache::RenderTargetDesc>, 8>
@@ -112,7 +122,9 @@ private:
     std::optional<std::pair<VideoCore::ImageId, VideoCore::TextureCache::DepthTargetDesc>> db_desc;
     boost::container::static_vector<vk::DescriptorImageInfo, Shader::NumImages> image_infos;
     boost::container::static_vector<vk::DescriptorBufferInfo, Shader::NumBuffers> buffer_infos;
+    boost::container::static_vector<vk::DeviceAddress, Shader::NumBuffers> buffer_addresses;
     boost::container::static_vector<VideoCore::ImageId, Shader::NumImages> bound_images;
+    float render_scale{1.0f}; ///< Resolution scale of the targets bound for the current draw
 
     Pipeline::DescriptorWrites set_writes;
     Pipeline::BufferBarriers buffer_barriers;
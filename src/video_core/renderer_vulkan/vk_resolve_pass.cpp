@@ -0,0 +1,242 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/assert.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_resolve_pass.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/renderer_vulkan/vk_shader_util.h"
+
+#include "video_core/host_shaders/fs_tri_vert.h"
+#include "video_core/host_shaders/resolve_msaa_frag.h"
+
+namespace Vulkan {
+
+ResolvePass::ResolvePass(const Instance& instance_, Scheduler& scheduler_)
+    : instance{instance_}, scheduler{scheduler_} {
+    const vk::Device device = instance.GetDevice();
+
+    const vk::SamplerCreateInfo sampler_ci = {
+        .magFilter = vk::Filter::eNearest,
+        .minFilter = vk::Filter::eNearest,
+        .mipmapMode = vk::SamplerMipmapMode::eNearest,
+        .addressModeU = vk::SamplerAddressMode::eClampToEdge,
+        .addressModeV = vk::SamplerAddressMode::eClampToEdge,
+    };
+    auto [sampler_result, smplr] = device.createSamplerUnique(sampler_ci);
+    ASSERT_MSG(sampler_result == vk::Result::eSuccess, "Failed to create sampler: {}",
+               vk::to_string(sampler_result));
+    sampler = std::move(smplr);
+
+    CreateLayout();
+
+    vs_module = CompileHostShader(HostShaders::FS_TRI_VERT, HostShaders::FS_TRI_VERT_SPV,
+                                  vk::ShaderStageFlagBits::eVertex, device);
+    ASSERT(vs_module);
+    SetObjectName(device, vs_module, "fs_tri.vert");
+
+    fs_module =
+        CompileHostShader(HostShaders::RESOLVE_MSAA_FRAG, HostShaders::RESOLVE_MSAA_FRAG_SPV,
+                          vk::ShaderStageFlagBits::eFragment, device);
+    ASSERT(fs_module);
+    SetObjectName(device, fs_module, "resolve_msaa.frag");
+}
+
+ResolvePass::~ResolvePass() {
+    const vk::Device device = instance.GetDevice();
+    device.destroyShaderModule(vs_module);
+    device.destroyShaderModule(fs_module);
+}
+
+void ResolvePass::CreateLayout() {
+    const vk::Sampler immutable_sampler = *sampler;
+    const vk::DescriptorSetLayoutBinding binding = {
+        .binding = 0,
+        .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+        .descriptorCount = 1,
+        .stageFlags = vk::ShaderStageFlagBits::eFragment,
+        .pImmutableSamplers = &immutable_sampler,
+    };
+    const vk::DescriptorSetLayoutCreateInfo desc_layout_ci = {
+        .flags = vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR,
+        .bindingCount = 1U,
+        .pBindings = &binding,
+    };
+    auto [desc_layout_result, set_layout] =
+        instance.GetDevice().createDescriptorSetLayoutUnique(desc_layout_ci);
+    ASSERT_MSG(desc_layout_result == vk::Result::eSuccess,
+               "Failed to create descriptor set layout: {}", vk::to_string(desc_layout_result));
+    desc_layout = std::move(set_layout);
+
+    const vk::PushConstantRange push_constants = {
+        .stageFlags = vk::ShaderStageFlagBits::eFragment,
+        .offset = 0,
+        .size = sizeof(s32),
+    };
+    const vk::DescriptorSetLayout layout = *desc_layout;
+    const vk::PipelineLayoutCreateInfo layout_info = {
+        .setLayoutCount = 1U,
+        .pSetLayouts = &layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constants,
+    };
+    auto [layout_result, pipeline_layout] =
+        instance.GetDevice().createPipelineLayoutUnique(layout_info);
+    ASSERT_MSG(layout_result == vk::Result::eSuccess, "Failed to create pipeline layout: {}",
+               vk::to_string(layout_result));
+    pl_layout = std::move(pipeline_layout);
+}
+
+vk::Pipeline ResolvePass::GetPipeline(vk::Format format) {
+    if (const auto it = pipelines.find(format); it != pipelines.end()) {
+        return *it->second;
+    }
+
+    const std::array shaders_ci{
+        vk::PipelineShaderStageCreateInfo{
+            .stage = vk::ShaderStageFlagBits::eVertex,
+            .module = vs_module,
+            .pName = "main",
+        },
+        vk::PipelineShaderStageCreateInfo{
+            .stage = vk::ShaderStageFlagBits::eFragment,
+            .module = fs_module,
+            .pName = "main",
+        },
+    };
+
+    const vk::PipelineRenderingCreateInfoKHR pipeline_rendering_ci = {
+        .colorAttachmentCount = 1u,
+        .pColorAttachmentFormats = &format,
+    };
+
+    const vk::PipelineVertexInputStateCreateInfo vertex_input_info = {
+        .vertexBindingDescriptionCount = 0u,
+        .vertexAttributeDescriptionCount = 0u,
+    };
+
+    const vk::PipelineInputAssemblyStateCreateInfo input_assembly = {
+        .topology = vk::PrimitiveTopology::eTriangleList,
+    };
+
+    const vk::PipelineViewportStateCreateInfo viewport_info = {
+        .viewportCount = 1,
+        .scissorCount = 1,
+    };
+
+    const vk::PipelineRasterizationStateCreateInfo raster_state = {
+        .depthClampEnable = false,
+        .rasterizerDiscardEnable = false,
+        .polygonMode = vk::PolygonMode::eFill,
+        .cullMode = vk::CullModeFlagBits::eNone,
+        .frontFace = vk::FrontFace::eClockwise,
+        .depthBiasEnable = false,
+        .lineWidth = 1.0f,
+    };
+
+    const vk::PipelineMultisampleStateCreateInfo multisampling = {
+        .rasterizationSamples = vk::SampleCountFlagBits::e1,
+    };
+
+    const vk::PipelineColorBlendAttachmentState attachment = {
+        .blendEnable = false,
+        .colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                          vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA,
+    };
+
+    const vk::PipelineColorBlendStateCreateInfo color_blending = {
+        .logicOpEnable = false,
+        .logicOp = vk::LogicOp::eCopy,
+        .attachmentCount = 1u,
+        .pAttachments = &attachment,
+    };
+
+    const std::array dynamic_states = {
+        vk::DynamicState::eViewport,
+        vk::DynamicState::eScissor,
+    };
+
+    const vk::PipelineDynamicStateCreateInfo dynamic_info = {
+        .dynamicStateCount = static_cast<u32>(dynamic_states.size()),
+        .pDynamicStates = dynamic_states.data(),
+    };
+
+    const vk::GraphicsPipelineCreateInfo pipeline_info = {
+        .pNext = &pipeline_rendering_ci,
+        .stageCount = static_cast<u32>(shaders_ci.size()),
+        .pStages = shaders_ci.data(),
+        .pVertexInputState = &vertex_input_info,
+        .pInputAssemblyState = &input_assembly,
+        .pViewportState = &viewport_info,
+        .pRasterizationState = &raster_state,
+        .pMultisampleState = &multisampling,
+        .pColorBlendState = &color_blending,
+        .pDynamicState = &dynamic_info,
+        .layout = *pl_layout,
+    };
+
+    auto result = instance.GetDevice().createGraphicsPipelineUnique(
+        /*pipeline_cache*/ {}, pipeline_info);
+    ASSERT_MSG(result.result == vk::Result::eSuccess, "Resolve pipeline creation failed: {}",
+               vk::to_string(result.result));
+    const vk::Pipeline pipeline = *result.value;
+    pipelines.emplace(format, std::move(result.value));
+    return pipeline;
+}
+
+void ResolvePass::Resolve(vk::ImageView src, u32 num_samples, vk::ImageView dst,
+                          vk::Format dst_format, vk::Extent2D extent) {
+    const vk::Pipeline pipeline = GetPipeline(dst_format);
+
+    RenderState state{};
+    state.color_attachments[0] = {
+        .imageView = dst,
+        .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+        .loadOp = vk::AttachmentLoadOp::eLoad,
+        .storeOp = vk::AttachmentStoreOp::eStore,
+    };
+    state.num_color_attachments = 1;
+    state.width = extent.width;
+    state.height = extent.height;
+    scheduler.BeginRendering(state);
+
+    const auto cmdbuf = scheduler.CommandBuffer();
+    cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+    scheduler.GetStateTracker().InvalidateGraphics();
+
+    const vk::DescriptorImageInfo image_info = {
+        .imageView = src,
+        .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+    };
+    const vk::WriteDescriptorSet set_write = {
+        .dstSet = VK_NULL_HANDLE,
+        .dstBinding = 0,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+        .pImageInfo = &image_info,
+    };
+    cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eGraphics, *pl_layout, 0, set_write);
+
+    const s32 samples = static_cast<s32>(num_samples);
+    cmdbuf.pushConstants(*pl_layout, vk::ShaderStageFlagBits::eFragment, 0, sizeof(samples),
+                         &samples);
+
+    const vk::Viewport viewport = {
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = static_cast<float>(extent.width),
+        .height = static_cast<float>(extent.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
+    const vk::Rect2D scissor = {
+        .offset = {0, 0},
+        .extent = extent,
+    };
+    cmdbuf.setViewport(0, viewport);
+    cmdbuf.setScissor(0, scissor);
+    cmdbuf.draw(3, 1, 0, 0);
+}
+
+} // namespace Vulkan
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <tsl/robin_map.h>
+
+#include "common/types.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+class Instance;
+class Scheduler;
+
+/// Resolves multisampled color images with a fragment shader. Used for cases where
+/// vkCmdResolveImage and attachment resolves cannot be used, like mismatching view formats.
+class ResolvePass {
+public:
+    explicit ResolvePass(const Instance& instance, Scheduler& scheduler);
+    ~ResolvePass();
+
+    /// Averages all samples of src into the dst view, limited to the provided extent.
+    /// Both images are expected to be in shader read and color attachment layouts respectively.
+    void Resolve(vk::ImageView src, u32 num_samples, vk::ImageView dst, vk::Format dst_format,
+                 vk::Extent2D extent);
+
+private:
+    void CreateLayout();
+    vk::Pipeline GetPipeline(vk::Format format);
+
+private:
+    const Instance& instance;
+    Scheduler& scheduler;
+    vk::UniqueSampler sampler;
+    vk::UniqueDescriptorSetLayout desc_layout;
+    vk::UniquePipelineLayout pl_layout;
+    vk::ShaderModule vs_module;
+    vk::ShaderModule fs_module;
+    tsl::robin_map<vk::Format, vk::UniquePipeline> pipelines;
+};
+
+} // namespace Vulkan
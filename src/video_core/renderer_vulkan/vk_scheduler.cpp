@@ -96,6 +96,7 @@ void Scheduler::AllocateWorkerCommandBuffers() {
     auto begin_result = current_cmdbuf.begin(begin_info);
     ASSERT_MSG(begin_result == vk::Result::eSuccess, "Failed to begin command buffer: {}",
                vk::to_string(begin_result));
+    state_tracker.Reset(current_cmdbuf);
 
 #if TRACY_GPU_ENABLED
     auto* profiler_ctx = instance.GetProfilerContext();
@@ -109,6 +110,8 @@ void Scheduler::AllocateWorkerCommandBuffers() {
 
 void Scheduler::SubmitExecution(SubmitInfo& info) {
     std::scoped_lock lk{submit_mutex};
+    EndRendering();
+    ImGui::Core::TextureManager::Submit(*this);
     const u64 signal_value = master_semaphore.NextTick();
 
 #if TRACY_GPU_ENABLED
@@ -150,10 +153,10 @@ void Scheduler::SubmitExecution(SubmitInfo& info) {
         .pSignalSemaphores = info.signal_semas.data(),
     };
 
-    ImGui::Core::TextureManager::Submit();
     auto submit_result = instance.GetGraphicsQueue().submit(submit_info, info.fence);
     ASSERT_MSG(submit_result != vk::Result::eErrorDeviceLost, "Device lost during submit");
 
+    master_semaphore.Submitted(signal_value);
     master_semaphore.Refresh();
     AllocateWorkerCommandBuffers();
 
@@ -9,6 +9,7 @@
 #include "common/unique_function.h"
 #include "video_core/renderer_vulkan/vk_master_semaphore.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
+#include "video_core/renderer_vulkan/vk_state_tracker.h"
 
 namespace tracy {
 class VkCtxScope;
@@ -86,6 +87,11 @@ public:
         return current_cmdbuf;
     }
 
+    /// Returns the state tracker of the current command buffer.
+    StateTracker& GetStateTracker() noexcept {
+        return state_tracker;
+    }
+
     /// Returns the current command buffer tick.
     [[nodiscard]] u64 CurrentTick() const noexcept {
         return master_semaphore.CurrentTick();
@@ -106,6 +112,13 @@ public:
         pending_ops.emplace(std::move(func), CurrentTick());
     }
 
+    /// Defers an operation to the completion thread, which runs it as soon as the gpu has
+    /// reached the current cpu tick instead of on a later submission. It must not touch state
+    /// owned by the scheduler thread, so it suits releasing resources the gpu was using.
+    void DeferAsyncOperation(Common::UniqueFunction<void>&& func) {
+        master_semaphore.OnCompletion(CurrentTick(), std::move(func));
+    }
+
     static std::mutex submit_mutex;
 
 private:
@@ -125,6 +138,7 @@ private:
     };
     std::queue<PendingOp> pending_ops;
     RenderState render_state;
+    StateTracker state_tracker;
     bool is_rendering = false;
     tracy::VkCtxScope* profiler_scope{};
 };
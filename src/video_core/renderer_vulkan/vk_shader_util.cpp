@@ -228,4 +228,13 @@ vk::ShaderModule CompileSPV(std::span<const u32> code, vk::Device device) {
     return module;
 }
 
+vk::ShaderModule CompileHostShader(std::string_view code, std::span<const u32> spirv,
+                                   vk::ShaderStageFlagBits stage, vk::Device device) {
+#ifdef ENABLE_RUNTIME_HOST_SHADERS
+    return Compile(code, stage, device);
+#else
+    return CompileSPV(spirv, device);
+#endif
+}
+
 } // namespace Vulkan
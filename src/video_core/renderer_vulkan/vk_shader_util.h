@@ -25,4 +25,15 @@ vk::ShaderModule Compile(std::string_view code, vk::ShaderStageFlagBits stage, v
  */
 vk::ShaderModule CompileSPV(std::span<const u32> code, vk::Device device);
 
+/**
+ * @brief Creates a vulkan shader module from one of the emulator's own shaders. The SPIR-V built
+ * with the emulator is used, unless runtime compilation of the GLSL code is enabled for debugging.
+ * @param code The string containing GLSL code.
+ * @param spirv The SPIR-V compiled from the same GLSL code at build time.
+ * @param stage The pipeline stage the shader will be used in.
+ * @param device The vulkan device handle.
+ */
+vk::ShaderModule CompileHostShader(std::string_view code, std::span<const u32> spirv,
+                                   vk::ShaderStageFlagBits stage, vk::Device device);
+
 } // namespace Vulkan
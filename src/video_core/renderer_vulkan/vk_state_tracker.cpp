@@ -0,0 +1,271 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video_core/renderer_vulkan/vk_state_tracker.h"
+
+namespace Vulkan {
+
+namespace {
+
+template <typename Container, typename T>
+Container ToArray(std::span<const T> values) {
+    return Container(values.begin(), values.end());
+}
+
+/// Records a per-face command once for both faces when the values match.
+template <typename T, typename Func>
+void SetFaces(const std::array<T, 2>& values, Func&& func) {
+    if (values[0] == values[1]) {
+        func(vk::StencilFaceFlagBits::eFrontAndBack, values[0]);
+    } else {
+        func(vk::StencilFaceFlagBits::eFront, values[0]);
+        func(vk::StencilFaceFlagBits::eBack, values[1]);
+    }
+}
+
+} // Anonymous namespace
+
+void StateTracker::Reset(vk::CommandBuffer cmdbuf_) {
+    cmdbuf = cmdbuf_;
+    bindings = {};
+    graphics = {};
+}
+
+void StateTracker::InvalidateGraphics() {
+    bindings.graphics_pipeline.reset();
+    graphics = {};
+}
+
+void StateTracker::BindGraphicsPipeline(vk::Pipeline pipeline) {
+    if (Issue(Update(bindings.graphics_pipeline, pipeline))) {
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+    }
+}
+
+void StateTracker::BindComputePipeline(vk::Pipeline pipeline) {
+    if (Issue(Update(bindings.compute_pipeline, pipeline))) {
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+    }
+}
+
+void StateTracker::BindVertexBuffers(std::span<const vk::Buffer> buffers,
+                                     std::span<const vk::DeviceSize> offsets) {
+    using Buffers = decltype(bindings.vertex_buffers)::value_type;
+    using Sizes = decltype(bindings.vertex_offsets)::value_type;
+    const bool buffers_changed = Update(bindings.vertex_buffers, ToArray<Buffers>(buffers));
+    const bool offsets_changed = Update(bindings.vertex_offsets, ToArray<Sizes>(offsets));
+    if (Issue(buffers_changed || offsets_changed)) {
+        cmdbuf.bindVertexBuffers(0, static_cast<u32>(buffers.size()), buffers.data(),
+                                 offsets.data());
+    }
+}
+
+void StateTracker::BindVertexBuffers(std::span<const vk::Buffer> buffers,
+                                     std::span<const vk::DeviceSize> offsets,
+                                     std::span<const vk::DeviceSize> sizes,
+                                     std::span<const vk::DeviceSize> strides) {
+    using Buffers = decltype(bindings.vertex_buffers)::value_type;
+    using Sizes = decltype(bindings.vertex_offsets)::value_type;
+    const bool buffers_changed = Update(bindings.vertex_buffers, ToArray<Buffers>(buffers));
+    const bool offsets_changed = Update(bindings.vertex_offsets, ToArray<Sizes>(offsets));
+    const bool sizes_changed = Update(bindings.vertex_sizes, ToArray<Sizes>(sizes));
+    const bool strides_changed = Update(bindings.vertex_strides, ToArray<Sizes>(strides));
+    if (Issue(buffers_changed || offsets_changed || sizes_changed || strides_changed)) {
+        cmdbuf.bindVertexBuffers2EXT(0, static_cast<u32>(buffers.size()), buffers.data(),
+                                     offsets.data(), sizes.data(), strides.data());
+    }
+}
+
+void StateTracker::BindIndexBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::IndexType type) {
+    if (Issue(Update(bindings.index_buffer, std::make_tuple(buffer, offset, type)))) {
+        cmdbuf.bindIndexBuffer(buffer, offset, type);
+    }
+}
+
+void StateTracker::BindDescriptorBuffer(vk::DeviceAddress address, vk::BufferUsageFlags usage) {
+    if (Issue(Update(bindings.descriptor_buffer, address))) {
+        const vk::DescriptorBufferBindingInfoEXT binding_info = {
+            .address = address,
+            .usage = usage,
+        };
+        cmdbuf.bindDescriptorBuffersEXT(binding_info);
+    }
+}
+
+void StateTracker::SetVertexInput(
+    std::span<const vk::VertexInputBindingDescription2EXT> vertex_bindings,
+    std::span<const vk::VertexInputAttributeDescription2EXT> vertex_attributes) {
+    using VertexBindings = decltype(graphics.vertex_bindings)::value_type;
+    using Attributes = decltype(graphics.vertex_attributes)::value_type;
+    const bool bindings_changed =
+        Update(graphics.vertex_bindings, ToArray<VertexBindings>(vertex_bindings));
+    const bool attributes_changed =
+        Update(graphics.vertex_attributes, ToArray<Attributes>(vertex_attributes));
+    if (Issue(bindings_changed || attributes_changed)) {
+        cmdbuf.setVertexInputEXT(vertex_bindings, vertex_attributes);
+    }
+}
+
+void StateTracker::SetViewports(std::span<const vk::Viewport> viewports) {
+    using Viewports = decltype(graphics.viewports)::value_type;
+    if (Issue(Update(graphics.viewports, ToArray<Viewports>(viewports)))) {
+        cmdbuf.setViewportWithCountEXT(viewports);
+    }
+}
+
+void StateTracker::SetScissors(std::span<const vk::Rect2D> scissors) {
+    using Scissors = decltype(graphics.scissors)::value_type;
+    if (Issue(Update(graphics.scissors, ToArray<Scissors>(scissors)))) {
+        cmdbuf.setScissorWithCountEXT(scissors);
+    }
+}
+
+void StateTracker::SetBlendConstants(const std::array<float, 4>& constants) {
+    if (Issue(Update(graphics.blend_constants, constants))) {
+        cmdbuf.setBlendConstants(constants.data());
+    }
+}
+
+void StateTracker::SetColorWriteMasks(std::span<const vk::ColorComponentFlags> masks) {
+    using Masks = decltype(graphics.color_write_masks)::value_type;
+    if (Issue(Update(graphics.color_write_masks, ToArray<Masks>(masks)))) {
+        cmdbuf.setColorWriteMaskEXT(0, masks);
+    }
+}
+
+void StateTracker::SetColorBlendEnables(std::span<const vk::Bool32> enables) {
+    using Enables = decltype(graphics.color_blend_enables)::value_type;
+    if (Issue(Update(graphics.color_blend_enables, ToArray<Enables>(enables)))) {
+        cmdbuf.setColorBlendEnableEXT(0, enables);
+    }
+}
+
+void StateTracker::SetColorBlendEquations(std::span<const vk::ColorBlendEquationEXT> equations) {
+    using Equations = decltype(graphics.color_blend_equations)::value_type;
+    if (Issue(Update(graphics.color_blend_equations, ToArray<Equations>(equations)))) {
+        cmdbuf.setColorBlendEquationEXT(0, equations);
+    }
+}
+
+void StateTracker::SetDepthBounds(float min, float max) {
+    if (Issue(Update(graphics.depth_bounds, std::array{min, max}))) {
+        cmdbuf.setDepthBounds(min, max);
+    }
+}
+
+void StateTracker::SetDepthBias(float constant, float clamp, float slope) {
+    if (Issue(Update(graphics.depth_bias, std::array{constant, clamp, slope}))) {
+        cmdbuf.setDepthBias(constant, clamp, slope);
+    }
+}
+
+void StateTracker::SetStencilOps(const StencilOps& front, const StencilOps& back) {
+    const FacePair<StencilOps> ops = {front, back};
+    if (Issue(Update(graphics.stencil_ops, ops))) {
+        SetFaces(ops, [this](vk::StencilFaceFlags faces, const StencilOps& op) {
+            cmdbuf.setStencilOpEXT(faces, op.fail_op, op.pass_op, op.depth_fail_op,
+                                   op.compare_op);
+        });
+    }
+}
+
+void StateTracker::SetStencilReference(u32 front, u32 back) {
+    const FacePair<u32> values = {front, back};
+    if (Issue(Update(graphics.stencil_reference, values))) {
+        SetFaces(values, [this](vk::StencilFaceFlags faces, u32 value) {
+            cmdbuf.setStencilReference(faces, value);
+        });
+    }
+}
+
+void StateTracker::SetStencilWriteMask(u32 front, u32 back) {
+    const FacePair<u32> values = {front, back};
+    if (Issue(Update(graphics.stencil_write_mask, values))) {
+        SetFaces(values, [this](vk::StencilFaceFlags faces, u32 value) {
+            cmdbuf.setStencilWriteMask(faces, value);
+        });
+    }
+}
+
+void StateTracker::SetStencilCompareMask(u32 front, u32 back) {
+    const FacePair<u32> values = {front, back};
+    if (Issue(Update(graphics.stencil_compare_mask, values))) {
+        SetFaces(values, [this](vk::StencilFaceFlags faces, u32 value) {
+            cmdbuf.setStencilCompareMask(faces, value);
+        });
+    }
+}
+
+void StateTracker::SetPrimitiveTopology(vk::PrimitiveTopology topology) {
+    if (Issue(Update(graphics.primitive_topology, topology))) {
+        cmdbuf.setPrimitiveTopologyEXT(topology);
+    }
+}
+
+void StateTracker::SetPrimitiveRestartEnable(bool enable) {
+    if (Issue(Update(graphics.primitive_restart_enable, enable))) {
+        cmdbuf.setPrimitiveRestartEnableEXT(enable);
+    }
+}
+
+void StateTracker::SetCullMode(vk::CullModeFlags mode) {
+    if (Issue(Update(graphics.cull_mode, mode))) {
+        cmdbuf.setCullModeEXT(mode);
+    }
+}
+
+void StateTracker::SetFrontFace(vk::FrontFace face) {
+    if (Issue(Update(graphics.front_face, face))) {
+        cmdbuf.setFrontFaceEXT(face);
+    }
+}
+
+void StateTracker::SetPolygonMode(vk::PolygonMode mode) {
+    if (Issue(Update(graphics.polygon_mode, mode))) {
+        cmdbuf.setPolygonModeEXT(mode);
+    }
+}
+
+void StateTracker::SetRasterizationSamples(vk::SampleCountFlagBits samples) {
+    if (Issue(Update(graphics.rasterization_samples, samples))) {
+        cmdbuf.setRasterizationSamplesEXT(samples);
+    }
+}
+
+void StateTracker::SetDepthTestEnable(bool enable) {
+    if (Issue(Update(graphics.depth_test_enable, enable))) {
+        cmdbuf.setDepthTestEnableEXT(enable);
+    }
+}
+
+void StateTracker::SetDepthWriteEnable(bool enable) {
+    if (Issue(Update(graphics.depth_write_enable, enable))) {
+        cmdbuf.setDepthWriteEnableEXT(enable);
+    }
+}
+
+void StateTracker::SetDepthCompareOp(vk::CompareOp op) {
+    if (Issue(Update(graphics.depth_compare_op, op))) {
+        cmdbuf.setDepthCompareOpEXT(op);
+    }
+}
+
+void StateTracker::SetDepthBoundsTestEnable(bool enable) {
+    if (Issue(Update(graphics.depth_bounds_test_enable, enable))) {
+        cmdbuf.setDepthBoundsTestEnableEXT(enable);
+    }
+}
+
+void StateTracker::SetDepthBiasEnable(bool enable) {
+    if (Issue(Update(graphics.depth_bias_enable, enable))) {
+        cmdbuf.setDepthBiasEnableEXT(enable);
+    }
+}
+
+void StateTracker::SetStencilTestEnable(bool enable) {
+    if (Issue(Update(graphics.stencil_test_enable, enable))) {
+        cmdbuf.setStencilTestEnableEXT(enable);
+    }
+}
+
+} // namespace Vulkan
@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <boost/container/static_vector.hpp>
+
+#include "common/types.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+/// Shadows the dynamic state and bindings recorded into the current command buffer, so that
+/// commands which would not change anything are skipped. Reset when a command buffer begins.
+class StateTracker {
+    static constexpr u32 MaxViewports = 16;
+    static constexpr u32 MaxVertexBuffers = 32;
+    static constexpr u32 MaxColorAttachments = 8;
+
+    template <typename T, u32 N>
+    using Array = boost::container::static_vector<T, N>;
+
+public:
+    struct Stats {
+        u64 issued{};  ///< Commands recorded into command buffers
+        u64 skipped{}; ///< Commands dropped as redundant
+    };
+
+    struct StencilOps {
+        vk::StencilOp fail_op;
+        vk::StencilOp pass_op;
+        vk::StencilOp depth_fail_op;
+        vk::CompareOp compare_op;
+
+        bool operator==(const StencilOps&) const noexcept = default;
+    };
+
+    /// Forgets all recorded state and starts tracking the provided command buffer.
+    void Reset(vk::CommandBuffer cmdbuf);
+
+    /// Forgets graphics state after a pipeline was bound without going through the tracker,
+    /// as binding a pipeline with static state leaves the matching dynamic state undefined.
+    void InvalidateGraphics();
+
+    void BindGraphicsPipeline(vk::Pipeline pipeline);
+    void BindComputePipeline(vk::Pipeline pipeline);
+    void BindVertexBuffers(std::span<const vk::Buffer> buffers,
+                           std::span<const vk::DeviceSize> offsets);
+    void BindVertexBuffers(std::span<const vk::Buffer> buffers,
+                           std::span<const vk::DeviceSize> offsets,
+                           std::span<const vk::DeviceSize> sizes,
+                           std::span<const vk::DeviceSize> strides);
+    void BindIndexBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::IndexType type);
+    void BindDescriptorBuffer(vk::DeviceAddress address, vk::BufferUsageFlags usage);
+
+    void SetVertexInput(std::span<const vk::VertexInputBindingDescription2EXT> bindings,
+                        std::span<const vk::VertexInputAttributeDescription2EXT> attributes);
+    void SetViewports(std::span<const vk::Viewport> viewports);
+    void SetScissors(std::span<const vk::Rect2D> scissors);
+    void SetBlendConstants(const std::array<float, 4>& constants);
+    void SetColorWriteMasks(std::span<const vk::ColorComponentFlags> masks);
+    void SetColorBlendEnables(std::span<const vk::Bool32> enables);
+    void SetColorBlendEquations(std::span<const vk::ColorBlendEquationEXT> equations);
+    void SetDepthBounds(float min, float max);
+    void SetDepthBias(float constant, float clamp, float slope);
+    void SetStencilOps(const StencilOps& front, const StencilOps& back);
+    void SetStencilReference(u32 front, u32 back);
+    void SetStencilWriteMask(u32 front, u32 back);
+    void SetStencilCompareMask(u32 front, u32 back);
+    void SetPrimitiveTopology(vk::PrimitiveTopology topology);
+    void SetPrimitiveRestartEnable(bool enable);
+    void SetCullMode(vk::CullModeFlags mode);
+    void SetFrontFace(vk::FrontFace face);
+    void SetPolygonMode(vk::PolygonMode mode);
+    void SetRasterizationSamples(vk::SampleCountFlagBits samples);
+    void SetDepthTestEnable(bool enable);
+    void SetDepthWriteEnable(bool enable);
+    void SetDepthCompareOp(vk::CompareOp op);
+    void SetDepthBoundsTestEnable(bool enable);
+    void SetDepthBiasEnable(bool enable);
+    void SetStencilTestEnable(bool enable);
+
+    [[nodiscard]] const Stats& GetStats() const noexcept {
+        return stats;
+    }
+
+private:
+    /// Stores the new value and returns true when it differs from the recorded one.
+    template <typename T>
+    static bool Update(std::optional<T>& state, const T& value) {
+        if (state && *state == value) {
+            return false;
+        }
+        state = value;
+        return true;
+    }
+
+    /// Accounts for a command that is either recorded or skipped.
+    bool Issue(bool changed) noexcept {
+        ++(changed ? stats.issued : stats.skipped);
+        return changed;
+    }
+
+    template <typename T>
+    using FacePair = std::array<T, 2>;
+
+    struct Bindings {
+        std::optional<vk::Pipeline> graphics_pipeline;
+        std::optional<vk::Pipeline> compute_pipeline;
+        std::optional<Array<vk::Buffer, MaxVertexBuffers>> vertex_buffers;
+        std::optional<Array<vk::DeviceSize, MaxVertexBuffers>> vertex_offsets;
+        std::optional<Array<vk::DeviceSize, MaxVertexBuffers>> vertex_sizes;
+        std::optional<Array<vk::DeviceSize, MaxVertexBuffers>> vertex_strides;
+        std::optional<std::tuple<vk::Buffer, vk::DeviceSize, vk::IndexType>> index_buffer;
+        std::optional<vk::DeviceAddress> descriptor_buffer;
+    };
+
+    struct GraphicsState {
+        std::optional<Array<vk::VertexInputBindingDescription2EXT, MaxVertexBuffers>>
+            vertex_bindings;
+        std::optional<Array<vk::VertexInputAttributeDescription2EXT, MaxVertexBuffers>>
+            vertex_attributes;
+        std::optional<Array<vk::Viewport, MaxViewports>> viewports;
+        std::optional<Array<vk::Rect2D, MaxViewports>> scissors;
+        std::optional<std::array<float, 4>> blend_constants;
+        std::optional<Array<vk::ColorComponentFlags, MaxColorAttachments>> color_write_masks;
+        std::optional<Array<vk::Bool32, MaxColorAttachments>> color_blend_enables;
+        std::optional<Array<vk::ColorBlendEquationEXT, MaxColorAttachments>>
+            color_blend_equations;
+        std::optional<std::array<float, 2>> depth_bounds;
+        std::optional<std::array<float, 3>> depth_bias;
+        std::optional<FacePair<StencilOps>> stencil_ops;
+        std::optional<FacePair<u32>> stencil_reference;
+        std::optional<FacePair<u32>> stencil_write_mask;
+        std::optional<FacePair<u32>> stencil_compare_mask;
+        std::optional<vk::PrimitiveTopology> primitive_topology;
+        std::optional<bool> primitive_restart_enable;
+        std::optional<vk::CullModeFlags> cull_mode;
+        std::optional<vk::FrontFace> front_face;
+        std::optional<vk::PolygonMode> polygon_mode;
+        std::optional<vk::SampleCountFlagBits> rasterization_samples;
+        std::optional<bool> depth_test_enable;
+        std::optional<bool> depth_write_enable;
+        std::optional<vk::CompareOp> depth_compare_op;
+        std::optional<bool> depth_bounds_test_enable;
+        std::optional<bool> depth_bias_enable;
+        std::optional<bool> stencil_test_enable;
+    };
+
+    vk::CommandBuffer cmdbuf;
+    Bindings bindings{};
+    GraphicsState graphics{};
+    Stats stats{};
+};
+
+} // namespace Vulkan
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <ranges>
 #include "common/assert.h"
 #include "video_core/renderer_vulkan/liverpool_to_vk.h"
@@ -183,14 +184,15 @@ Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                                        ? properties.value.sampleCounts
                                        : vk::SampleCountFlagBits::e1;
 
+    const auto extent = info.ScaledSize();
     const vk::ImageCreateInfo image_ci = {
         .flags = flags,
         .imageType = info.type,
         .format = supported_format,
         .extent{
-            .width = info.size.width,
-            .height = info.size.height,
-            .depth = info.size.depth,
+            .width = extent.width,
+            .height = extent.height,
+            .depth = extent.depth,
         },
         .mipLevels = static_cast<u32>(info.resources.levels),
         .arrayLayers = static_cast<u32>(info.resources.layers),
@@ -203,19 +205,83 @@ Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
     image.Create(image_ci);
 
     Vulkan::SetObjectName(instance->GetDevice(), (vk::Image)image, "Image {}x{}x{} {:#x}:{:#x}",
-                          info.size.width, info.size.height, info.size.depth, info.guest_address,
+                          extent.width, extent.height, extent.depth, info.guest_address,
                           info.guest_size);
 }
 
-boost::container::small_vector<vk::ImageMemoryBarrier2, 32> Image::GetBarriers(
-    vk::ImageLayout dst_layout, vk::Flags<vk::AccessFlagBits2> dst_mask,
-    vk::PipelineStageFlags2 dst_stage, std::optional<SubresourceRange> subres_range) {
+vk::PipelineStageFlags2 GetAccessStages(vk::Flags<vk::AccessFlagBits2> access,
+                                        vk::PipelineStageFlags2 shader_stages) {
+    using Access = vk::AccessFlagBits2;
+    using Stage = vk::PipelineStageFlagBits2;
+    vk::PipelineStageFlags2 stages{};
+    if (access & (Access::eTransferRead | Access::eTransferWrite)) {
+        stages |= Stage::eTransfer;
+    }
+    if (access & (Access::eColorAttachmentRead | Access::eColorAttachmentWrite)) {
+        stages |= Stage::eColorAttachmentOutput;
+    }
+    if (access & (Access::eDepthStencilAttachmentRead | Access::eDepthStencilAttachmentWrite)) {
+        stages |= Stage::eEarlyFragmentTests | Stage::eLateFragmentTests;
+    }
+    if (access & (Access::eShaderRead | Access::eShaderWrite | Access::eShaderSampledRead |
+                  Access::eShaderStorageRead | Access::eShaderStorageWrite)) {
+        stages |= shader_stages;
+    }
+    return stages ? stages : Stage::eAllCommands;
+}
+
+void ImageBarrierBatch::Add(std::span<const vk::ImageMemoryBarrier2> image_barriers) {
+    if (image_barriers.empty()) {
+        return;
+    }
+    const auto image = image_barriers.front().image;
+    if (std::ranges::any_of(barriers,
+                            [image](const auto& barrier) { return barrier.image == image; })) {
+        Flush();
+    }
+    barriers.insert(barriers.end(), image_barriers.begin(), image_barriers.end());
+}
+
+void ImageBarrierBatch::Flush() {
+    if (barriers.empty()) {
+        return;
+    }
+    scheduler.EndRendering();
+    scheduler.CommandBuffer().pipelineBarrier2(vk::DependencyInfo{
+        .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
+        .pImageMemoryBarriers = barriers.data(),
+    });
+    barriers.clear();
+}
+
+ImageBarriers Image::GetBarriers(vk::ImageLayout dst_layout,
+                                 vk::Flags<vk::AccessFlagBits2> dst_mask,
+                                 vk::PipelineStageFlags2 dst_stage,
+                                 std::optional<SubresourceRange> subres_range) {
     const bool needs_partial_transition =
         subres_range &&
         (subres_range->base != SubresourceBase{} || subres_range->extent != info.resources);
     const bool partially_transited = !subresource_states.empty();
 
-    boost::container::small_vector<vk::ImageMemoryBarrier2, 32> barriers{};
+    // Barriers are emitted on layout or access changes, and when a stage the contents were not
+    // made visible to yet accesses them. Otherwise the stage only joins the source stages of
+    // the next barrier, which have to cover every stage that used the subresource meanwhile.
+    const auto is_same_state = [&](const State& state) {
+        return state.layout == dst_layout && state.access_mask == dst_mask;
+    };
+    const auto needs_barrier = [&](const State& state) {
+        return !is_same_state(state) || (dst_stage & ~state.visible_stages);
+    };
+    const auto advance = [&](State& state) {
+        if (is_same_state(state)) {
+            state.pl_stage |= dst_stage;
+            state.visible_stages |= dst_stage;
+        } else {
+            state = {dst_stage, dst_mask, dst_layout, dst_stage};
+        }
+    };
+
+    ImageBarriers barriers{};
     if (needs_partial_transition || partially_transited) {
         if (!partially_transited) {
             subresource_states.resize(info.resources.levels * info.resources.layers);
@@ -236,45 +302,91 @@ boost::container::small_vector<vk::ImageMemoryBarrier2, 32> Image::GetBarriers(
                                            subres_range->base.layer + subres_range->extent.layers)
                 : std::views::iota(0u, info.resources.layers);
 
+        const auto has_source = [](const vk::ImageMemoryBarrier2& barrier, const State& state) {
+            return barrier.srcStageMask == state.pl_stage &&
+                   barrier.srcAccessMask == state.access_mask && barrier.oldLayout == state.layout;
+        };
+
         for (u32 mip : mips) {
+            // Adjacent layers in the same state share a barrier.
+            const size_t mip_begin = barriers.size();
             for (u32 layer : layers) {
-                // NOTE: these loops may produce a lot of small barriers.
-                // If this becomes a problem, we can optimize it by merging adjacent barriers.
                 const auto subres_idx = mip * info.resources.layers + layer;
                 ASSERT(subres_idx < subresource_states.size());
                 auto& state = subresource_states[subres_idx];
 
-                if (state.layout != dst_layout || state.access_mask != dst_mask) {
-                    barriers.emplace_back(vk::ImageMemoryBarrier2{
-                        .srcStageMask = state.pl_stage,
-                        .srcAccessMask = state.access_mask,
-                        .dstStageMask = dst_stage,
-                        .dstAccessMask = dst_mask,
-                        .oldLayout = state.layout,
-                        .newLayout = dst_layout,
-                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                        .image = image,
-                        .subresourceRange{
-                            .aspectMask = aspect_mask,
-                            .baseMipLevel = mip,
-                            .levelCount = 1,
-                            .baseArrayLayer = layer,
-                            .layerCount = 1,
-                        },
-                    });
-                    state.layout = dst_layout;
-                    state.access_mask = dst_mask;
-                    state.pl_stage = dst_stage;
+                if (!needs_barrier(state)) {
+                    advance(state);
+                    continue;
                 }
+                if (barriers.size() > mip_begin) {
+                    auto& prev = barriers.back();
+                    auto& prev_range = prev.subresourceRange;
+                    if (prev_range.baseArrayLayer + prev_range.layerCount == layer &&
+                        has_source(prev, state)) {
+                        ++prev_range.layerCount;
+                        advance(state);
+                        continue;
+                    }
+                }
+                barriers.emplace_back(vk::ImageMemoryBarrier2{
+                    .srcStageMask = state.pl_stage,
+                    .srcAccessMask = state.access_mask,
+                    .dstStageMask = dst_stage,
+                    .dstAccessMask = dst_mask,
+                    .oldLayout = state.layout,
+                    .newLayout = dst_layout,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image = image,
+                    .subresourceRange{
+                        .aspectMask = aspect_mask,
+                        .baseMipLevel = mip,
+                        .levelCount = 1,
+                        .baseArrayLayer = layer,
+                        .layerCount = 1,
+                    },
+                });
+                advance(state);
+            }
+
+            // Layer ranges repeating the ones of the previous mip extend their barriers.
+            for (size_t i = mip_begin; i < barriers.size();) {
+                const auto& barrier = barriers[i];
+                const auto& range = barrier.subresourceRange;
+                const auto prev_end = barriers.begin() + mip_begin;
+                const auto it = std::find_if(barriers.begin(), prev_end, [&](const auto& prev) {
+                    const auto& prev_range = prev.subresourceRange;
+                    return prev_range.baseMipLevel + prev_range.levelCount == mip &&
+                           prev_range.baseArrayLayer == range.baseArrayLayer &&
+                           prev_range.layerCount == range.layerCount &&
+                           prev.srcStageMask == barrier.srcStageMask &&
+                           prev.srcAccessMask == barrier.srcAccessMask &&
+                           prev.oldLayout == barrier.oldLayout;
+                });
+                if (it == prev_end) {
+                    ++i;
+                    continue;
+                }
+                ++it->subresourceRange.levelCount;
+                barriers.erase(barriers.begin() + i);
             }
         }
 
         if (!needs_partial_transition) {
+            // All subresources are in the destination state now, keep the stages of all of them.
+            State merged{{}, dst_mask, dst_layout, ~vk::PipelineStageFlags2{}};
+            for (const auto& state : subresource_states) {
+                merged.pl_stage |= state.pl_stage;
+                merged.visible_stages &= state.visible_stages;
+            }
+            last_state = merged;
             subresource_states.clear();
+            return barriers;
         }
     } else { // Full resource transition
-        if (last_state.layout == dst_layout && last_state.access_mask == dst_mask) {
+        if (!needs_barrier(last_state)) {
+            advance(last_state);
             return {};
         }
 
@@ -298,23 +410,15 @@ boost::container::small_vector<vk::ImageMemoryBarrier2, 32> Image::GetBarriers(
         });
     }
 
-    last_state.layout = dst_layout;
-    last_state.access_mask = dst_mask;
-    last_state.pl_stage = dst_stage;
-
+    advance(last_state);
     return barriers;
 }
 
 void Image::Transit(vk::ImageLayout dst_layout, vk::Flags<vk::AccessFlagBits2> dst_mask,
-                    std::optional<SubresourceRange> range, vk::CommandBuffer cmdbuf /*= {}*/) {
-    // Adjust pipieline stage
-    const vk::PipelineStageFlags2 dst_pl_stage =
-        (dst_mask == vk::AccessFlagBits2::eTransferRead ||
-         dst_mask == vk::AccessFlagBits2::eTransferWrite)
-            ? vk::PipelineStageFlagBits2::eTransfer
-            : vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader;
-
-    const auto barriers = GetBarriers(dst_layout, dst_mask, dst_pl_stage, range);
+                    std::optional<SubresourceRange> range, vk::CommandBuffer cmdbuf /*= {}*/,
+                    vk::PipelineStageFlags2 shader_stages /*= AnyShaderStage*/) {
+    const auto barriers =
+        GetBarriers(dst_layout, dst_mask, GetAccessStages(dst_mask, shader_stages), range);
     if (barriers.empty()) {
         return;
     }
@@ -330,6 +434,12 @@ void Image::Transit(vk::ImageLayout dst_layout, vk::Flags<vk::AccessFlagBits2> d
     });
 }
 
+void Image::Transit(vk::ImageLayout dst_layout, vk::Flags<vk::AccessFlagBits2> dst_mask,
+                    std::optional<SubresourceRange> range, ImageBarrierBatch& batch,
+                    vk::PipelineStageFlags2 shader_stages /*= AnyShaderStage*/) {
+    batch.Add(GetBarriers(dst_layout, dst_mask, GetAccessStages(dst_mask, shader_stages), range));
+}
+
 void Image::Upload(vk::Buffer buffer, u64 offset) {
     scheduler->EndRendering();
     Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {});
@@ -359,71 +469,126 @@ void Image::Upload(vk::Buffer buffer, u64 offset) {
             vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eTransferRead, {});
 }
 
-void Image::CopyImage(const Image& image) {
+static vk::Offset3D MipExtent(const Extent3D& size, u32 mip) {
+    return {
+        static_cast<s32>(std::max(size.width >> mip, 1u)),
+        static_cast<s32>(std::max(size.height >> mip, 1u)),
+        static_cast<s32>(std::max(size.depth >> mip, 1u)),
+    };
+}
+
+static vk::ImageBlit MakeBlit(const Image& src, u32 src_mip, const Image& dst, u32 dst_mip) {
+    return vk::ImageBlit{
+        .srcSubresource{
+            .aspectMask = src.aspect_mask,
+            .mipLevel = src_mip,
+            .baseArrayLayer = 0,
+            .layerCount = src.info.resources.layers,
+        },
+        .srcOffsets = std::array{vk::Offset3D{0, 0, 0}, MipExtent(src.info.ScaledSize(), src_mip)},
+        .dstSubresource{
+            .aspectMask = dst.aspect_mask,
+            .mipLevel = dst_mip,
+            .baseArrayLayer = 0,
+            .layerCount = dst.info.resources.layers,
+        },
+        .dstOffsets = std::array{vk::Offset3D{0, 0, 0}, MipExtent(dst.info.ScaledSize(), dst_mip)},
+    };
+}
+
+static vk::Filter BlitFilter(const Instance& instance, const Image& src) {
+    // Depth, stencil and integer formats can only be blitted with nearest filtering.
+    const bool is_filterable =
+        src.aspect_mask == vk::ImageAspectFlagBits::eColor &&
+        instance.IsFormatSupported(src.info.pixel_format,
+                                   vk::FormatFeatureFlagBits2::eSampledImageFilterLinear);
+    return is_filterable ? vk::Filter::eLinear : vk::Filter::eNearest;
+}
+
+void Image::CopyImage(const Image& image, vk::CommandBuffer cmdbuf /*= {}*/) {
+    if (!cmdbuf) {
+        scheduler->EndRendering();
+        cmdbuf = scheduler->CommandBuffer();
+    }
+    Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {}, cmdbuf);
+
+    if (info.resolution_scale != image.info.resolution_scale) {
+        // Images rendered at different resolutions need to be scaled instead of copied.
+        boost::container::small_vector<vk::ImageBlit, 14> image_blit{};
+        for (u32 m = 0; m < image.info.resources.levels; ++m) {
+            image_blit.emplace_back(MakeBlit(image, m, *this, m));
+        }
+        cmdbuf.blitImage(image.image, image.last_state.layout, this->image,
+                         this->last_state.layout, image_blit, BlitFilter(*instance, image));
+    } else {
+        const auto size = info.ScaledSize();
+        boost::container::small_vector<vk::ImageCopy, 14> image_copy{};
+        for (u32 m = 0; m < image.info.resources.levels; ++m) {
+            const auto mip_w = std::max(size.width >> m, 1u);
+            const auto mip_h = std::max(size.height >> m, 1u);
+            const auto mip_d = std::max(size.depth >> m, 1u);
+
+            image_copy.emplace_back(vk::ImageCopy{
+                .srcSubresource{
+                    .aspectMask = image.aspect_mask,
+                    .mipLevel = m,
+                    .baseArrayLayer = 0,
+                    .layerCount = image.info.resources.layers,
+                },
+                .dstSubresource{
+                    .aspectMask = image.aspect_mask,
+                    .mipLevel = m,
+                    .baseArrayLayer = 0,
+                    .layerCount = image.info.resources.layers,
+                },
+                .extent = {mip_w, mip_h, mip_d},
+            });
+        }
+        cmdbuf.copyImage(image.image, image.last_state.layout, this->image,
+                         this->last_state.layout, image_copy);
+    }
+
+    Transit(vk::ImageLayout::eGeneral,
+            vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eTransferRead, {}, cmdbuf);
+}
+
+void Image::CopyMip(const Image& image, u32 mip) {
     scheduler->EndRendering();
     Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {});
 
     auto cmdbuf = scheduler->CommandBuffer();
 
-    boost::container::small_vector<vk::ImageCopy, 14> image_copy{};
-    for (u32 m = 0; m < image.info.resources.levels; ++m) {
-        const auto mip_w = std::max(info.size.width >> m, 1u);
-        const auto mip_h = std::max(info.size.height >> m, 1u);
-        const auto mip_d = std::max(info.size.depth >> m, 1u);
+    if (info.resolution_scale != image.info.resolution_scale) {
+        const auto image_blit = MakeBlit(image, 0, *this, mip);
+        cmdbuf.blitImage(image.image, image.last_state.layout, this->image,
+                         this->last_state.layout, image_blit, BlitFilter(*instance, image));
+    } else {
+        const auto size = info.ScaledSize();
+        const auto mip_w = std::max(size.width >> mip, 1u);
+        const auto mip_h = std::max(size.height >> mip, 1u);
+        const auto mip_d = std::max(size.depth >> mip, 1u);
+
+        ASSERT(mip_w == image.info.ScaledSize().width);
+        ASSERT(mip_h == image.info.ScaledSize().height);
 
-        image_copy.emplace_back(vk::ImageCopy{
+        const vk::ImageCopy image_copy{
             .srcSubresource{
                 .aspectMask = image.aspect_mask,
-                .mipLevel = m,
+                .mipLevel = 0,
                 .baseArrayLayer = 0,
                 .layerCount = image.info.resources.layers,
             },
             .dstSubresource{
                 .aspectMask = image.aspect_mask,
-                .mipLevel = m,
+                .mipLevel = mip,
                 .baseArrayLayer = 0,
-                .layerCount = image.info.resources.layers,
+                .layerCount = info.resources.layers,
             },
             .extent = {mip_w, mip_h, mip_d},
-        });
+        };
+        cmdbuf.copyImage(image.image, image.last_state.layout, this->image,
+                         this->last_state.layout, image_copy);
     }
-    cmdbuf.copyImage(image.image, image.last_state.layout, this->image, this->last_state.layout,
-                     image_copy);
-
-    Transit(vk::ImageLayout::eGeneral,
-            vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eTransferRead, {});
-}
-
-void Image::CopyMip(const Image& image, u32 mip) {
-    scheduler->EndRendering();
-    Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {});
-
-    auto cmdbuf = scheduler->CommandBuffer();
-
-    const auto mip_w = std::max(info.size.width >> mip, 1u);
-    const auto mip_h = std::max(info.size.height >> mip, 1u);
-    const auto mip_d = std::max(info.size.depth >> mip, 1u);
-
-    ASSERT(mip_w == image.info.size.width);
-    ASSERT(mip_h == image.info.size.height);
-
-    const vk::ImageCopy image_copy{
-        .srcSubresource{
-            .aspectMask = image.aspect_mask,
-            .mipLevel = 0,
-            .baseArrayLayer = 0,
-            .layerCount = image.info.resources.layers,
-        },
-        .dstSubresource{
-            .aspectMask = image.aspect_mask,
-            .mipLevel = mip,
-            .baseArrayLayer = 0,
-            .layerCount = info.resources.layers,
-        },
-        .extent = {mip_w, mip_h, mip_d},
-    };
-    cmdbuf.copyImage(image.image, image.last_state.layout, this->image, this->last_state.layout,
-                     image_copy);
 
     Transit(vk::ImageLayout::eGeneral,
             vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eTransferRead, {});
@@ -10,6 +10,7 @@
 #include "video_core/texture_cache/image_view.h"
 
 #include <optional>
+#include <span>
 
 namespace Vulkan {
 class Instance;
@@ -67,6 +68,40 @@ private:
 
 constexpr Common::SlotId NULL_IMAGE_ID{0};
 
+using ImageBarriers = boost::container::small_vector<vk::ImageMemoryBarrier2, 32>;
+
+/// Shader stages that may access an image when the binding stage is not known.
+constexpr vk::PipelineStageFlags2 AnyShaderStage =
+    vk::PipelineStageFlagBits2::eAllGraphics | vk::PipelineStageFlagBits2::eComputeShader;
+
+/// Returns the pipeline stages performing the given accesses, with shader accesses attributed to
+/// the provided shader stages.
+vk::PipelineStageFlags2 GetAccessStages(vk::Flags<vk::AccessFlagBits2> access,
+                                        vk::PipelineStageFlags2 shader_stages = AnyShaderStage);
+
+/// Collects the barriers of several image transitions to record them as a single dependency.
+class ImageBarrierBatch {
+public:
+    explicit ImageBarrierBatch(Vulkan::Scheduler& scheduler) : scheduler{scheduler} {}
+    ~ImageBarrierBatch() {
+        Flush();
+    }
+
+    ImageBarrierBatch(const ImageBarrierBatch&) = delete;
+    ImageBarrierBatch& operator=(const ImageBarrierBatch&) = delete;
+
+    /// Adds the barriers of an image. Barriers of one dependency are not ordered between each
+    /// other, so pending barriers of the same image are recorded first.
+    void Add(std::span<const vk::ImageMemoryBarrier2> image_barriers);
+
+    /// Records the pending barriers, ending the current rendering scope if there are any.
+    void Flush();
+
+private:
+    Vulkan::Scheduler& scheduler;
+    ImageBarriers barriers;
+};
+
 struct Image {
     Image(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler, const ImageInfo& info);
     ~Image();
@@ -96,14 +131,20 @@ struct Image {
         depth_id = image_id;
     }
 
-    boost::container::small_vector<vk::ImageMemoryBarrier2, 32> GetBarriers(
-        vk::ImageLayout dst_layout, vk::Flags<vk::AccessFlagBits2> dst_mask,
-        vk::PipelineStageFlags2 dst_stage, std::optional<SubresourceRange> subres_range);
+    ImageBarriers GetBarriers(vk::ImageLayout dst_layout, vk::Flags<vk::AccessFlagBits2> dst_mask,
+                              vk::PipelineStageFlags2 dst_stage,
+                              std::optional<SubresourceRange> subres_range);
+    void Transit(vk::ImageLayout dst_layout, vk::Flags<vk::AccessFlagBits2> dst_mask,
+                 std::optional<SubresourceRange> range, vk::CommandBuffer cmdbuf = {},
+                 vk::PipelineStageFlags2 shader_stages = AnyShaderStage);
+    /// Adds the transition to a batch instead of recording it.
     void Transit(vk::ImageLayout dst_layout, vk::Flags<vk::AccessFlagBits2> dst_mask,
-                 std::optional<SubresourceRange> range, vk::CommandBuffer cmdbuf = {});
+                 std::optional<SubresourceRange> range, ImageBarrierBatch& batch,
+                 vk::PipelineStageFlags2 shader_stages = AnyShaderStage);
     void Upload(vk::Buffer buffer, u64 offset);
 
-    void CopyImage(const Image& image);
+    /// Copies the contents of another image, scaling them if the resolution scales differ.
+    void CopyImage(const Image& image, vk::CommandBuffer cmdbuf = {});
     void CopyMip(const Image& image, u32 mip);
 
     bool IsTracked() {
@@ -121,6 +162,8 @@ struct Image {
     std::vector<ImageViewInfo> image_view_infos;
     std::vector<ImageViewId> image_view_ids;
     ImageId depth_id{};
+    ImageId twin_id{};  ///< Depth or color image parked on the same guest range
+    u64 generation{0};  ///< Version of the contents, the twin with the larger one is newer
 
     // Resource state tracking
     struct {
@@ -137,6 +180,8 @@ struct Image {
         vk::Flags<vk::PipelineStageFlagBits2> pl_stage = vk::PipelineStageFlagBits2::eAllCommands;
         vk::Flags<vk::AccessFlagBits2> access_mask = vk::AccessFlagBits2::eNone;
         vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+        /// Stages the contents were made visible to by the last barrier
+        vk::Flags<vk::PipelineStageFlagBits2> visible_stages{};
     };
     State last_state{};
     std::vector<State> subresource_states{};
@@ -9,6 +9,7 @@
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/texture_cache/types.h"
 
+#include <algorithm>
 #include <boost/container/small_vector.hpp>
 
 namespace VideoCore {
@@ -54,6 +55,21 @@ struct ImageInfo {
 
     void UpdateSize();
 
+    /// Returns true when the image is rendered at a resolution other than the guest one.
+    bool IsScaled() const {
+        return resolution_scale != 1.0f;
+    }
+
+    /// Converts a guest dimension to the host dimension at the resolution scale of the image.
+    u32 Scale(u32 value) const {
+        return std::max(static_cast<u32>(value * resolution_scale + 0.5f), 1u);
+    }
+
+    /// Returns the host size of the image. Only width and height are scaled.
+    Extent3D ScaledSize() const {
+        return {Scale(size.width), Scale(size.height), size.depth};
+    }
+
     struct {
         VAddr cmask_addr;
         VAddr fmask_addr;
@@ -74,6 +90,7 @@ struct ImageInfo {
     u32 num_bits{};
     u32 num_samples = 1;
     u32 pitch = 0;
+    float resolution_scale = 1.0f;
     AmdGpu::TilingMode tiling_mode{AmdGpu::TilingMode::Display_Linear};
     struct MipInfo {
         u32 size;
@@ -1,10 +1,13 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <optional>
 #include <xxhash.h>
 
+#include "common/alignment.h"
 #include "common/assert.h"
+#include "common/config.h"
 #include "common/debug.h"
 #include "video_core/buffer_cache/buffer_cache.h"
 #include "video_core/page_manager.h"
@@ -18,11 +21,23 @@ namespace VideoCore {
 
 static constexpr u64 PageShift = 12;
 static constexpr u64 NumFramesBeforeRemoval = 32;
+static constexpr float MinResolutionScale = 0.25f;
+static constexpr float MaxResolutionScale = 4.0f;
+
+/// Only single level, single sample 2D targets are rendered at the internal resolution, as
+/// blits used to move contents between resolutions do not support anything else.
+static bool IsScalable(const ImageInfo& info) {
+    return info.type == vk::ImageType::e2D && !info.props.is_volume &&
+           info.resources.levels == 1 && info.num_samples == 1 &&
+           info.pixel_format != vk::Format::eUndefined;
+}
 
 TextureCache::TextureCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                            BufferCache& buffer_cache_, PageManager& tracker_)
     : instance{instance_}, scheduler{scheduler_}, buffer_cache{buffer_cache_}, tracker{tracker_},
-      tile_manager{instance, scheduler} {
+      tile_manager{instance, scheduler},
+      resolution_scale{
+          std::clamp(Config::getResolutionScale(), MinResolutionScale, MaxResolutionScale)} {
     ImageInfo info{};
     info.pixel_format = vk::Format::eR8G8B8A8Unorm;
     info.type = vk::ImageType::e2D;
@@ -121,61 +136,83 @@ ImageId TextureCache::ResolveDepthOverlap(const ImageInfo& requested_info, Bindi
         return {};
     }
 
-    const bool stencil_match = requested_info.HasStencil() == cache_image.info.HasStencil();
-    const bool bpp_match = requested_info.num_bits == cache_image.info.num_bits;
-
-    // If an image in the cache has less slices we need to expand it
-    bool recreate = cache_image.info.resources < requested_info.resources;
-
-    switch (binding) {
-    case BindingType::Texture:
-        // The guest requires a depth sampled texture, but cache can offer only Rxf. Need to
-        // recreate the image.
-        recreate |= requested_info.IsDepthStencil() && !cache_image.info.IsDepthStencil();
-        break;
-    case BindingType::Storage:
-        // If the guest is going to use previously created depth as storage, the image needs to be
-        // recreated. (TODO: Probably a case with linear rgba8 aliasing is legit)
-        recreate |= cache_image.info.IsDepthStencil();
-        break;
-    case BindingType::RenderTarget:
-        // Render target can have only Rxf format. If the cache contains only Dx[S8] we need to
-        // re-create the image.
-        ASSERT(!requested_info.IsDepthStencil());
-        recreate |= cache_image.info.IsDepthStencil();
-        break;
-    case BindingType::DepthTarget:
-        // The guest has requested previously allocated texture to be bound as a depth target.
-        // In this case we need to convert Rx float to a Dx[S8] as requested
-        recreate |= !cache_image.info.IsDepthStencil();
-
-        // The guest is trying to bind a depth target and cache has it. Need to be sure that aspects
-        // and bpp match
-        recreate |= cache_image.info.IsDepthStencil() && !(stencil_match && bpp_match);
-        break;
-    default:
-        break;
-    }
-
-    if (recreate) {
-        auto new_info{requested_info};
-        new_info.resources = std::max(requested_info.resources, cache_image.info.resources);
-        new_info.UpdateSize();
-        const auto new_image_id = slot_images.insert(instance, scheduler, new_info);
-        RegisterImage(new_image_id);
+    // Returns true when the cached image can not serve the request.
+    const auto needs_recreate = [&](const ImageInfo& cache_info) {
+        const bool stencil_match = requested_info.HasStencil() == cache_info.HasStencil();
+        const bool bpp_match = requested_info.num_bits == cache_info.num_bits;
+
+        // If an image in the cache has less slices we need to expand it
+        bool recreate = cache_info.resources < requested_info.resources;
+
+        switch (binding) {
+        case BindingType::Texture:
+            // The guest requires a depth sampled texture, but cache can offer only Rxf. Need to
+            // recreate the image.
+            recreate |= requested_info.IsDepthStencil() && !cache_info.IsDepthStencil();
+            break;
+        case BindingType::Storage:
+            // If the guest is going to use previously created depth as storage, the image needs
+            // to be recreated. (TODO: Probably a case with linear rgba8 aliasing is legit)
+            recreate |= cache_info.IsDepthStencil();
+            break;
+        case BindingType::RenderTarget:
+            // Render target can have only Rxf format. If the cache contains only Dx[S8] we need
+            // to re-create the image.
+            ASSERT(!requested_info.IsDepthStencil());
+            recreate |= cache_info.IsDepthStencil();
+            break;
+        case BindingType::DepthTarget:
+            // The guest has requested previously allocated texture to be bound as a depth target.
+            // In this case we need to convert Rx float to a Dx[S8] as requested
+            recreate |= !cache_info.IsDepthStencil();
+
+            // The guest is trying to bind a depth target and cache has it. Need to be sure that
+            // aspects and bpp match
+            recreate |= cache_info.IsDepthStencil() && !(stencil_match && bpp_match);
+            break;
+        default:
+            break;
+        }
+        return recreate;
+    };
+
+    if (!needs_recreate(cache_image.info)) {
+        // Will be handled by view
+        return cache_image_id;
+    }
 
-        // Inherit image usage
-        auto& new_image = GetImage(new_image_id);
-        new_image.usage = cache_image.usage;
+    // Switch to the twin on the same guest range when it can serve the request.
+    if (cache_image.twin_id) {
+        if (!needs_recreate(slot_images[cache_image.twin_id].info)) {
+            return SwapTwin(cache_image_id);
+        }
+        ReleaseTwin(cache_image_id);
+    }
 
-        // TODO: perform a depth copy here
+    auto new_info{requested_info};
+    new_info.resources = std::max(requested_info.resources, cache_image.info.resources);
+    new_info.resolution_scale = cache_image.info.resolution_scale;
+    new_info.UpdateSize();
+    const bool is_twin = new_info.IsDepthStencil() != cache_image.info.IsDepthStencil();
+    const auto new_image_id = slot_images.insert(instance, scheduler, new_info);
+
+    // Inherit image usage
+    auto& new_image = slot_images[new_image_id];
+    auto& old_image = slot_images[cache_image_id];
+    new_image.usage = old_image.usage;
 
+    if (!is_twin) {
+        // The aspect is the same, only the layout changed.
+        RegisterImage(new_image_id);
         FreeImage(cache_image_id);
         return new_image_id;
     }
 
-    // Will be handled by view
-    return cache_image_id;
+    // Keep the image around as the twin of the new one, so switching back is cheap.
+    ++stats.twins_created;
+    new_image.twin_id = cache_image_id;
+    old_image.twin_id = new_image_id;
+    return SwapTwin(cache_image_id);
 }
 
 std::tuple<ImageId, int, int> TextureCache::ResolveOverlap(const ImageInfo& image_info,
@@ -293,7 +330,45 @@ ImageId TextureCache::ExpandImage(const ImageInfo& info, ImageId image_id) {
     return new_image_id;
 }
 
+ImageId TextureCache::ScaleDown(ImageId image_id) {
+    std::scoped_lock lock{mutex};
+    auto info = slot_images[image_id].info;
+    info.resolution_scale = 1.0f;
+    const auto new_image_id = slot_images.insert(instance, scheduler, info);
+    RegisterImage(new_image_id);
+
+    auto& src_image = slot_images[image_id];
+    auto& new_image = slot_images[new_image_id];
+
+    src_image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead, {});
+    new_image.CopyImage(src_image);
+
+    // Inherit image usage, pending modifications and known contents
+    new_image.usage = src_image.usage;
+    new_image.flags &= ~ImageFlagBits::Dirty;
+    new_image.flags |= src_image.flags & (ImageFlagBits::Dirty | ImageFlagBits::GpuModified |
+                                          ImageFlagBits::MetaRegistered);
+    new_image.mip_hashes = src_image.mip_hashes;
+    new_image.hash = src_image.hash;
+    new_image.tick_accessed_last = src_image.tick_accessed_last;
+
+    if (src_image.binding.is_bound || src_image.binding.is_target) {
+        src_image.binding.needs_rebind = 1u;
+    }
+
+    // Surface metadata moves to the new image, keep it from being removed with the old one.
+    src_image.info.meta_info = {};
+    FreeImage(image_id);
+
+    TrackImage(new_image_id);
+    return new_image_id;
+}
+
 ImageId TextureCache::FindImage(BaseDesc& desc, FindFlags flags) {
+    if (desc.type == BindingType::RenderTarget || desc.type == BindingType::DepthTarget) {
+        // Newly created targets are rendered at the internal resolution.
+        desc.info.resolution_scale = IsScalable(desc.info) ? resolution_scale : 1.0f;
+    }
     const auto& info = desc.info;
 
     if (info.guest_address == 0) [[unlikely]] {
@@ -380,6 +455,11 @@ ImageId TextureCache::FindImage(BaseDesc& desc, FindFlags flags) {
 
     Image& image = slot_images[image_id];
     image.tick_accessed_last = scheduler.CurrentTick();
+    if (desc.type == BindingType::RenderTarget || desc.type == BindingType::DepthTarget ||
+        desc.type == BindingType::Storage) {
+        // The contents are about to be written, which makes them newer than those of a twin.
+        image.generation = ++content_generation;
+    }
 
     return image_id;
 }
@@ -548,6 +628,17 @@ void TextureCache::RefreshImage(Image& image, Vulkan::Scheduler* custom_schedule
     auto* sched_ptr = custom_scheduler ? custom_scheduler : &scheduler;
     sched_ptr->EndRendering();
 
+    // Guest data can not be copied to a scaled image directly. Upload it to an image at guest
+    // resolution first and scale it up from there.
+    std::optional<Image> native_image;
+    if (image.info.IsScaled()) {
+        auto native_info = image.info;
+        native_info.resolution_scale = 1.0f;
+        native_image.emplace(instance, *sched_ptr, native_info);
+        native_image->aspect_mask = image.aspect_mask;
+    }
+    auto& upload_image = native_image ? *native_image : image;
+
     const VAddr image_addr = image.info.guest_address;
     const size_t image_size = image.info.guest_size;
     const auto [vk_buffer, buf_offset] =
@@ -589,9 +680,9 @@ void TextureCache::RefreshImage(Image& image, Vulkan::Scheduler* custom_schedule
         .offset = offset,
         .size = image_size,
     };
-    const auto image_barriers =
-        image.GetBarriers(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite,
-                          vk::PipelineStageFlagBits2::eTransfer, {});
+    const auto image_barriers = upload_image.GetBarriers(vk::ImageLayout::eTransferDstOptimal,
+                                                         vk::AccessFlagBits2::eTransferWrite,
+                                                         vk::PipelineStageFlagBits2::eTransfer, {});
     cmdbuf.pipelineBarrier2(vk::DependencyInfo{
         .dependencyFlags = vk::DependencyFlagBits::eByRegion,
         .bufferMemoryBarrierCount = 1,
@@ -599,13 +690,21 @@ void TextureCache::RefreshImage(Image& image, Vulkan::Scheduler* custom_schedule
         .imageMemoryBarrierCount = static_cast<u32>(image_barriers.size()),
         .pImageMemoryBarriers = image_barriers.data(),
     });
-    cmdbuf.copyBufferToImage(buffer, image.image, vk::ImageLayout::eTransferDstOptimal, image_copy);
+    cmdbuf.copyBufferToImage(buffer, upload_image.image, vk::ImageLayout::eTransferDstOptimal,
+                             image_copy);
     cmdbuf.pipelineBarrier2(vk::DependencyInfo{
         .dependencyFlags = vk::DependencyFlagBits::eByRegion,
         .bufferMemoryBarrierCount = 1,
         .pBufferMemoryBarriers = &post_barrier,
     });
+    if (native_image) {
+        native_image->Transit(vk::ImageLayout::eTransferSrcOptimal,
+                              vk::AccessFlagBits2::eTransferRead, {}, cmdbuf);
+        image.CopyImage(*native_image, cmdbuf);
+        sched_ptr->DeferAsyncOperation([native = std::move(*native_image)] {});
+    }
     image.flags &= ~ImageFlagBits::Dirty;
+    image.generation = ++content_generation;
 }
 
 vk::Sampler TextureCache::GetSampler(const AmdGpu::Sampler& sampler) {
@@ -752,11 +851,157 @@ void TextureCache::UntrackImageTail(ImageId image_id) {
     tracker.UpdatePagesCachedCount(addr, size, -1);
 }
 
+ImageId TextureCache::SwapTwin(ImageId image_id) {
+    Image& image = slot_images[image_id];
+    const ImageId twin_id = image.twin_id;
+    Image& twin = slot_images[twin_id];
+    ++stats.twin_swaps;
+
+    // Park the image, the twin takes over its guest range.
+    if (image.binding.is_bound || image.binding.is_target) {
+        image.binding.needs_rebind = 1u;
+    }
+    UntrackImage(image_id);
+    UnregisterImage(image_id);
+    RegisterImage(twin_id);
+    TrackImage(twin_id);
+    twin.tick_accessed_last = image.tick_accessed_last;
+
+    // Pending CPU modifications carry over, the contents are reuploaded from memory anyway.
+    twin.flags |= image.flags & (ImageFlagBits::Dirty | ImageFlagBits::GpuModified);
+    if (True(image.flags & ImageFlagBits::Dirty) || image.generation <= twin.generation) {
+        return twin_id;
+    }
+    if (CopyTwin(twin, image)) {
+        ++stats.twin_copies;
+        twin.flags &= ~ImageFlagBits::Dirty;
+    } else {
+        ++stats.twin_copy_misses;
+        twin.flags |= ImageFlagBits::CpuDirty;
+    }
+    twin.generation = image.generation;
+    return twin_id;
+}
+
+bool TextureCache::CopyTwin(Image& dst_image, Image& src_image) {
+    // Depth aspects are copied through a buffer, so the texel size of both images must match.
+    const auto depth_texel_size = [](vk::Format format) -> u32 {
+        switch (format) {
+        case vk::Format::eD16Unorm:
+        case vk::Format::eD16UnormS8Uint:
+            return 2;
+        case vk::Format::eD32Sfloat:
+        case vk::Format::eD32SfloatS8Uint:
+            return 4;
+        default:
+            return 0;
+        }
+    };
+    const bool src_is_depth = src_image.info.IsDepthStencil();
+    const auto& depth_info = src_is_depth ? src_image.info : dst_image.info;
+    const auto& color_info = src_is_depth ? dst_image.info : src_image.info;
+    const u32 texel_size = depth_texel_size(depth_info.pixel_format);
+    if (texel_size == 0 || texel_size * 8 != color_info.num_bits ||
+        src_image.info.resolution_scale != dst_image.info.resolution_scale) {
+        LOG_WARNING(Render_Vulkan, "Unable to copy {} to {} at {:#x}",
+                    vk::to_string(src_image.info.pixel_format),
+                    vk::to_string(dst_image.info.pixel_format), src_image.info.guest_address);
+        return false;
+    }
+    // Float color data may hold values outside [0, 1], which D32 cannot store without
+    // VK_EXT_depth_range_unrestricted. Reupload through the detiler instead.
+    if (!src_is_depth && texel_size == 4 && !instance.IsDepthRangeUnrestrictedSupported()) {
+        return false;
+    }
+
+    const auto src_aspect =
+        src_is_depth ? vk::ImageAspectFlagBits::eDepth : vk::ImageAspectFlagBits::eColor;
+    const auto dst_aspect =
+        src_is_depth ? vk::ImageAspectFlagBits::eColor : vk::ImageAspectFlagBits::eDepth;
+    // Twins may have been created with different sizes, copy only the common area.
+    const auto src_size = src_image.info.ScaledSize();
+    const auto dst_size = dst_image.info.ScaledSize();
+    const Extent3D size{std::min(src_size.width, dst_size.width),
+                        std::min(src_size.height, dst_size.height),
+                        std::min(src_size.depth, dst_size.depth)};
+    const u32 num_levels =
+        std::min(src_image.info.resources.levels, dst_image.info.resources.levels);
+    const u32 num_layers =
+        std::min(src_image.info.resources.layers, dst_image.info.resources.layers);
+
+    boost::container::small_vector<vk::BufferImageCopy, 14> src_copy{};
+    boost::container::small_vector<vk::BufferImageCopy, 14> dst_copy{};
+    u32 buffer_size = 0;
+    for (u32 m = 0; m < num_levels; ++m) {
+        // Buffer offsets of depth copies must be a multiple of 4.
+        buffer_size = Common::AlignUp(buffer_size, 4u);
+        const u32 width = std::max(size.width >> m, 1u);
+        const u32 height = std::max(size.height >> m, 1u);
+        const u32 depth = src_image.info.props.is_volume ? std::max(size.depth >> m, 1u) : 1u;
+        const vk::BufferImageCopy copy{
+            .bufferOffset = buffer_size,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource{
+                .aspectMask = src_aspect,
+                .mipLevel = m,
+                .baseArrayLayer = 0,
+                .layerCount = num_layers,
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {width, height, depth},
+        };
+        src_copy.push_back(copy);
+        dst_copy.push_back(copy);
+        dst_copy.back().imageSubresource.aspectMask = dst_aspect;
+        buffer_size += width * height * depth * num_layers * texel_size;
+    }
+
+    scheduler.EndRendering();
+    const auto cmdbuf = scheduler.CommandBuffer();
+    const vk::Buffer buffer = tile_manager.ObtainScratchBuffer(buffer_size).first;
+
+    src_image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead, {},
+                      cmdbuf);
+    cmdbuf.copyImageToBuffer(src_image.image, src_image.last_state.layout, buffer, src_copy);
+    const vk::BufferMemoryBarrier2 barrier{
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+        .buffer = buffer,
+        .offset = 0,
+        .size = buffer_size,
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &barrier,
+    });
+    dst_image.Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {},
+                      cmdbuf);
+    cmdbuf.copyBufferToImage(buffer, dst_image.image, dst_image.last_state.layout, dst_copy);
+    return true;
+}
+
+void TextureCache::ReleaseTwin(ImageId image_id) {
+    Image& image = slot_images[image_id];
+    if (!image.twin_id) {
+        return;
+    }
+    const ImageId twin_id = std::exchange(image.twin_id, ImageId{});
+    slot_images[twin_id].twin_id = {};
+    DeleteImage(twin_id);
+}
+
 void TextureCache::DeleteImage(ImageId image_id) {
     Image& image = slot_images[image_id];
     ASSERT_MSG(!image.IsTracked(), "Image was not untracked");
     ASSERT_MSG(False(image.flags & ImageFlagBits::Registered), "Image was not unregistered");
 
+    // A parked twin lives as long as the image it is linked to.
+    ReleaseTwin(image_id);
+
     // Remove any registered meta areas.
     const auto& meta_info = image.info.meta_info;
     if (meta_info.cmask_addr) {
@@ -90,6 +90,14 @@ public:
             : BaseDesc{BindingType::VideoOut, ImageInfo{group, cpu_address}, ImageViewInfo{}} {}
     };
 
+    /// Depth/color twin counters, sample them once per frame to get per-frame rates.
+    struct Stats {
+        u64 twins_created{};    ///< Twins linked to a surface first used with the other aspect
+        u64 twin_swaps{};       ///< Switches between the depth and color twin of a surface
+        u64 twin_copies{};      ///< Switches that copied newer contents to the other twin
+        u64 twin_copy_misses{}; ///< Copies not possible on the GPU, reuploaded from memory
+    };
+
 public:
     TextureCache(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
                  BufferCache& buffer_cache, PageManager& tracker);
@@ -129,18 +137,26 @@ public:
                                                                ImageId cache_img_id,
                                                                ImageId merged_image_id);
 
-    /// Resolves depth overlap and either re-creates the image or returns existing one
+    /// Resolves depth overlap and either switches to the depth/color twin of the image or
+    /// returns existing one
     [[nodiscard]] ImageId ResolveDepthOverlap(const ImageInfo& requested_info, BindingType binding,
                                               ImageId cache_img_id);
 
     [[nodiscard]] ImageId ExpandImage(const ImageInfo& info, ImageId image_id);
 
+    /// Replaces an image rendered at the internal resolution with a copy at guest resolution.
+    [[nodiscard]] ImageId ScaleDown(ImageId image_id);
+
     /// Reuploads image contents.
     void RefreshImage(Image& image, Vulkan::Scheduler* custom_scheduler = nullptr);
 
     /// Retrieves the sampler that matches the provided S# descriptor.
     [[nodiscard]] vk::Sampler GetSampler(const AmdGpu::Sampler& sampler);
 
+    [[nodiscard]] const Stats& GetStats() const noexcept {
+        return stats;
+    }
+
     /// Retrieves the image with the specified id.
     [[nodiscard]] Image& GetImage(ImageId id) {
         return slot_images[id];
@@ -270,6 +286,15 @@ private:
     /// Removes the image and any views/surface metas that reference it.
     void DeleteImage(ImageId image_id);
 
+    /// Parks the image and registers its twin in its place, bringing the twin up to date.
+    [[nodiscard]] ImageId SwapTwin(ImageId image_id);
+
+    /// Copies the contents of a depth image to its color twin or the other way around.
+    bool CopyTwin(Image& dst_image, Image& src_image);
+
+    /// Deletes the parked twin of the image, if any.
+    void ReleaseTwin(ImageId image_id);
+
     void FreeImage(ImageId image_id) {
         UntrackImage(image_id);
         UnregisterImage(image_id);
@@ -287,6 +312,9 @@ private:
     tsl::robin_map<u64, Sampler> samplers;
     PageTable page_table;
     std::mutex mutex;
+    float resolution_scale;
+    u64 content_generation{};
+    Stats stats{};
 
     struct MetaDataInfo {
         enum class Type {
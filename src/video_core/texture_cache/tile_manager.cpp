@@ -18,12 +18,15 @@
 #include "video_core/host_shaders/detilers/micro_64bpp_comp.h"
 #include "video_core/host_shaders/detilers/micro_8bpp_comp.h"
 
+#include <bit>
 // #include <boost/container/static_vector.hpp>
 #include <magic_enum/magic_enum.hpp>
 #include <vk_mem_alloc.h>
 
 namespace VideoCore {
 
+static constexpr u64 MaxPooledScratchBytes = 256_MB;
+
 const DetilerContext* TileManager::GetDetiler(const ImageInfo& info) const {
     const auto bpp = info.num_bits * (info.props.is_block ? 16 : 1);
     switch (info.tiling_mode) {
@@ -76,13 +79,21 @@ struct DetilerParams {
 
 TileManager::TileManager(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler)
     : instance{instance}, scheduler{scheduler} {
-    static const std::array detiler_shaders{
-        HostShaders::MICRO_8BPP_COMP,          HostShaders::MICRO_16BPP_COMP,
-        HostShaders::MICRO_32BPP_COMP,         HostShaders::MICRO_64BPP_COMP,
-        HostShaders::MICRO_128BPP_COMP,        HostShaders::MACRO_8BPP_COMP,
-        HostShaders::MACRO_32BPP_COMP,         HostShaders::MACRO_64BPP_COMP,
-        HostShaders::DISPLAY_MICRO_64BPP_COMP,
+    struct DetilerShader {
+        std::string_view code;
+        std::span<const u32> spirv;
     };
+    static const std::array<DetilerShader, DetilerType::Max> detiler_shaders{{
+        {HostShaders::MICRO_8BPP_COMP, HostShaders::MICRO_8BPP_COMP_SPV},
+        {HostShaders::MICRO_16BPP_COMP, HostShaders::MICRO_16BPP_COMP_SPV},
+        {HostShaders::MICRO_32BPP_COMP, HostShaders::MICRO_32BPP_COMP_SPV},
+        {HostShaders::MICRO_64BPP_COMP, HostShaders::MICRO_64BPP_COMP_SPV},
+        {HostShaders::MICRO_128BPP_COMP, HostShaders::MICRO_128BPP_COMP_SPV},
+        {HostShaders::MACRO_8BPP_COMP, HostShaders::MACRO_8BPP_COMP_SPV},
+        {HostShaders::MACRO_32BPP_COMP, HostShaders::MACRO_32BPP_COMP_SPV},
+        {HostShaders::MACRO_64BPP_COMP, HostShaders::MACRO_64BPP_COMP_SPV},
+        {HostShaders::DISPLAY_MICRO_64BPP_COMP, HostShaders::DISPLAY_MICRO_64BPP_COMP_SPV},
+    }};
 
     boost::container::static_vector<vk::DescriptorSetLayoutBinding, 2> bindings{
         {
@@ -119,8 +130,10 @@ TileManager::TileManager(const Vulkan::Instance& instance, Vulkan::Scheduler& sc
     for (int pl_id = 0; pl_id < DetilerType::Max; ++pl_id) {
         auto& ctx = detilers[pl_id];
 
-        const auto& module = Vulkan::Compile(
-            detiler_shaders[pl_id], vk::ShaderStageFlagBits::eCompute, instance.GetDevice());
+        const auto& shader = detiler_shaders[pl_id];
+        const auto& module =
+            Vulkan::CompileHostShader(shader.code, shader.spirv,
+                                      vk::ShaderStageFlagBits::eCompute, instance.GetDevice());
 
         // Set module debug name
         auto module_name = magic_enum::enum_name(static_cast<DetilerType>(pl_id));
@@ -161,11 +174,18 @@ TileManager::TileManager(const Vulkan::Instance& instance, Vulkan::Scheduler& sc
     }
 }
 
-TileManager::~TileManager() = default;
+TileManager::~TileManager() {
+    for (auto& bucket : scratch_pool) {
+        for (const auto& pooled : bucket) {
+            FreeBuffer(pooled.buffer);
+        }
+    }
+}
 
 TileManager::ScratchBuffer TileManager::AllocBuffer(u32 size, bool is_storage /*= false*/) {
     const auto usage = vk::BufferUsageFlagBits::eStorageBuffer |
-                       (is_storage ? vk::BufferUsageFlagBits::eTransferSrc
+                       (is_storage ? vk::BufferUsageFlagBits::eTransferSrc |
+                                         vk::BufferUsageFlagBits::eTransferDst
                                    : vk::BufferUsageFlagBits::eTransferDst);
     const vk::BufferCreateInfo buffer_ci{
         .size = size,
@@ -174,7 +194,8 @@ TileManager::ScratchBuffer TileManager::AllocBuffer(u32 size, bool is_storage /*
 
     VmaAllocationCreateInfo alloc_info{
         .flags = !is_storage ? VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
-                                   VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
+                                   VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                                   VMA_ALLOCATION_CREATE_MAPPED_BIT
                              : static_cast<VmaAllocationCreateFlags>(0),
         .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
         .requiredFlags = !is_storage ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
@@ -194,6 +215,11 @@ void TileManager::Upload(ScratchBuffer buffer, const void* data, size_t size) {
     VmaAllocationInfo alloc_info{};
     vmaGetAllocationInfo(instance.GetAllocator(), buffer.second, &alloc_info);
     ASSERT(size <= alloc_info.size);
+    // Upload buffers are persistently mapped.
+    if (alloc_info.pMappedData) {
+        std::memcpy(alloc_info.pMappedData, data, size);
+        return;
+    }
     void* ptr{};
     const auto result = vmaMapMemory(instance.GetAllocator(), buffer.second, &ptr);
     ASSERT(result == VK_SUCCESS);
@@ -205,6 +231,40 @@ void TileManager::FreeBuffer(ScratchBuffer buffer) {
     vmaDestroyBuffer(instance.GetAllocator(), buffer.first, buffer.second);
 }
 
+TileManager::ScratchBuffer TileManager::ObtainScratchBuffer(u32 size) {
+    const u32 size_log2 =
+        std::max(static_cast<u32>(std::bit_width(size - 1)), MinScratchSizeLog2);
+    const u32 bucket_size = 1U << size_log2;
+    const auto alloc_dedicated = [&] {
+        ++stats.allocations;
+        const auto buffer = AllocBuffer(size, true);
+        scheduler.DeferAsyncOperation([allocator = instance.GetAllocator(), buffer] {
+            vmaDestroyBuffer(allocator, buffer.first, buffer.second);
+        });
+        return buffer;
+    };
+    if (size_log2 > MaxScratchSizeLog2) {
+        return alloc_dedicated();
+    }
+
+    auto& bucket = scratch_pool[size_log2 - MinScratchSizeLog2];
+    ScratchBuffer buffer{};
+    if (!bucket.empty() && scheduler.IsFree(bucket.front().tick)) {
+        // Buffers are returned in tick order, so the oldest one is at the front.
+        ++stats.reuses;
+        buffer = bucket.front().buffer;
+        bucket.pop_front();
+    } else if (pooled_bytes + bucket_size <= MaxPooledScratchBytes) {
+        ++stats.allocations;
+        buffer = AllocBuffer(bucket_size, true);
+        pooled_bytes += bucket_size;
+    } else {
+        return alloc_dedicated();
+    }
+    bucket.push_back({buffer, scheduler.CurrentTick()});
+    return buffer;
+}
+
 std::pair<vk::Buffer, u32> TileManager::TryDetile(vk::Buffer in_buffer, u32 in_offset,
                                                   const ImageInfo& info) {
     if (!info.props.is_tiled) {
@@ -225,11 +285,11 @@ std::pair<vk::Buffer, u32> TileManager::TryDetile(vk::Buffer in_buffer, u32 in_o
     const u32 image_size = info.guest_size;
 
     // Prepare output buffer
-    auto out_buffer = AllocBuffer(image_size, true);
-    scheduler.DeferOperation([=, this]() { FreeBuffer(out_buffer); });
+    const auto out_buffer = ObtainScratchBuffer(image_size);
 
+    // Consecutive uploads of the same type reuse the bound detiler.
     auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, *detiler->pl);
+    scheduler.GetStateTracker().BindComputePipeline(*detiler->pl);
 
     const vk::DescriptorBufferInfo input_buffer_info{
         .buffer = in_buffer,
@@ -291,6 +351,7 @@ std::pair<vk::Buffer, u32> TileManager::TryDetile(vk::Buffer in_buffer, u32 in_o
     const auto bpp = info.num_bits * (info.props.is_block ? 16u : 1u);
     const auto num_tiles = image_size / (64 * (bpp / 8));
     cmdbuf.dispatch(num_tiles, 1, 1);
+    ++stats.dispatches;
     return {out_buffer.first, 0};
 }
 
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "common/types.h"
 #include "video_core/buffer_cache/buffer.h"
 
@@ -33,9 +35,19 @@ struct DetilerContext {
 };
 
 class TileManager {
+    static constexpr u32 MinScratchSizeLog2 = 16; ///< 64KB
+    static constexpr u32 MaxScratchSizeLog2 = 26; ///< 64MB
+    static constexpr u32 NumScratchBuckets = MaxScratchSizeLog2 - MinScratchSizeLog2 + 1;
+
 public:
     using ScratchBuffer = std::pair<vk::Buffer, VmaAllocation>;
 
+    struct Stats {
+        u64 allocations{}; ///< Scratch buffers created
+        u64 reuses{};      ///< Scratch buffers recycled from the pool
+        u64 dispatches{};  ///< Detile dispatches recorded
+    };
+
     TileManager(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler);
     ~TileManager();
 
@@ -46,14 +58,30 @@ public:
     void Upload(ScratchBuffer buffer, const void* data, size_t size);
     void FreeBuffer(ScratchBuffer buffer);
 
+    /// Returns a storage buffer of at least the given size that may be used by the current
+    /// command buffer. Buffers return to their size bucket once the GPU has finished with them.
+    ScratchBuffer ObtainScratchBuffer(u32 size);
+
+    [[nodiscard]] const Stats& GetStats() const noexcept {
+        return stats;
+    }
+
 private:
     const DetilerContext* GetDetiler(const ImageInfo& info) const;
 
 private:
+    struct PooledBuffer {
+        ScratchBuffer buffer;
+        u64 tick; ///< Tick of the last command buffer using the buffer
+    };
+
     const Vulkan::Instance& instance;
     Vulkan::Scheduler& scheduler;
     vk::UniqueDescriptorSetLayout desc_layout;
     std::array<DetilerContext, DetilerType::Max> detilers;
+    std::array<std::deque<PooledBuffer>, NumScratchBuckets> scratch_pool;
+    u64 pooled_bytes{};
+    Stats stats{};
 };
 
 } // namespace VideoCore